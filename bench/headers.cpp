@@ -0,0 +1,110 @@
+/**
+ * @file headers.cpp
+ * @brief Microbenchmark of http::Headers, used by `make bench_headers`.
+ *
+ * Replays what the server does with the header fields of one keep-alive exchange: the
+ * request fields are stored as they arrive (mixed case), looked up by the parser and the
+ * handlers, then the response fields are set and appended to a reused send buffer.
+ *
+ * The same workload runs against `MapHeaders`, a copy of the previous store (a
+ * `std::map` keyed by a lowercased copy of every name), so both numbers come from one
+ * build on one machine.
+ */
+
+#include "http/Headers.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** The previous implementation, reduced to what the workload uses. */
+class MapHeaders {
+public:
+    void clear() { map_.clear(); }
+    void add(std::string const &key, std::string const &value) { map_[normalize(key)] = value; }
+    bool has(std::string const &key) const { return map_.find(normalize(key)) != map_.end(); }
+    std::string get(std::string const &key) const {
+        std::map<std::string, std::string>::const_iterator it = map_.find(normalize(key));
+        return it == map_.end() ? std::string() : it->second;
+    }
+    void appendTo(std::vector<char> &buffer) const {
+        std::ostringstream oss;
+        for (std::map<std::string, std::string>::const_iterator it = map_.begin();
+             it != map_.end(); ++it)
+            oss << it->first << ": " << it->second << "\r\n";
+        std::string lines = oss.str();
+        buffer.insert(buffer.end(), lines.begin(), lines.end());
+    }
+
+private:
+    static std::string normalize(std::string key) {
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        return key;
+    }
+    std::map<std::string, std::string> map_;
+};
+
+char const *const REQUEST[][2] = {{"Host", "localhost:8080"},
+                                  {"User-Agent", "Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101"},
+                                  {"Accept", "text/html,application/xhtml+xml,*/*;q=0.8"},
+                                  {"Accept-Language", "en-US,en;q=0.5"},
+                                  {"Accept-Encoding", "gzip, deflate, br"},
+                                  {"Connection", "keep-alive"},
+                                  {"Cookie", "session=0123456789abcdef"},
+                                  {"Upgrade-Insecure-Requests", "1"},
+                                  {"Cache-Control", "max-age=0"},
+                                  {"Content-Type", "text/plain"}};
+const size_t REQUEST_FIELDS = sizeof(REQUEST) / sizeof(REQUEST[0]);
+
+/** Runs one exchange; returns a byte count so the work cannot be optimized away. */
+template <typename Store>
+size_t exchange(Store &request, Store &response, std::vector<char> &sendBuffer) {
+    request.clear();
+    for (size_t i = 0; i < REQUEST_FIELDS; ++i)
+        request.add(REQUEST[i][0], REQUEST[i][1]);
+    size_t sum = request.get("Host").size() + request.get("Accept").size();
+    sum += request.has("Transfer-Encoding") + request.has("Content-Length");
+    sum += request.get("Connection").size() + request.get("Content-Type").size();
+
+    response.clear();
+    response.add("Content-Type", "text/html");
+    response.add("Content-Length", "1024");
+    response.add("Connection", "keep-alive");
+    response.add("Last-Modified", "Thu, 01 Jan 1970 00:00:00 GMT");
+    sendBuffer.clear();
+    response.appendTo(sendBuffer);
+    return sum + sendBuffer.size();
+}
+
+template <typename Store> double run(char const *label, size_t iterations) {
+    Store request;
+    Store response;
+    std::vector<char> sendBuffer;
+    size_t sink = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < iterations; ++i)
+        sink += exchange(request, response, sendBuffer);
+    double ns = static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1e9 / iterations;
+    std::printf("%-12s %8.1f ns/exchange  (checksum %lu)\n", label, ns,
+                static_cast<unsigned long>(sink));
+    return ns;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+    if (iterations == 0)
+        iterations = 1;
+    double before = run<MapHeaders>("std::map", iterations);
+    double after = run<http::Headers>("Headers", iterations);
+    std::printf("speedup      %8.2fx\n", before / after);
+    return 0;
+}
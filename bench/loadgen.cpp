@@ -0,0 +1,633 @@
+/**
+ * @file loadgen.cpp
+ * @brief HTTP/1.1 load generator used by `make bench`.
+ *
+ * A single-threaded epoll client that keeps a fixed number of keep-alive connections
+ * busy and records the latency of every response.
+ *
+ * - Closed loop (default): each connection sends its next request (or batch of
+ *   pipelined requests) as soon as the previous response is complete.
+ * - Open loop (`-r rate`): requests are scheduled at a fixed total rate, independent
+ *   of the server. A request that has to wait for its connection is timed from its
+ *   scheduled start, so a stalled server shows up in the tail instead of silently
+ *   slowing the client down (no coordinated omission).
+ *
+ * Responses are parsed incrementally (Content-Length, chunked, or until close) and their
+ * bodies are discarded as they arrive, so large downloads cost no memory.
+ *
+ * A human-readable summary goes to stdout; with `-o file` a JSON line is appended too.
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const size_t READ_SIZE = 64 * 1024;
+const size_t UPLOAD_CHUNK = 8192;
+
+struct Options {
+    std::string name;
+    std::string host;
+    int port;
+    std::string method;
+    std::string path;
+    std::vector<std::string> headers;
+    size_t connections;
+    double duration;
+    double rate;     //!< Requests/s over all connections, 0 for closed loop.
+    size_t pipeline; //!< Requests in flight per connection.
+    size_t bodySize; //!< Request body bytes, sent chunked with --chunked.
+    bool chunked;
+    bool uniquePath; //!< Append a per-request counter to the path (uploads).
+    double waitReady;
+    std::string output;
+
+    Options()
+        : name("bench"), host("127.0.0.1"), port(9191), method("GET"), path("/"),
+          connections(16), duration(5), rate(0), pipeline(1), bodySize(0), chunked(false),
+          uniquePath(false), waitReady(0) {}
+};
+
+uint64_t nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Incremental HTTP/1.1 response parser that only keeps what it needs (status,
+ * framing); body bytes are counted and dropped.
+ */
+class ResponseParser {
+public:
+    enum Result { NEED_MORE, COMPLETE, INVALID };
+
+    ResponseParser() { reset(); }
+
+    void reset() {
+        state_ = HEAD;
+        line_.clear();
+        status_ = 0;
+        remaining_ = 0;
+        closeAfter_ = false;
+    }
+
+    /**
+     * Consumes bytes of @p data from @p pos until one response is complete.
+     * @p pos is advanced past the consumed bytes.
+     */
+    Result feed(char const *data, size_t len, size_t &pos) {
+        while (pos < len) {
+            switch (state_) {
+            case HEAD:
+            case CHUNK_SIZE:
+            case TRAILER: {
+                void const *found = std::memchr(data + pos, '\n', len - pos);
+                char const *nl = static_cast<char const *>(found);
+                size_t end = nl ? static_cast<size_t>(nl - data) + 1 : len;
+                line_.append(data + pos, end - pos);
+                pos = end;
+                if (!nl)
+                    break;
+                Result r = onLine();
+                if (r != NEED_MORE)
+                    return r;
+                break;
+            }
+            case BODY:
+            case CHUNK_DATA: {
+                size_t take = std::min(remaining_, len - pos);
+                pos += take;
+                remaining_ -= take;
+                if (remaining_ > 0)
+                    break;
+                if (state_ == BODY)
+                    return COMPLETE;
+                state_ = CHUNK_SIZE;
+                break;
+            }
+            case UNTIL_CLOSE:
+                pos = len;
+                break;
+            }
+        }
+        return NEED_MORE;
+    }
+
+    /** @brief The connection closed: completes a response delimited by EOF. */
+    bool finishOnClose() const { return state_ == UNTIL_CLOSE; }
+
+    int status() const { return status_; }
+    bool closeAfter() const { return closeAfter_ || state_ == UNTIL_CLOSE; }
+    bool idle() const { return state_ == HEAD && line_.empty(); }
+
+private:
+    enum State { HEAD, BODY, CHUNK_SIZE, CHUNK_DATA, TRAILER, UNTIL_CLOSE };
+
+    Result onLine() {
+        std::string line = line_;
+        line_.clear();
+        if (!line.empty() && line[line.size() - 1] == '\n')
+            line.resize(line.size() - 1);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+
+        if (state_ == CHUNK_SIZE) {
+            if (line.empty()) // CRLF that ends the previous chunk
+                return NEED_MORE;
+            remaining_ = std::strtoul(line.c_str(), NULL, 16);
+            state_ = remaining_ ? CHUNK_DATA : TRAILER;
+            return NEED_MORE;
+        }
+        if (state_ == TRAILER)
+            return line.empty() ? COMPLETE : NEED_MORE;
+
+        if (status_ == 0) { // Status line
+            if (line.compare(0, 5, "HTTP/") != 0 || line.size() < 12)
+                return INVALID;
+            status_ = std::atoi(line.c_str() + 9);
+            hasLength_ = false;
+            isChunked_ = false;
+            return NEED_MORE;
+        }
+        if (!line.empty()) {
+            std::string lower(line);
+            for (size_t i = 0; i < lower.size(); ++i)
+                lower[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lower[i])));
+            if (lower.compare(0, 15, "content-length:") == 0) {
+                hasLength_ = true;
+                remaining_ = std::strtoul(lower.c_str() + 15, NULL, 10);
+            } else if (lower.compare(0, 18, "transfer-encoding:") == 0) {
+                isChunked_ = lower.find("chunked") != std::string::npos;
+            } else if (lower.compare(0, 11, "connection:") == 0) {
+                closeAfter_ = lower.find("close") != std::string::npos;
+            }
+            return NEED_MORE;
+        }
+        // End of headers
+        if (status_ == 204 || status_ == 304 || (status_ >= 100 && status_ < 200))
+            return COMPLETE;
+        if (isChunked_) {
+            state_ = CHUNK_SIZE;
+            return NEED_MORE;
+        }
+        if (hasLength_) {
+            state_ = BODY;
+            return remaining_ ? NEED_MORE : COMPLETE;
+        }
+        state_ = UNTIL_CLOSE;
+        return NEED_MORE;
+    }
+
+    State state_;
+    std::string line_;
+    int status_;
+    size_t remaining_;
+    bool hasLength_;
+    bool isChunked_;
+    bool closeAfter_;
+};
+
+struct Connection {
+    int fd;
+    bool connected;
+    std::string out;
+    size_t outSent;
+    std::deque<uint64_t> queued;   //!< Start times of requests not sent yet.
+    std::deque<uint64_t> inFlight; //!< Start times of requests awaiting a response.
+    ResponseParser parser;
+    uint64_t nextDue; //!< Open loop: scheduled start of the next request.
+
+    Connection() : fd(-1), connected(false), outSent(0), nextDue(0) {}
+};
+
+struct Stats {
+    std::vector<uint32_t> latencies; //!< Microseconds, one per completed request.
+    uint64_t errors;
+    uint64_t unexpectedStatus;
+    uint64_t bytes;
+    uint64_t reconnects;
+
+    Stats() : errors(0), unexpectedStatus(0), bytes(0), reconnects(0) {}
+};
+
+class LoadGenerator {
+public:
+    explicit LoadGenerator(Options const &opts)
+        : opts_(opts), epfd_(epoll_create1(EPOLL_CLOEXEC)), sequence_(0), running_(true) {
+        if (epfd_ < 0)
+            throw std::runtime_error(std::string("epoll_create1: ") + strerror(errno));
+        std::memset(&addr_, 0, sizeof(addr_));
+        addr_.sin_family = AF_INET;
+        addr_.sin_port = htons(static_cast<uint16_t>(opts_.port));
+        if (inet_pton(AF_INET, opts_.host.c_str(), &addr_.sin_addr) != 1)
+            throw std::runtime_error("invalid host: " + opts_.host);
+        buildBody();
+    }
+
+    ~LoadGenerator() {
+        for (size_t i = 0; i < conns_.size(); ++i) {
+            if (conns_[i].fd >= 0)
+                close(conns_[i].fd);
+        }
+        close(epfd_);
+    }
+
+    bool waitUntilReady(double seconds) const {
+        uint64_t deadline = nowUs() + static_cast<uint64_t>(seconds * 1e6);
+        do {
+            int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            bool ok = fd >= 0 && connect(fd, reinterpret_cast<sockaddr const *>(&addr_),
+                                         sizeof(addr_)) == 0;
+            if (fd >= 0)
+                close(fd);
+            if (ok)
+                return true;
+            usleep(50000);
+        } while (nowUs() < deadline);
+        return false;
+    }
+
+    void run() {
+        conns_.resize(opts_.connections);
+        start_ = nowUs();
+        end_ = start_ + static_cast<uint64_t>(opts_.duration * 1e6);
+        uint64_t interval = opts_.rate > 0
+                                ? static_cast<uint64_t>(opts_.connections * 1e6 / opts_.rate)
+                                : 0;
+        for (size_t i = 0; i < conns_.size(); ++i) {
+            conns_[i].nextDue = start_ + (interval * i) / conns_.size();
+            open(i);
+        }
+
+        std::vector<struct epoll_event> events(conns_.size() + 1);
+        while (running_) {
+            uint64_t now = nowUs();
+            if (now >= end_)
+                break;
+            if (interval)
+                schedule(now, interval);
+            int timeout = static_cast<int>((end_ - now + 999) / 1000);
+            if (interval) {
+                uint64_t due = nextDue();
+                timeout = due > now ? static_cast<int>((due - now + 999) / 1000) : 0;
+            }
+            int n = epoll_wait(epfd_, &events[0], static_cast<int>(events.size()), timeout);
+            if (n < 0 && errno != EINTR)
+                throw std::runtime_error(std::string("epoll_wait: ") + strerror(errno));
+            for (int i = 0; i < n; ++i)
+                onEvent(events[i].data.u32, events[i].events);
+        }
+        elapsed_ = (nowUs() - start_) / 1e6;
+    }
+
+    void report(std::ostream &human, std::ostream *json) {
+        std::vector<uint32_t> &lat = stats_.latencies;
+        std::sort(lat.begin(), lat.end());
+        double rps = lat.size() / elapsed_;
+        double mbps = stats_.bytes / elapsed_ / (1024 * 1024);
+
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "%-12s c=%-4lu p=%-3lu %s  req=%-8lu err=%-5lu rps=%-10.1f MB/s=%-8.1f "
+                      "p50=%.2fms p99=%.2fms p999=%.2fms max=%.2fms",
+                      opts_.name.c_str(), static_cast<unsigned long>(opts_.connections),
+                      static_cast<unsigned long>(opts_.pipeline),
+                      opts_.rate > 0 ? "open  " : "closed", static_cast<unsigned long>(lat.size()),
+                      static_cast<unsigned long>(stats_.errors + stats_.unexpectedStatus), rps,
+                      mbps,
+                      percentile(0.50) / 1000.0, percentile(0.99) / 1000.0,
+                      percentile(0.999) / 1000.0, percentile(1.0) / 1000.0);
+        human << line << std::endl;
+
+        if (!json)
+            return;
+        *json << "{\"name\":\"" << opts_.name << "\",\"method\":\"" << opts_.method
+              << "\",\"path\":\"" << opts_.path << "\",\"connections\":" << opts_.connections
+              << ",\"pipeline\":" << opts_.pipeline << ",\"rate\":" << opts_.rate
+              << ",\"duration_s\":" << elapsed_ << ",\"requests\":" << lat.size()
+              << ",\"errors\":" << stats_.errors
+              << ",\"unexpected_status\":" << stats_.unexpectedStatus
+              << ",\"reconnects\":" << stats_.reconnects << ",\"rps\":" << rps
+              << ",\"mb_per_s\":" << mbps << ",\"latency_us\":{\"p50\":" << percentile(0.50)
+              << ",\"p90\":" << percentile(0.90) << ",\"p99\":" << percentile(0.99)
+              << ",\"p999\":" << percentile(0.999) << ",\"max\":" << percentile(1.0) << "}}"
+              << std::endl;
+    }
+
+private:
+    void buildBody() {
+        if (!opts_.bodySize)
+            return;
+        std::string payload(opts_.bodySize, 'x');
+        if (!opts_.chunked) {
+            body_ = payload;
+            return;
+        }
+        for (size_t off = 0; off < payload.size(); off += UPLOAD_CHUNK) {
+            size_t len = std::min(UPLOAD_CHUNK, payload.size() - off);
+            char size[32];
+            std::snprintf(size, sizeof(size), "%lx\r\n", static_cast<unsigned long>(len));
+            body_ += size;
+            body_.append(payload, off, len);
+            body_ += "\r\n";
+        }
+        body_ += "0\r\n\r\n";
+    }
+
+    void appendRequest(Connection &c) {
+        std::ostringstream req;
+        req << opts_.method << ' ' << opts_.path;
+        if (opts_.uniquePath)
+            req << "bench-" << getpid() << '-' << sequence_++ << ".bin";
+        req << " HTTP/1.1\r\nHost: " << opts_.host << "\r\n";
+        for (size_t i = 0; i < opts_.headers.size(); ++i)
+            req << opts_.headers[i] << "\r\n";
+        if (opts_.bodySize) {
+            req << "Content-Type: application/octet-stream\r\n";
+            if (opts_.chunked)
+                req << "Transfer-Encoding: chunked\r\n";
+            else
+                req << "Content-Length: " << body_.size() << "\r\n";
+        }
+        req << "\r\n";
+        c.out += req.str();
+        c.out += body_;
+    }
+
+    void open(size_t id) {
+        Connection &c = conns_[id];
+        c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (c.fd < 0)
+            throw std::runtime_error(std::string("socket: ") + strerror(errno));
+        int one = 1;
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        c.connected = false;
+        c.out.clear();
+        c.outSent = 0;
+        c.parser.reset();
+        if (connect(c.fd, reinterpret_cast<sockaddr const *>(&addr_), sizeof(addr_)) < 0 &&
+            errno != EINPROGRESS) {
+            throw std::runtime_error(std::string("connect: ") + strerror(errno));
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u32 = static_cast<uint32_t>(id);
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    /**
+     * Replaces the connection. After a failure its unanswered requests count as errors;
+     * after an orderly close they are retried, still timed from their original start.
+     */
+    void reopen(size_t id, bool failed) {
+        Connection &c = conns_[id];
+        if (failed)
+            stats_.errors += c.inFlight.size();
+        else
+            c.queued.insert(c.queued.begin(), c.inFlight.begin(), c.inFlight.end());
+        c.inFlight.clear();
+        close(c.fd);
+        c.fd = -1;
+        stats_.reconnects++;
+        if (running_)
+            open(id);
+    }
+
+    void schedule(uint64_t now, uint64_t interval) {
+        for (size_t i = 0; i < conns_.size(); ++i) {
+            Connection &c = conns_[i];
+            bool added = false;
+            while (c.nextDue <= now) {
+                c.queued.push_back(c.nextDue);
+                c.nextDue += interval;
+                added = true;
+            }
+            if (added)
+                flush(i);
+        }
+    }
+
+    uint64_t nextDue() const {
+        uint64_t due = end_;
+        for (size_t i = 0; i < conns_.size(); ++i)
+            due = std::min(due, conns_[i].nextDue);
+        return due;
+    }
+
+    /** Sends queued requests while the pipeline has room. */
+    void flush(size_t id) {
+        Connection &c = conns_[id];
+        if (!c.connected)
+            return;
+        if (opts_.rate <= 0 && c.inFlight.empty() && c.queued.empty()) {
+            uint64_t now = nowUs();
+            for (size_t i = 0; i < opts_.pipeline; ++i)
+                c.queued.push_back(now);
+        }
+        while (!c.queued.empty() && c.inFlight.size() < opts_.pipeline) {
+            appendRequest(c);
+            c.inFlight.push_back(c.queued.front());
+            c.queued.pop_front();
+        }
+        write(id);
+    }
+
+    void write(size_t id) {
+        Connection &c = conns_[id];
+        while (c.outSent < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.outSent, c.out.size() - c.outSent,
+                             MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return;
+                return reopen(id, true);
+            }
+            c.outSent += n;
+        }
+        c.out.clear();
+        c.outSent = 0;
+    }
+
+    void onEvent(size_t id, uint32_t events) {
+        Connection &c = conns_[id];
+        if (!c.connected && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err) {
+                stats_.errors++;
+                return reopen(id, false);
+            }
+            c.connected = true;
+            flush(id);
+        }
+        if (events & EPOLLOUT)
+            write(id);
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            read(id);
+    }
+
+    void read(size_t id) {
+        char buf[READ_SIZE];
+        for (;;) {
+            Connection &c = conns_[id];
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            if (n <= 0) {
+                bool delimited = c.parser.finishOnClose() && !c.inFlight.empty();
+                if (delimited)
+                    complete(id);
+                return reopen(id, !delimited);
+            }
+            stats_.bytes += n;
+            size_t pos = 0;
+            while (pos < static_cast<size_t>(n)) {
+                ResponseParser::Result r = c.parser.feed(buf, n, pos);
+                if (r == ResponseParser::INVALID || (r == ResponseParser::COMPLETE &&
+                                                      c.inFlight.empty())) {
+                    return reopen(id, true);
+                }
+                if (r == ResponseParser::NEED_MORE)
+                    break;
+                bool closing = c.parser.closeAfter();
+                complete(id);
+                if (closing)
+                    return reopen(id, false);
+                flush(id);
+            }
+        }
+    }
+
+    void complete(size_t id) {
+        Connection &c = conns_[id];
+        uint64_t now = nowUs();
+        if (now < end_) {
+            stats_.latencies.push_back(static_cast<uint32_t>(now - c.inFlight.front()));
+            int status = c.parser.status();
+            if (status < 200 || status >= 400)
+                stats_.unexpectedStatus++;
+        }
+        c.inFlight.pop_front();
+        c.parser.reset();
+    }
+
+    uint32_t percentile(double q) const {
+        std::vector<uint32_t> const &lat = stats_.latencies;
+        if (lat.empty())
+            return 0;
+        size_t rank = static_cast<size_t>(q * lat.size() + 0.999999);
+        return lat[std::min(lat.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    Options opts_;
+    int epfd_;
+    struct sockaddr_in addr_;
+    std::vector<Connection> conns_;
+    std::string body_;
+    uint64_t sequence_;
+    uint64_t start_;
+    uint64_t end_;
+    double elapsed_;
+    bool running_;
+    Stats stats_;
+};
+
+void usage(char const *prog) {
+    std::cerr
+        << "usage: " << prog << " [options] path\n"
+        << "  -n name         label used in the report\n"
+        << "  -a host         server address (127.0.0.1)\n"
+        << "  -p port         server port (9191)\n"
+        << "  -c conns        concurrent keep-alive connections (16)\n"
+        << "  -d seconds      test duration (5)\n"
+        << "  -r rate         open loop at this many requests/s (closed loop by default)\n"
+        << "  -P depth        pipelined requests per connection (1)\n"
+        << "  -m method       request method (GET)\n"
+        << "  -b bytes        request body size\n"
+        << "  -H header       extra request header, repeatable\n"
+        << "  -o file         append the results as a JSON line\n"
+        << "  --chunked       send the body with Transfer-Encoding: chunked\n"
+        << "  --unique        append a unique file name to the path (uploads)\n"
+        << "  --wait seconds  wait for the server to accept connections first\n";
+}
+
+bool parseOptions(int argc, char **argv, Options &opts) {
+    static struct option longOpts[] = {{"chunked", no_argument, NULL, 'C'},
+                                       {"unique", no_argument, NULL, 'U'},
+                                       {"wait", required_argument, NULL, 'W'},
+                                       {NULL, 0, NULL, 0}};
+    int ch;
+    while ((ch = getopt_long(argc, argv, "n:a:p:c:d:r:P:m:b:H:o:", longOpts, NULL)) != -1) {
+        switch (ch) {
+        case 'n': opts.name = optarg; break;
+        case 'a': opts.host = optarg; break;
+        case 'p': opts.port = std::atoi(optarg); break;
+        case 'c': opts.connections = std::strtoul(optarg, NULL, 10); break;
+        case 'd': opts.duration = std::atof(optarg); break;
+        case 'r': opts.rate = std::atof(optarg); break;
+        case 'P': opts.pipeline = std::strtoul(optarg, NULL, 10); break;
+        case 'm': opts.method = optarg; break;
+        case 'b': opts.bodySize = std::strtoul(optarg, NULL, 10); break;
+        case 'H': opts.headers.push_back(optarg); break;
+        case 'o': opts.output = optarg; break;
+        case 'C': opts.chunked = true; break;
+        case 'U': opts.uniquePath = true; break;
+        case 'W': opts.waitReady = std::atof(optarg); break;
+        default: return false;
+        }
+    }
+    if (optind != argc - 1 || !opts.connections || !opts.pipeline || opts.duration <= 0)
+        return false;
+    opts.path = argv[optind];
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+    try {
+        LoadGenerator gen(opts);
+        if (opts.waitReady > 0 && !gen.waitUntilReady(opts.waitReady)) {
+            std::cerr << opts.name << ": server not reachable on " << opts.host << ':'
+                      << opts.port << std::endl;
+            return 1;
+        }
+        gen.run();
+        if (opts.output.empty()) {
+            gen.report(std::cout, NULL);
+        } else {
+            std::ofstream json(opts.output.c_str(), std::ios::app);
+            gen.report(std::cout, &json);
+        }
+    } catch (std::exception const &e) {
+        std::cerr << opts.name << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file locations.cpp
+ * @brief Microbenchmark of location matching, used by `make bench_locations`.
+ *
+ * Builds servers with a growing number of prefix and extension locations and times the
+ * lookup of a fixed set of request paths with LocationIndex, and with a copy of the
+ * previous algorithm: a `std::map::find` per truncated copy of the path, then a scan of
+ * every extension location.
+ */
+
+#include "config/LocationBlock.hpp"
+#include "config/LocationIndex.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using config::LocationBlock;
+
+namespace {
+
+typedef std::map<std::string, LocationBlock> LocationMap;
+
+/** The previous prefix match. */
+LocationBlock const *mapPrefix(LocationMap const &ls, std::string const &path) {
+    LocationMap::const_iterator it = ls.find(path);
+    if (it != ls.end())
+        return &it->second;
+    if (!path.empty() && path[path.size() - 1] != '/') {
+        it = ls.find(path + "/");
+        if (it != ls.end())
+            return &it->second;
+    }
+    std::string current = path;
+    while (!current.empty()) {
+        it = ls.find(current);
+        if (it != ls.end())
+            return &it->second;
+        if (current == "/")
+            break;
+        size_t pos = current.rfind('/', current.size() - 2);
+        if (pos == std::string::npos)
+            break;
+        current.resize(pos + 1);
+    }
+    it = ls.find("/");
+    return it != ls.end() ? &it->second : NULL;
+}
+
+/** The previous extension match. */
+LocationBlock const *mapExtension(LocationMap const &ls, std::vector<std::string> const &paths,
+                                  std::string const &uri) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+        LocationMap::const_iterator it = ls.find(paths[i]);
+        std::string const &ext = it->second.extension();
+        if (uri.size() >= ext.size() && uri.compare(uri.size() - ext.size(), ext.size(), ext) == 0)
+            return &it->second;
+    }
+    return NULL;
+}
+
+std::string number(size_t n) {
+    std::ostringstream oss;
+    oss << n;
+    return oss.str();
+}
+
+struct Server {
+    LocationMap locations;
+    std::vector<std::string> extensionPaths;
+    config::LocationIndex index;
+
+    /** @p count locations: 90% prefixes two levels deep, 10% extensions. */
+    explicit Server(size_t count) {
+        locations["/"].path("/");
+        for (size_t i = 0; i < count; ++i) {
+            if (i % 10 == 9) {
+                std::string ext = ".x" + number(i);
+                std::string path = "\\" + ext + "$";
+                locations[path].path(path).matchType(LocationBlock::EXTENSION).extension(ext);
+                extensionPaths.push_back(path);
+            } else {
+                std::string path = "/app" + number(i % 97) + "/section" + number(i) + "/";
+                locations[path].path(path);
+            }
+        }
+        for (LocationMap::const_iterator it = locations.begin(); it != locations.end(); ++it) {
+            if (it->second.matchType() != LocationBlock::EXTENSION)
+                index.add(it->second);
+        }
+        for (size_t i = 0; i < extensionPaths.size(); ++i)
+            index.add(locations[extensionPaths[i]]);
+    }
+};
+
+std::vector<std::string> requestPaths(size_t count) {
+    std::vector<std::string> paths;
+    paths.push_back("/");
+    paths.push_back("/index.html");
+    paths.push_back("/static/css/site.css");
+    paths.push_back("/app1/section1/page.html");
+    paths.push_back("/app" + number((count / 2) % 97) + "/section" + number(count / 2) +
+                    "/a/b/c/d.html");
+    paths.push_back("/app3/unknown/deep/path/to/file.txt");
+    paths.push_back("/cgi-bin/script.x9");
+    return paths;
+}
+
+double timeLookups(Server const &server, std::vector<std::string> const &paths,
+                   size_t iterations, bool indexed, size_t &sink) {
+    clock_t start = clock();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t p = 0; p < paths.size(); ++p) {
+            LocationBlock const *found;
+            if (indexed) {
+                found = server.index.matchExtension(paths[p]);
+                if (!found)
+                    found = server.index.matchPrefix(paths[p]);
+            } else {
+                found = mapExtension(server.locations, server.extensionPaths, paths[p]);
+                if (!found)
+                    found = mapPrefix(server.locations, paths[p]);
+            }
+            sink += found ? found->path().size() : 0;
+        }
+    }
+    return static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1e9 /
+           (static_cast<double>(iterations) * paths.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 200000;
+    if (iterations == 0)
+        iterations = 1;
+    size_t const counts[] = {10, 100, 1000, 10000};
+    size_t sink = 0;
+    std::printf("%10s %14s %14s\n", "locations", "map ns/lookup", "index ns/lookup");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        Server server(counts[c]);
+        std::vector<std::string> paths = requestPaths(counts[c]);
+        size_t rounds = std::max<size_t>(1, iterations * 10 / (counts[c] / 10 + 10));
+        double before = timeLookups(server, paths, rounds, false, sink);
+        double after = timeLookups(server, paths, iterations, true, sink);
+        std::printf("%10lu %14.1f %14.1f\n", static_cast<unsigned long>(counts[c]), before,
+                    after);
+    }
+    std::printf("(checksum %lu)\n", static_cast<unsigned long>(sink));
+    return 0;
+}
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Runs the benchmark scenarios against a freshly started webserv.
+#
+# usage: bench/run.sh <webserv> <loadgen> <config> <output>
+#
+# Every scenario prints a summary line and appends one JSON object to <output>.
+# Tunables (environment): BENCH_PORT (9191), BENCH_DURATION seconds (5),
+# BENCH_CONNECTIONS (64), BENCH_RATE open-loop requests/s (2000).
+#
+# The client and the server share the machine: on few cores the latency tail mostly
+# reflects scheduling between the two, so compare runs taken on the same host.
+
+set -e
+
+SERVER=$1
+LOADGEN=$2
+CONF=$3
+OUT=$4
+
+PORT=${BENCH_PORT:-9191}
+DURATION=${BENCH_DURATION:-5}
+CONNS=${BENCH_CONNECTIONS:-64}
+RATE=${BENCH_RATE:-2000}
+FIXTURES=www/bench
+SERVER_LOG=logs/bench-server.log
+
+if [ $# -ne 4 ]; then
+    echo "usage: $0 <webserv> <loadgen> <config> <output>" >&2
+    exit 2
+fi
+
+cleanup() {
+    [ -n "$PID" ] && kill "$PID" 2>/dev/null && wait "$PID" 2>/dev/null
+    rm -rf "$FIXTURES"
+}
+trap cleanup EXIT INT TERM
+
+# Fixtures served from the /bench/ location of config/test.conf
+mkdir -p "$FIXTURES/uploads"
+head -c 10485760 /dev/urandom > "$FIXTURES/large.bin"
+
+"$SERVER" "$CONF" > "$SERVER_LOG" 2>&1 &
+PID=$!
+
+: > "$OUT"
+run() {
+    "$LOADGEN" -p "$PORT" -d "$DURATION" -o "$OUT" "$@"
+}
+
+run --wait 5 -n small -c "$CONNS" /index.html
+run -n small-open -c "$CONNS" -r "$RATE" /index.html
+run -n large -c 8 /bench/large.bin
+run -n pipelined -c 16 -P 16 /index.html
+run -n upload -c 16 -m POST -b 16384 --chunked --unique /bench/uploads/
+run -n cgi -c 4 -H "Cookie: sessionID=bench" /cgi-bin/session.py
+
+echo "Results written to $OUT"
@@ -0,0 +1,103 @@
+/**
+ * @file spawn.cpp
+ * @brief Microbenchmark of CGI process launch, used by `make bench_spawn`.
+ *
+ * Starts /bin/true (or argv[2]) and waits for it, with the launch the CGI handler used
+ * before (fork(), dup2() and execve() in the child) and with the current one
+ * (posix_spawn()), while the process holds a growing amount of touched heap, the way a
+ * long-running server does. fork() copies the page tables of that heap for every
+ * child; posix_spawn() shares the address space until the exec.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace {
+
+double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/** The previous launch: the child redirects its stdout and execs. */
+pid_t forkExec(char *const *argv, int outFd) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(outFd, STDOUT_FILENO);
+        execve(argv[0], argv, environ);
+        _exit(127);
+    }
+    return pid;
+}
+
+pid_t spawn(char *const *argv, int outFd) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, outFd, STDOUT_FILENO);
+    pid_t pid = -1;
+    int error = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return pid;
+}
+
+/** @return Launches per second, or -1 if a launch failed. */
+double rate(pid_t (*launch)(char *const *, int), char *const *argv, int outFd, size_t count) {
+    double start = now();
+    for (size_t i = 0; i < count; ++i) {
+        pid_t pid = launch(argv, outFd);
+        int status;
+        if (pid == -1 || waitpid(pid, &status, 0) != pid || status != 0)
+            return -1;
+    }
+    return count / (now() - start);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 500;
+    if (count == 0)
+        count = 1;
+    char *child[] = {const_cast<char *>(argc > 2 ? argv[2] : "/bin/true"), NULL};
+    int outFd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    size_t const heapMb[] = {0, 64, 256, 1024};
+    std::vector<char *> heap;
+    size_t allocated = 0;
+    std::printf("%8s %16s %18s\n", "heap MB", "fork+exec /s", "posix_spawn /s");
+    for (size_t h = 0; h < sizeof(heapMb) / sizeof(heapMb[0]); ++h) {
+        for (; allocated < heapMb[h]; ++allocated) {
+            char *block = static_cast<char *>(std::malloc(1024 * 1024));
+            if (!block)
+                break;
+            std::memset(block, 1, 1024 * 1024); // Touched: mapped pages the fork must copy
+            heap.push_back(block);
+        }
+        double before = rate(forkExec, child, outFd, count);
+        double after = rate(spawn, child, outFd, count);
+        if (before < 0 || after < 0) {
+            std::perror(child[0]);
+            return 1;
+        }
+        std::printf("%8lu %16.0f %18.0f\n", static_cast<unsigned long>(allocated), before, after);
+    }
+    for (size_t i = 0; i < heap.size(); ++i)
+        std::free(heap[i]);
+    close(outFd);
+    return 0;
+}
@@ -1,3 +0,0 @@
-#pragma once
-
-void print_errno_to_fd(int fd, int err_num);
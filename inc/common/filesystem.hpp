@@ -10,6 +10,9 @@ namespace utils {
 
 bool writeFile(const std::string &content, const char *path);
 
+/** @brief write() until all of @p data is out, retrying on EINTR. */
+bool writeAll(int fd, char const *data, size_t size);
+
 bool isDir(const std::string &p);
 
 const char *validateDirectoryPath(const char *path);
@@ -26,7 +29,8 @@ public:
     TempFile();
     ~TempFile();
 
-    bool open();
+    /** @brief Creates an empty file with a unique name in @p directory. */
+    bool open(std::string const &directory = "/tmp");
     void close();
     operator int() const;
     int fd() const;
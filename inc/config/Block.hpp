@@ -92,7 +92,14 @@ public:
     size_t maxBodySize() const;
     Block &maxBodySize(size_t);
 
+    /** @brief `client_body_buffer_size`, or 0 if unset. */
+    size_t bodyBufferSize() const;
+    Block &bodyBufferSize(size_t);
+
 protected:
+    /** @brief Value of a size directive (stored as an Integer), or 0 if unset. */
+    size_t getSize(std::string const &key) const;
+
     std::string name_;        //!< The name of the block (e.g., "server", "location").
     DirectiveMap directives_; //!< Map storing directive names and their values.
     friend class DirectiveHandler;
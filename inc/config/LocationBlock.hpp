@@ -35,6 +35,26 @@ public:
      */
     bool hasCgiPass() const;
 
+    /**
+     * @brief Checks if a 'fastcgi_pass' directive is configured for this location.
+     * @return True if requests go to a FastCGI backend, false otherwise.
+     */
+    bool hasFastCgiPass() const;
+
+    /**
+     * @brief The 'cgi_request_buffering' setting, on unless the directive turns it off.
+     * @return False if CGI scripts get their request body while it is being received.
+     */
+    bool cgiRequestBuffering() const;
+
+    /**
+     * @brief The 'cgi_limits' of the location's CGI scripts, 0 for a limit that is not set.
+     * @param[out] cpu CPU time, in seconds.
+     * @param[out] addressSpace Virtual memory, in bytes.
+     * @param[out] openFiles Number of open file descriptors.
+     */
+    void cgiLimits(size_t &cpu, size_t &addressSpace, size_t &openFiles) const;
+
     // ============================== Getters & Setters =============================
 
     /**
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace config {
+
+class LocationBlock;
+
+/**
+ * @class LocationIndex
+ * @brief The locations of a server block, compiled for request routing.
+ *
+ * Prefix locations go into a radix trie walked once along the request path; extension
+ * locations into a hash table probed with the path's suffixes, hashed while scanning
+ * backwards. Either lookup is O(path length), whatever the number of locations, and
+ * allocates nothing.
+ *
+ * The index stores pointers to the LocationBlocks it was given: it must be rebuilt when
+ * they move (see ServerBlock's copy constructor).
+ */
+class LocationIndex {
+public:
+    LocationIndex();
+
+    /** @brief Forgets every location. */
+    void clear();
+
+    /**
+     * @brief Indexes a location under its path, or its extension for EXTENSION ones.
+     * Extension locations must be added in declaration order: the first one added wins
+     * when several match.
+     */
+    void add(LocationBlock const &location);
+
+    /**
+     * @brief Finds the prefix location for @p path, in this order:
+     * 1. a location for exactly @p path, or @p path followed by '/';
+     * 2. the longest location ending in '/' that @p path starts with;
+     * 3. location "/".
+     * @return NULL if none applies.
+     */
+    LocationBlock const *matchPrefix(std::string const &path) const;
+
+    /** @brief First declared extension location that @p uri ends with, or NULL. */
+    LocationBlock const *matchExtension(std::string const &uri) const;
+
+private:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    /** A trie node: the path up to the node is the concatenation of the labels above. */
+    struct Node {
+        std::string label;             //!< Bytes on the edge from the parent.
+        LocationBlock const *location; //!< The location ending here, if any.
+        std::string keys;              //!< First byte of each child's label, sorted.
+        std::vector<size_t> children;  //!< Indexes into nodes_, in the order of keys.
+        Node();
+    };
+
+    struct Extension {
+        size_t hash;
+        std::string suffix;
+        LocationBlock const *location;
+        size_t order; //!< Declaration order, lower wins.
+        Extension();
+    };
+
+    size_t childOf(size_t node, char c) const;
+    void link(size_t parent, size_t child);
+    void addPrefix(std::string const &path, LocationBlock const *location);
+    void addExtension(std::string const &suffix, LocationBlock const *location);
+    void growExtensions();
+    LocationBlock const *findExtension(size_t hash, char const *suffix, size_t length,
+                                       size_t &order) const;
+
+    std::vector<Node> nodes_;           //!< nodes_[0] is the root, with an empty label.
+    LocationBlock const *root_;         //!< Location "/".
+    std::vector<Extension> extensions_; //!< Open addressing, power of two sized.
+    size_t extensionCount_;
+    std::vector<bool> suffixLengths_; //!< suffixLengths_[n]: an extension has n bytes.
+};
+
+} // namespace config
@@ -2,6 +2,7 @@
 
 #include "config/Block.hpp"
 #include "config/LocationBlock.hpp"
+#include "config/LocationIndex.hpp"
 
 namespace http {
 class Request;
@@ -11,6 +12,24 @@ namespace config {
 
 typedef std::map<std::string, LocationBlock> LocationBlockMap;
 
+/**
+ * @struct ListenOptions
+ * @brief Socket parameters given after the address of a `listen` directive.
+ */
+struct ListenOptions {
+    int backlog;   //!< `backlog=N`: accept queue length passed to listen(), default 511.
+    bool deferred; //!< `deferred`: TCP_DEFER_ACCEPT, wake up only once data has arrived.
+    int fastOpen;  //!< `fastopen=N`: TCP_FASTOPEN queue length, 0 (off) by default.
+
+    ListenOptions();
+
+    /**
+     * @brief Combines the options of another server block listening on the same port.
+     * The larger queue lengths win, `deferred` is kept if either side sets it.
+     */
+    void merge(ListenOptions const &other);
+};
+
 /**
  * @class ServerBlock
  * @brief Represents a single 'server' block from the configuration file.
@@ -23,6 +42,10 @@ class ServerBlock : public Block {
 public:
     ServerBlock();
 
+    /** @brief Copies rebuild the location index over their own locations. */
+    ServerBlock(ServerBlock const &other);
+    ServerBlock &operator=(ServerBlock const &other);
+
     // ============================== Public Interface ==============================
 
     /**
@@ -40,6 +63,10 @@ public:
 
     /**
      * @brief Finds the best-matching location block for a given request URI.
+     *
+     * The first declared extension location the URI ends with wins, then the prefix
+     * location (see LocationIndex::matchPrefix()). Both come from an index compiled as
+     * the locations are added.
      * @param request The request.
      * @return A const pointer to the matched LocationBlock, or NULL if no match is found.
      */
@@ -60,6 +87,12 @@ public:
      */
     std::string const &address() const;
 
+    /**
+     * @brief Gets the socket parameters of the `listen` directive.
+     * @return A constant reference to the options, defaults if none were given.
+     */
+    ListenOptions const &listenOptions() const;
+
     // ================================= Fluent API =================================
 
     /**
@@ -76,12 +109,24 @@ public:
      */
     ServerBlock &address(std::string const &address);
 
+    /**
+     * @brief Sets the socket parameters using a fluent interface.
+     * @param options The parsed `listen` options.
+     * @return A reference to the ServerBlock object for chaining.
+     */
+    ServerBlock &listenOptions(ListenOptions const &options);
+
 private:
-    int port_;                   //!< The listening port.
-    std::string address_;        //!< The binding IP address.
-    LocationBlockMap locations_; //!< Map of configured location blocks, keyed by path.
+    int port_;                    //!< The listening port.
+    std::string address_;         //!< The binding IP address.
+    ListenOptions listenOptions_; //!< Socket parameters of the listening socket.
+    LocationBlockMap locations_;  //!< Map of configured location blocks, keyed by path.
     std::vector<std::string>
         extensionPaths_; //!< List of extension location paths in declaration order.
+    LocationIndex locationIndex_; //!< locations_, compiled for matchLocation().
+
+    /** @brief Rebuilds locationIndex_ and the parent links after a copy. */
+    void indexLocations();
 
     friend std::ostream &operator<<(std::ostream &o, ServerBlock const &t);
     friend class Validator;
@@ -89,14 +134,4 @@ private:
 
 typedef std::vector<ServerBlock> ServerBlockVec;
 
-namespace details {
-
-bool matchServerName(std::vector<std::string> const &, std::string const &);
-LocationBlock const *bestMatchLocation(LocationBlockMap const &ls, std::string const &path);
-LocationBlock const *matchExtensionLocation(LocationBlockMap const &ls,
-                                            std::vector<std::string> const &paths,
-                                            std::string const &uri);
-
-} // namespace details
-
 } // namespace config
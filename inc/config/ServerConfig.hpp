@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ServerBlock.hpp"
+#include "VirtualHosts.hpp"
 #include <ostream>
 
 namespace http {
@@ -11,6 +12,21 @@ namespace config {
 
 typedef std::map<int, ServerBlockVec> ServerBlockMap;
 
+/**
+ * @struct Timeouts
+ * @brief Connection and CGI timeouts in seconds, resolved once from the main context.
+ */
+struct Timeouts {
+    size_t clientHeader; //!< `client_header_timeout`, default 60.
+    size_t clientBody;   //!< `client_body_timeout`, default 60.
+    size_t keepalive;    //!< `keepalive_timeout`, default 75. 0 disables keep-alive.
+    size_t send;         //!< `send_timeout`, default 60.
+    size_t cgi;          //!< `cgi_timeout`, default 0 (none).
+    size_t cgiRead;      //!< `cgi_read_timeout`, default 60.
+
+    Timeouts();
+};
+
 /**
  * @class ServerConfig
  * @brief A strongly-typed data container for a server block's configuration.
@@ -43,6 +59,9 @@ public:
 
     /**
      * @brief Retrieves the server configuration that best matches a port and server name.
+     *
+     * The Host header is looked up in the port's VirtualHosts; without a match, the
+     * first server declared on the port is used.
      * @param port The port number of the incoming connection.
      * @param request The request
      * @return A const pointer to the matched ServerBlock, or NULL if no match is found.
@@ -63,6 +82,37 @@ public:
      */
     ServerBlockMap const &getServersMap() const;
 
+    /**
+     * @brief Gets the directives declared outside of any server block.
+     * @return A constant reference to the "main" context block.
+     */
+    Block const &mainBlock() const;
+
+    /**
+     * @brief Gets the number of worker processes the server should run.
+     * @return The `worker_processes` value, or 1 if the directive is not set.
+     */
+    size_t workerProcesses() const;
+
+    /**
+     * @brief Gets the `open_file_cache` settings.
+     * @param[out] maxEntries Cache capacity, 0 if the cache is off (the default).
+     * @param[out] validity Seconds after which a cached entry is revalidated.
+     */
+    void openFileCache(size_t &maxEntries, size_t &validity) const;
+
+    /**
+     * @brief Whether client connections and CGI pipes use edge-triggered epoll.
+     * @return The `edge_triggered` value, false if the directive is not set.
+     */
+    bool edgeTriggered() const;
+
+    /**
+     * @brief Gets the client connection timeouts.
+     * @return The configured values, with defaults for the directives that are not set.
+     */
+    Timeouts const &timeouts() const;
+
 private:
     /**
      * @internal
@@ -73,6 +123,9 @@ private:
     void build(std::string const &content, bool perform_fs_checks);
 
     ServerBlockMap servers_; //!< Map of server blocks, keyed by port number.
+    std::map<int, VirtualHosts> virtualHosts_; //!< Names of servers_, by port and index.
+    Block main_;                               //!< Top-level ("main" context) directives.
+    Timeouts timeouts_;                        //!< Resolved from main_ by build().
 };
 
 std::ostream &operator<<(std::ostream &o, ServerConfig const &t);
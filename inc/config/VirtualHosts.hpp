@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace config {
+
+/**
+ * @class VirtualHosts
+ * @brief The `server_name`s of the server blocks sharing a port, hashed for lookup.
+ *
+ * Names are matched case-insensitively, in nginx's order of precedence:
+ * 1. exact names (`example.com`);
+ * 2. the longest leading wildcard (`*.example.com`, matching subdomains only);
+ * 3. the longest trailing wildcard (`www.example.*`).
+ *
+ * `.example.com` stands for both `example.com` and `*.example.com`. Each form is one
+ * hash table: an exact name costs a single probe, a wildcard one probe per dot of the
+ * host. When a name is given by several servers, the first one declared keeps it.
+ */
+class VirtualHosts {
+public:
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    VirtualHosts();
+
+    /**
+     * @brief Registers a `server_name` value.
+     * @param name The name as written in the configuration.
+     * @param server What find() returns for it (the server's index on its port).
+     */
+    void add(std::string const &name, size_t server);
+
+    /**
+     * @brief Finds the server for a Host header value.
+     * @param host The value as received: any case, with an optional port and trailing dot.
+     * @return The server given to add(), or NONE if no name matches.
+     */
+    size_t find(std::string const &host) const;
+
+private:
+    /** Open addressing table of lowercase names. */
+    class NameTable {
+    public:
+        NameTable();
+        void add(std::string const &name, size_t server);
+        size_t find(char const *name, size_t length) const;
+
+    private:
+        struct Entry {
+            size_t hash;
+            std::string name;
+            size_t server; //!< NONE for an empty slot.
+            Entry();
+        };
+        std::vector<Entry> slots_; //!< Power of two sized, at most half full.
+        size_t count_;
+    };
+
+    NameTable exact_;
+    NameTable leading_;  //!< `*.example.com`, stored as ".example.com".
+    NameTable trailing_; //!< `www.example.*`, stored as "www.example.".
+};
+
+} // namespace config
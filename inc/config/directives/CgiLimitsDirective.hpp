@@ -0,0 +1,23 @@
+#pragma once
+
+#include "IDirective.hpp"
+
+namespace config {
+
+/**
+ * @class CgiLimitsDirective
+ * @brief Handles `cgi_limits [cpu=<time>] [as=<size>] [nofile=<count>];` in a location.
+ *
+ * Stores three Integers, in this order: the CPU time in seconds, the address space in
+ * bytes and the number of open files, 0 for a limit that is not given.
+ */
+class CgiLimitsDirective : public IDirective {
+public:
+    void process(Block &b, ParsedDirectiveArgs const &args) const;
+    std::string const &getName() const { return name_; }
+
+private:
+    static const std::string name_;
+};
+
+} // namespace config
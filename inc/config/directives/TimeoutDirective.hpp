@@ -0,0 +1,25 @@
+#pragma once
+
+#include "IDirective.hpp"
+
+namespace config {
+
+/**
+ * @class TimeoutDirective
+ * @brief Handles the timeout directives (`client_header_timeout`, `client_body_timeout`,
+ * `keepalive_timeout`, `send_timeout`, `cgi_timeout`, `cgi_read_timeout`).
+ *
+ * They share one syntax, `<name> <duration>;` in the main context, so one class is
+ * registered once per name. The value is stored in seconds.
+ */
+class TimeoutDirective : public IDirective {
+public:
+    explicit TimeoutDirective(std::string const &name);
+    void process(Block &b, ParsedDirectiveArgs const &args) const;
+    std::string const &getName() const { return name_; }
+
+private:
+    std::string const name_;
+};
+
+} // namespace config
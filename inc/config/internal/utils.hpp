@@ -16,4 +16,16 @@ struct IpInfo {
 
 bool extractIpInfo(std::string const &, IpInfo &);
 
+/**
+ * @brief Parses a time value such as `30`, `30s`, `5m`, `2h` or `1d` into seconds.
+ * @return false if the value is malformed or overflows.
+ */
+bool parseDuration(std::string const &, size_t &seconds);
+
+/**
+ * @brief Parses a size such as `512`, `16k`, `8M` or `1g` into bytes.
+ * @return false if the value is malformed or overflows.
+ */
+bool parseSize(std::string const &, size_t &bytes);
+
 } // namespace utils
@@ -19,6 +19,13 @@ class Mapper {
 public:
     static ServerBlockVec map(ConfigNodeVec const &nodes);
 
+    /**
+     * @brief Applies the top-level ("main" context) directives to the given block.
+     * @param main The block receiving process-wide settings (e.g., worker_processes).
+     * @param nodes The parser output; only nodes named "main" are considered.
+     */
+    static void mapMainBlock(Block &main, ConfigNodeVec const &nodes);
+
 private:
     static void mapServerBlock(ServerBlock &, ConfigNode const &);
     static void mapLocationBlock(LocationBlock &, ConfigNode const &);
@@ -4,7 +4,7 @@
 #include "Lexer.hpp"
 
 /* GRAMMAR in EBNF
- * 	config_file = { server_block } ;
+ * 	config_file = { directive | server_block } ;
  *	server_block = "server" "{" { statement } "}" ;
  *	statement = directive | location_block ;
  *	directive = IDENTIFIER { parameter } ";" ;
@@ -49,6 +49,7 @@ private:
     static void addDirective(ConfigNode &node, ParsedDirectivePair const &pair);
     void pushTokenTo(ParsedDirectiveArgs &args) const;
 
+    void handleMainContext();
     void handleServerBlock();
     void handleStatement();
     void handleLocationBlock();
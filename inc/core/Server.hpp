@@ -6,6 +6,7 @@
 #include "network/Acceptor.hpp"
 #include "network/EventDispatcher.hpp"
 #include <signal.h>
+#include <sys/types.h>
 #include <vector>
 
 namespace core {
@@ -24,8 +25,15 @@ namespace core {
  * - Setting up listening sockets (Acceptors) based on the ServerConfig.
  * - Installing OS signal handlers (SIGTERM, SIGINT) to initiate a gracefulShutdown().
  * - Running the main event loop by calling EventDispatcher::handleEvents().
+ * - Reaping the worker's CGI processes through a network::ChildReaper.
  * - Managing global, server-wide resources (like the /dev/null FD).
  *
+ * With `worker_processes N` (N > 1) the process becomes a master that forks N
+ * workers. Each worker is pinned to a CPU, owns its own EventDispatcher (epoll
+ * instance) and binds its own SO_REUSEPORT listeners, so the kernel spreads
+ * incoming connections across workers. The master only supervises: it forwards
+ * shutdown signals and respawns workers that die from a signal.
+ *
  * It is implemented as a Singleton (using `instance_`) to allow the static
  * `signalHandler` to access the active Server instance and request a shutdown.
  */
@@ -53,16 +61,21 @@ private:
     bool isRunning_; ///< Tracks main loop state (`true` between `start()` and `gracefulShutdown()`).
     volatile sig_atomic_t shutdownRequested_; ///< Graceful shutdown flag (must be `volatile sig_atomic_t` for signal handler).
     std::vector<network::Acceptor *> acceptors_; ///< Collection of active acceptor handlers (listening sockets).
+    std::vector<pid_t> workers_; ///< Worker PIDs indexed by worker slot (master process only).
 
     config::ServerConfig const &config_; ///< Const reference to the parsed server configuration.
-    network::EventDispatcher &dispatcher_; ///< Reference to the central EventDispatcher (Reactor) singleton.
+    network::EventDispatcher *dispatcher_; ///< The running worker's EventDispatcher (Reactor), NULL outside the event loop.
     http::MimeTypes mimeTypes_; ///< MIME types database instance (passed to the router).
     http::Router router_; ///< HTTP request router for dispatching requests to handlers.
 
     int nullFd_; ///< Server-wide file descriptor for `/dev/null` (opened at startup).
     // clang-format on
 
-    void setupAcceptors();
+    void runWorker(network::EventDispatcher &dispatcher, bool reusePort);
+    bool runMaster(size_t workerCount);
+    pid_t spawnWorker(size_t slot);
+    void setupAcceptors(bool reusePort);
+    void setupFileCache();
     void cleanup();
     void gracefulShutdown();
 
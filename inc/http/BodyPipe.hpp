@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace http {
+
+/**
+ * @class BodyPipe
+ * @brief Carries a request body to a CGI's stdin while the body is still being received.
+ *
+ * The parser appends the decoded body as it arrives; the bytes go straight into a pipe
+ * whose read end is the script's stdin and whose write end is non-blocking. What the
+ * pipe does not take waits in a buffer until flush(): past HIGH_WATER buffered bytes the
+ * connection stops reading the socket, so a script that reads slowly slows the client
+ * down instead of growing the buffer.
+ *
+ * Bytes appended before open() are kept for the script; once the script has gone (it
+ * closed its stdin, or never started) they are dropped, so that the rest of the request
+ * can still be read and the connection reused.
+ */
+class BodyPipe {
+public:
+    static const size_t HIGH_WATER = 64 * 1024; //!< The default pipe capacity.
+
+    enum Status {
+        FLUSHED, //!< Nothing is buffered; more body may follow.
+        PENDING, //!< Bytes wait for the pipe: to be opened, or writable again.
+        DONE     //!< Nothing more goes to the script: the fd can be closed.
+    };
+
+    BodyPipe();
+    ~BodyPipe();
+
+    /**
+     * @brief Creates the pipe.
+     * @return The read end, for the script's stdin (the caller closes it), or -1.
+     */
+    int open();
+
+    /** @brief Passes @p size bytes on, buffering what the pipe does not take. */
+    void write(char const *data, size_t size);
+
+    /** @brief Writes what is buffered, as far as the pipe takes it. */
+    Status flush();
+
+    /** @brief The body is complete: flush() reports DONE once the buffer is out. */
+    void finish();
+
+    /** @brief Closes the write end (the script reads EOF) and drops the rest of the body. */
+    void close();
+
+    /** @brief The write end, or -1 before open() and after close(). */
+    int fd() const;
+
+    /** @brief Whether the connection should stop reading until flush() makes room. */
+    bool isFull() const;
+
+private:
+    BodyPipe(BodyPipe const &);
+    BodyPipe &operator=(BodyPipe const &);
+
+    /** @brief The script is gone: drops the body, keeping the fd for close(). */
+    void drop();
+
+    int fd_;
+    std::string buffer_; //!< Not yet written, from buffer_[sent_].
+    size_t sent_;
+    bool isFinished_;
+    bool isDropped_; //!< Nothing more goes to the script.
+};
+
+} // namespace http
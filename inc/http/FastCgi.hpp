@@ -0,0 +1,185 @@
+#pragma once
+
+#include "http/ResponseBody.hpp"
+#include <map>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+namespace http {
+
+/**
+ * @brief The web server side of the FastCGI 1.0 responder protocol.
+ *
+ * A request is a BEGIN_REQUEST record, the CGI environment as PARAMS records and the
+ * request body as STDIN records, each stream closed by an empty record. The backend
+ * answers with STDOUT records (the same output a CGI script writes), STDERR records and
+ * a final END_REQUEST. Connections carry one request at a time, so every request uses
+ * the same id and asks the backend to keep the connection open for the next one.
+ */
+namespace fastcgi {
+
+enum RecordType {
+    BEGIN_REQUEST = 1,
+    ABORT_REQUEST = 2,
+    END_REQUEST = 3,
+    PARAMS = 4,
+    STDIN = 5,
+    STDOUT = 6,
+    STDERR = 7
+};
+
+const size_t HEADER_SIZE = 8;
+const size_t MAX_CONTENT_LENGTH = 65535;
+const unsigned REQUEST_ID = 1;
+
+/**
+ * @brief Appends @p length bytes of @p type as records to @p out.
+ * Content longer than MAX_CONTENT_LENGTH is split; an empty content appends the empty
+ * record that closes a stream.
+ */
+void appendRecord(std::vector<char> &out, RecordType type, char const *content, size_t length);
+
+/** @brief Appends the BEGIN_REQUEST record of a responder keeping its connection. */
+void appendBeginRequest(std::vector<char> &out);
+
+/** @brief Appends one name-value pair in the PARAMS encoding (not yet a record). */
+void appendParam(std::vector<char> &out, char const *name, size_t nameLength,
+                 char const *value, size_t valueLength);
+
+/**
+ * @class ResponseDecoder
+ * @brief Incremental parser of the records a backend sends for one request.
+ *
+ * Input is fed as it arrives, cut anywhere; STDOUT and STDERR content is handed out as
+ * slices of the input, so decoding copies nothing.
+ */
+class ResponseDecoder {
+public:
+    enum Event {
+        NEED_MORE,    //!< The input is used up.
+        OUTPUT,       //!< A slice of STDOUT content.
+        ERROR_OUTPUT, //!< A slice of STDERR content.
+        END,          //!< The END_REQUEST record: the response is complete.
+        INVALID       //!< Not a FastCGI record.
+    };
+
+    ResponseDecoder();
+
+    /**
+     * @brief Decodes up to the next event.
+     * @param[in,out] data The input, advanced past what was decoded.
+     * @param[in,out] length The number of input bytes, decreased accordingly.
+     * @param[out] payload The content slice, for OUTPUT and ERROR_OUTPUT.
+     * @param[out] payloadLength The length of that slice.
+     */
+    Event next(char const *&data, size_t &length, char const *&payload, size_t &payloadLength);
+
+private:
+    unsigned char header_[HEADER_SIZE];
+    size_t headerLength_; //!< Bytes of the current record header received so far.
+    size_t contentLeft_;
+    size_t paddingLeft_;
+};
+
+/**
+ * @class ConnectionPool
+ * @brief Per-process cache of idle backend connections, by `fastcgi_pass` address.
+ *
+ * Like the OpenFileCache, it is a lazily created singleton: each worker process keeps
+ * its own connections. A connection is only handed back once its response ended
+ * cleanly; one the backend closed while idle is detected and dropped on acquire().
+ */
+class ConnectionPool {
+public:
+    static ConnectionPool &getInstance();
+
+    /**
+     * @brief An idle connection to @p backend, or a new one.
+     * @param backend `unix:/path` or `ip:port`, as stored by the directive.
+     * @return A non-blocking socket, possibly still connecting (it reports EPOLLOUT once
+     * connected), or -1 with errno set.
+     */
+    int acquire(std::string const &backend);
+
+    /** @brief Keeps @p fd for the next request to @p backend, or closes it if enough are. */
+    void release(std::string const &backend, int fd);
+
+    /** @brief The number of idle connections to @p backend. */
+    size_t idleCount(std::string const &backend) const;
+
+    /** @brief Closes every idle connection. */
+    void clear();
+
+private:
+    static const size_t MAX_IDLE = 32; //!< Per backend.
+
+    struct Backend {
+        sockaddr_storage address;
+        socklen_t addressLength;
+        std::vector<int> idle; //!< Most recently released last.
+    };
+    typedef std::map<std::string, Backend> BackendMap;
+
+    ConnectionPool();
+    ~ConnectionPool();
+    ConnectionPool(ConnectionPool const &);
+    ConnectionPool &operator=(ConnectionPool const &);
+
+    static bool parseAddress(std::string const &backend, Backend &entry);
+
+    BackendMap backends_;
+};
+
+} // namespace fastcgi
+
+/**
+ * @class FastCgiBody
+ * @brief A response produced by a FastCGI backend.
+ *
+ * The event source is the backend connection: sendRequest() writes the request records
+ * (the body read from the request body reader as it goes) when it is writable, read()
+ * returns the STDOUT content as a CGI pipe would. The connection goes back to the pool
+ * when the response ended cleanly, and is closed otherwise.
+ */
+class FastCgiBody : public IResponseBody {
+public:
+    /**
+     * @param backend The `fastcgi_pass` address @p fd was acquired for.
+     * @param fd A connection from ConnectionPool::acquire(), owned by the body.
+     * @param envp The CGI environment, as NAME=value strings.
+     * @param stdinFd Reads the request body, or -1 without one; owned by the body.
+     * @param hasHeaderParsing See BodyFromCgi.
+     */
+    FastCgiBody(std::string const &backend, int fd, std::vector<std::string> const &envp,
+                int stdinFd, bool hasHeaderParsing);
+    ~FastCgiBody();
+
+    ssize_t read(char *buffer, size_t size);
+    size_t size() const;
+    bool isDone() const;
+    int getEventSourceFd() const;
+    bool hasHeaderParsing() const;
+    RequestStatus sendRequest();
+
+private:
+    static const size_t STDIN_CHUNK_SIZE = 32 * 1024;
+
+    FastCgiBody();
+    /** @brief Replaces the sent output with the next STDIN record. */
+    bool readStdin();
+
+    std::string backend_;
+    int fd_;
+    int stdinFd_;
+    std::vector<char> output_; //!< Request records not sent yet, from output_[sent_].
+    size_t sent_;
+    bool stdinDone_;   //!< The closing STDIN record is in output_.
+    bool requestSent_; //!< Everything is sent.
+    fastcgi::ResponseDecoder decoder_;
+    bool isDone_;
+    bool isComplete_; //!< The END_REQUEST record arrived, and nothing after it.
+    bool hasHeaderParsing_;
+};
+
+} // namespace http
@@ -49,6 +49,9 @@ std::string extractHeaderParam(const std::string &str, const std::string &toFind
 
 UploadValidationResult parseFilename(Request const &req, MimeTypes const &mime);
 
+/** @brief Rejects names that would escape the upload directory or make a hidden file. */
+UploadValidationResult validateFilename(std::string const &filename);
+
 UploadValidationResult validateUploadPath(const std::string &path);
 
 } // namespace upload
@@ -40,6 +40,12 @@ public:
 class FileUploadHandler : public IHandler {
 public:
     static void handle(Request const &, Response &, MimeTypes const &);
+
+    /**
+     * @brief The directory an upload to @p req's location is stored in, or an empty string
+     * if the location takes no uploads or the directory is unusable (handle() reports why).
+     */
+    static std::string targetDirectory(Request const &req);
 };
 
 class FileDeleteHandler : public IHandler {
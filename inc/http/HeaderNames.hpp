@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace http {
+
+/**
+ * @brief Interned names of the header fields the server knows.
+ *
+ * A name is mapped to its Id by a perfect hash over its length and three of its bytes,
+ * then a single case-insensitive comparison: no allocation, no search.
+ */
+namespace header {
+
+enum Id {
+    UNKNOWN = -1,
+    ACCEPT,
+    ACCEPT_CHARSET,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    ACCEPT_RANGES,
+    AGE,
+    ALLOW,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    CONNECTION,
+    CONTENT_DISPOSITION,
+    CONTENT_ENCODING,
+    CONTENT_LANGUAGE,
+    CONTENT_LENGTH,
+    CONTENT_LOCATION,
+    CONTENT_RANGE,
+    CONTENT_TYPE,
+    COOKIE,
+    DATE,
+    ETAG,
+    EXPECT,
+    EXPIRES,
+    FORWARDED,
+    HOST,
+    IF_MATCH,
+    IF_MODIFIED_SINCE,
+    IF_NONE_MATCH,
+    IF_RANGE,
+    IF_UNMODIFIED_SINCE,
+    KEEP_ALIVE,
+    LAST_MODIFIED,
+    LOCATION,
+    ORIGIN,
+    PRAGMA,
+    RANGE,
+    REFERER,
+    RETRY_AFTER,
+    SERVER,
+    SET_COOKIE,
+    STATUS, //!< CGI response field (RFC 3875 6.3.3).
+    TE,
+    TRAILER,
+    TRANSFER_ENCODING,
+    UPGRADE,
+    USER_AGENT,
+    VARY,
+    VIA,
+    WWW_AUTHENTICATE,
+    X_FILENAME,
+    X_FORWARDED_FOR,
+    COUNT
+};
+
+/** @brief The Id of the @p length bytes at @p name, in any case, or UNKNOWN. */
+Id lookup(char const *name, size_t length);
+
+inline Id lookup(std::string const &name) { return lookup(name.data(), name.size()); }
+
+/** @brief The lowercase name of a known field. */
+std::string const &name(Id id);
+
+/** @brief The name of a known field as it is sent, e.g. "Content-Type", "ETag". */
+std::string const &canonicalName(Id id);
+
+} // namespace header
+
+} // namespace http
@@ -1,8 +1,13 @@
 #pragma once
 
-#include <map>
+#include "http/HeaderNames.hpp"
 #include <sstream>
 #include <string>
+#include <vector>
+
+namespace utils {
+class InputBuffer;
+}
 
 namespace http {
 
@@ -13,12 +18,38 @@ namespace http {
  * This class stores HTTP headers in a case-insensitive manner
  * (by normalizing keys to lowercase) and provides helpers for
  * common header operations.
+ *
+ * Fields are kept in a flat vector, in insertion order. Names the server knows are
+ * interned as a header::Id, and a per-Id slot table makes their lookup O(1) whether
+ * given as an Id or as a string; other names are found by a scan of the (few) unknown
+ * fields. Lookups never allocate, and cleared fields keep their storage for the next
+ * request on the connection.
+ *
+ * Request headers start out as spans of the connection buffer (see assignRaw()):
+ * lookups compare names in place and only the values asked for are copied. The fields
+ * are copied in the first time the headers are modified or iterated.
  */
 class Headers {
 public:
-    typedef std::map<std::string, std::string> HeaderMap;
-    typedef HeaderMap::iterator iterator;
-    typedef HeaderMap::const_iterator const_iterator;
+    struct Field {
+        header::Id id;     //!< header::UNKNOWN for a name the server does not know.
+        std::string name;  //!< Lowercase.
+        std::string value;
+    };
+    typedef std::vector<Field>::const_iterator const_iterator;
+
+    /**
+     * @brief A header field stored as offsets into an external buffer.
+     * Offsets, unlike pointers, stay valid when the buffer grows.
+     */
+    struct RawField {
+        header::Id id; //!< Set by assignRaw().
+        size_t nameOffset;
+        size_t nameLength;
+        size_t valueOffset;
+        size_t valueLength;
+    };
+    typedef std::vector<RawField> RawFields;
 
 public:
     /**
@@ -26,12 +57,28 @@ public:
      */
     Headers();
 
+    /** @brief Copies own their values: a copy never points into the source's buffer. */
+    Headers(Headers const &other);
+    Headers &operator=(Headers const &other);
+
+    /**
+     * @brief Replaces the headers with fields pointing into @p buffer, copying nothing.
+     *
+     * @p buffer must keep the referenced bytes until the headers are cleared, modified
+     * or iterated. Later fields win over earlier ones with the same name.
+     * @param[in,out] fields Swapped in; receives the previous (empty) field storage so
+     * the caller can reuse its capacity.
+     * @return A reference to this Headers object for chaining.
+     */
+    Headers &assignRaw(utils::InputBuffer const &buffer, RawFields &fields);
+
     /**
      * @brief Checks if a header with the given key exists.
      * @param key The header name (case-insensitive).
      * @return True if the header is present, false otherwise.
      */
     bool has(std::string const &key) const;
+    bool has(header::Id id) const;
 
     /**
      * @brief Adds or overwrites a header key-value pair.
@@ -40,6 +87,8 @@ public:
      * @return A reference to this Headers object for chaining.
      */
     Headers &add(std::string const &key, std::string const &value);
+    /** @pre @p id is not header::UNKNOWN. */
+    Headers &add(header::Id id, std::string const &value);
 
     /**
      * @brief C++98-style getter. Retrieves a header value.
@@ -48,6 +97,7 @@ public:
      * @return True if the key was found, false otherwise.
      */
     bool get(const std::string &key, std::string &value) const;
+    bool get(header::Id id, std::string &value) const;
 
     /**
      * @brief C++11-style getter. Retrieves a header value.
@@ -55,14 +105,15 @@ public:
      * @return The header value as a string. Returns an empty string if not found.
      */
     std::string get(const std::string &key) const;
-
+    std::string get(header::Id id) const;
 
     /**
      * @brief A specialized accessor for the Content-Length header.
-     * @return The value of Content-Length as a number, or 0 if not present or
-     * invalid.
+     * @param[out] length The value of Content-Length as a number, or 0 if not present.
+     * @return False if a value is not a plain decimal number that fits in a size_t, or if
+     * several Content-Length fields disagree.
      */
-    size_t getContentLength() const;
+    bool getContentLength(size_t &length) const;
 
     /**
      * @brief Checks if the 'Transfer-Encoding' header is set to 'chunked'.
@@ -82,21 +133,28 @@ public:
      * @return A reference to this Headers object for chaining.
      */
     Headers &erase(std::string const &key);
+    Headers &erase(header::Id id);
+
+    /** @brief Number of fields, counting repeated names once. */
+    size_t size() const;
+
+    /**
+     * @brief Appends every field to @p buffer as "Name: value\r\n", in insertion order.
+     * Known names are written in their canonical case (header::canonicalName()), others
+     * with each word capitalized. Nothing is allocated beyond the growth of @p buffer.
+     */
+    void appendTo(std::vector<char> &buffer) const;
 
     /**
      * @brief Serializes all headers into a single string.
-     * Each header is on its own line, formatted as "Key: Value\r\n".
+     * Each header is on its own line, formatted as by appendTo().
      * @return A string containing all headers for an HTTP response.
      */
     std::string toString() const;
 
     /**
-     * @brief Returns a const reference to the internal header map.
-     * Useful for iterating over all headers (e.g., for CGI environment).
-     * @return Const reference to the internal map of headers.
+     * @brief Iteration over the fields in insertion order, e.g. for the CGI environment.
      */
-    HeaderMap const &getMap() const;
-
     const_iterator find(std::string const &key) const;
     const_iterator begin() const;
     const_iterator end() const;
@@ -125,24 +183,47 @@ public:
     static size_t findHeaderEnd(const std::string &buffer, size_t &offset);
 
 private:
+    static const size_t NPOS = static_cast<size_t>(-1);
+
     /**
-     * @brief Internal: Normalizes a key to lowercase in-place.
+     * @brief Internal: Index of the field (raw or not) named @p key, or NPOS.
      * @internal
      */
-    static void normalizeKey(std::string &key);
+    size_t indexOf(header::Id id, char const *key, size_t length) const;
 
     /**
-     * @brief Internal: Returns a lowercase version of a key.
+     * @brief Internal: Sets the field named @p name (of Id @p id), appending it if new.
      * @internal
      */
-    static std::string normalizeKey(std::string const &key);
+    void set(header::Id id, char const *name, size_t nameLength, char const *value,
+             size_t valueLength) const;
+
+    void removeAt(size_t index);
+
+    /** @brief Internal: Copies the value of field @p index, unless it is NPOS. @internal */
+    bool valueAt(size_t index, std::string &value) const;
+
+    /** @brief Internal: Sets every field of @p other in this one. @internal */
+    void setAll(Headers const &other);
 
     /**
-     * @brief The internal storage for headers, mapping
-     * lowercase_key -> Original_Value.
+     * @brief Internal: Copies the raw fields in and drops the buffer reference.
      * @internal
      */
-    HeaderMap map_;
+    void materialize() const;
+
+    /**
+     * Fields [0, count_) are in use; the rest are spares that keep their strings'
+     * capacity for the next request.
+     * @internal
+     */
+    mutable std::vector<Field> fields_;
+    mutable size_t count_;
+    /** 1 + index of each known field in fields_ (or raw_), 0 when absent. */
+    mutable unsigned slots_[header::COUNT];
+
+    mutable utils::InputBuffer const *rawBuffer_; //!< Non-NULL while the fields below are in use.
+    mutable RawFields raw_;
 };
 
 } // namespace http
@@ -31,6 +31,7 @@ enum HttpStatus {
     FORBIDDEN = 403,    /** *Client authenticated but not authorized for action (Unauthorized). */
     NOT_FOUND = 404,    /** *Requested resource doesn't exist. */
     METHOD_NOT_ALLOWED = 405,     /** *HTTP method not allowed for resource. */
+    REQUEST_TIMEOUT = 408,        /** Client did not send a complete request in time. */
     CONFLICT = 409,               /** *Request failed due to resource conflict (e.g., duplicate). */
     LENGTH_REQUIRED = 411,        /** Missing Content-Length header. */
     PAYLOAD_TOO_LARGE = 413,      /** Request body exceeds limit. */
@@ -40,6 +41,7 @@ enum HttpStatus {
     INTERNAL_SERVER_ERROR = 500, /** *Generic server-side failure. */
     NOT_IMPLEMENTED = 501,       /** Server lacks functionality to fulfill request. */
     BAD_GATEWAY = 502,           /** *Invalid response from upstream server (gateway/proxy). */
+    GATEWAY_TIMEOUT = 504,       /** Upstream server (e.g. a CGI script) did not answer in time. */
 };
 
 HttpStatus toHttpStatus(int);
@@ -48,4 +50,10 @@ HttpStatus toHttpStatus(const std::string &codeStr);
 
 const char *getReasonPhrase(HttpStatus status);
 
+/**
+ * @brief The complete HTTP/1.1 status line of @p status, CRLF included
+ * (e.g. "HTTP/1.1 404 Not Found\r\n"). The lines are built once, on first use.
+ */
+std::string const &getStatusLine(HttpStatus status);
+
 } // namespace http
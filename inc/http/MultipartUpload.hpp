@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/filesystem.hpp"
+#include "http/HttpStatus.hpp"
+#include "http/internal/MultipartParser.hpp"
+#include <string>
+#include <vector>
+
+namespace http {
+
+/**
+ * @class MultipartUpload
+ * @brief Writes the files of a multipart/form-data upload as the body arrives.
+ *
+ * Each file part goes to its own utils::TempFile in the upload directory while it is
+ * being received; FileUploadHandler then renames the files to their names. Plain form
+ * fields and file inputs left empty are skipped. The body itself is never stored.
+ */
+class MultipartUpload : public IMultipartHandler {
+public:
+    struct File {
+        std::string filename;
+        utils::TempFile *file;
+    };
+
+    MultipartUpload(std::string const &boundary, std::string const &directory);
+    virtual ~MultipartUpload();
+
+    /**
+     * @brief Parses the next piece of the body.
+     * @return false only if a file could not be written; a malformed body is reported by
+     * complete() once the whole of it has been read.
+     */
+    bool feed(char const *data, size_t size);
+
+    /** @brief Whether the body was well-formed and closed, and every file was stored. */
+    bool complete() const;
+    HttpStatus errorStatus() const;
+    std::string const &errorMessage() const;
+
+    std::vector<File> const &files() const;
+
+    virtual bool onPartBegin(MultipartPart const &part);
+    virtual bool onPartData(char const *data, size_t size);
+    virtual bool onPartEnd();
+
+    /** Each file keeps a descriptor open until it is stored. */
+    static const size_t MAX_FILES = 64;
+
+private:
+    bool reject(HttpStatus status, std::string const &message);
+
+    MultipartParser parser_;
+    std::string directory_;
+    std::vector<File> files_;
+    bool writing_; //!< The current part is a file.
+    bool ioFailed_;
+    HttpStatus errorStatus_;
+    std::string errorMessage_;
+
+    MultipartUpload(MultipartUpload const &);
+    MultipartUpload &operator=(MultipartUpload const &);
+};
+
+} // namespace http
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+
+namespace http {
+
+/**
+ * @class OpenFileCache
+ * @brief Per-process cache of open file descriptors and stat() results.
+ *
+ * Mirrors nginx's open_file_cache: a lookup of a hot file costs no filesystem
+ * syscall at all. Entries are kept in a bounded LRU list and revalidated once
+ * their validity period expires. When inotify is available every cached path is
+ * watched, and any change (write, chmod, unlink, rename) drops the entry at once;
+ * the validity period is then only a safety net for changes inotify cannot see
+ * (e.g. a parent directory being renamed).
+ *
+ * Descriptors are shared between concurrent responses. Bodies therefore never use
+ * the file offset (see FileBody), and an entry evicted while still in use is only
+ * closed once its last user calls release().
+ *
+ * The cache is a lazily created singleton. Each worker process configures its own
+ * copy after fork(), so nothing (in particular the inotify descriptor) is shared
+ * between workers. While disabled (the default), acquire() still works but hands
+ * out private entries that are closed on release().
+ */
+class OpenFileCache {
+public:
+    /**
+     * @brief A cached lookup result, pinned while refs > 0.
+     */
+    struct Entry {
+        std::string path;
+        int fd;           //!< Read-only descriptor, -1 for anything but regular files.
+        struct stat st;   //!< Result of the stat() done when the entry was loaded.
+        time_t expiresAt; //!< Revalidate after this point in time.
+        int wd;           //!< inotify watch descriptor, -1 if not watched.
+        size_t refs;      //!< Number of acquire() calls not yet released.
+        bool cached;      //!< False once the entry left the cache (or never was in it).
+        std::list<Entry *>::iterator lruPos;
+    };
+
+    static OpenFileCache &getInstance();
+
+    /**
+     * @brief (Re)configures the cache, dropping every current entry.
+     * @param maxEntries Maximum number of cached paths. 0 disables the cache.
+     * @param validity Seconds after which an entry is re-stat()ed even without an
+     * inotify event.
+     */
+    void configure(size_t maxEntries, time_t validity);
+
+    bool enabled() const;
+    size_t size() const;
+
+    /**
+     * @brief Looks up @p path, loading it on a miss.
+     *
+     * Directories and other non-regular files are cached with their stat result only.
+     *
+     * @return A pinned entry that must be handed back with release(), or NULL with
+     * errno set by the failing stat()/open().
+     */
+    Entry *acquire(std::string const &path);
+
+    /** @brief Unpins an entry obtained from acquire(). */
+    void release(Entry *entry);
+
+    /**
+     * @brief The inotify descriptor to watch for readability, or -1 if the cache is
+     * disabled or inotify is unavailable.
+     */
+    int watchFd() const;
+
+    /** @brief Drains pending inotify events and invalidates the affected entries. */
+    void processEvents();
+
+    /** @brief Drops every entry. Pinned entries are closed on their last release(). */
+    void clear();
+
+private:
+    OpenFileCache();
+    ~OpenFileCache();
+    OpenFileCache(OpenFileCache const &);
+    OpenFileCache &operator=(OpenFileCache const &);
+
+    Entry *load(std::string const &path);
+    void insert(Entry *entry);
+    void invalidate(Entry *entry);
+    void unwatch(Entry *entry);
+    static void destroy(Entry *entry);
+
+    typedef std::map<std::string, Entry *> EntryMap;
+    typedef std::multimap<int, Entry *> WatchMap;
+
+    size_t maxEntries_;
+    time_t validity_;
+    int inotifyFd_;
+    EntryMap entries_;
+    WatchMap watches_;
+    std::list<Entry *> lru_; //!< Most recently used first.
+};
+
+} // namespace http
@@ -3,6 +3,7 @@
 #include "common/filesystem.hpp"
 #include "http/Headers.hpp"
 #include "http/HttpStatus.hpp"
+#include "http/RequestBody.hpp"
 #include <aio.h>
 
 namespace config {
@@ -14,10 +15,6 @@ namespace network {
 class ClientHandler;
 } // namespace network
 
-namespace utils {
-class TempFile;
-} // namespace utils
-
 namespace http {
 
 /**
@@ -37,17 +34,18 @@ public:
     std::string version;     //!< The HTTP protocol version (e.g., "HTTP/1.1")
 
     /**
-     * @brief Parses a raw request line (e.g., "GET /path?q HTTP/1.1").
-     * @param line The raw string to parse.
-     * @return A populated RequestStartLine object.
+     * @brief Sets the request-target and splits it into path and query string.
      */
-    static RequestStartLine parse(std::string const &line);
+    void setTarget(char const *target, size_t length);
 
     /**
      * @brief Converts a method string (e.g., "GET") to its enum.
      */
     static Method matchHttpMethod(std::string const &s);
 
+    /** @copydoc matchHttpMethod */
+    static Method matchHttpMethod(char const *s, size_t length);
+
     /**
      * @brief Converts a method enum to its string representation.
      */
@@ -82,6 +80,16 @@ public:
 
     size_t getMaxAllowedContentSize() const;
 
+    /** @brief `client_body_buffer_size` of the location or server, 16k by default. */
+    size_t getBodyBufferSize() const;
+
+    /**
+     * @brief Where a body too large for memory is spooled: the upload directory of an
+     * upload (see Router::matchServerAndLocation()), so that storing it is a rename;
+     * otherwise `client_body_temp_path` of the location or server, /tmp by default.
+     */
+    std::string getBodyTempPath() const;
+
     // --- Public Read-only Accessors ---
 
     /**
@@ -136,8 +144,8 @@ public:
      */
     std::string const &version() const;
 
-    utils::TempFile const *body() const;
-    utils::TempFile *body();
+    RequestBody const *body() const;
+    RequestBody *body();
 
     const std::string &bodyPath() const;
 
@@ -193,7 +201,9 @@ protected:
     Request &path(std::string const &);
     Request &version(std::string const &);
     Request &remoteAddr(std::string const &addr);
-    Request &body(utils::TempFile *body);
+    Request &body(RequestBody *body);
+    Request &uploadDirectory(std::string const &directory);
+    Request &pipesBody(bool pipes);
 
 private:
     Request(const Request &);
@@ -201,11 +211,13 @@ private:
 
     RequestStartLine requestLine_;
     Headers headers_;
-    utils::TempFile *body_;
+    RequestBody *body_;
     config::LocationBlock const *location_;
     config::ServerBlock const *server_;
     HttpStatus status_;
     std::string remoteAddr_; // Client IP address
+    std::string uploadDirectory_; // Set by the Router when the body is an upload
+    bool pipesBody_; // Set by the Router when the body streams to a CGI as it arrives
 };
 
 } // namespace http
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "common/filesystem.hpp"
+#include <string>
+
+namespace http {
+
+class BodyPipe;
+class MultipartUpload;
+
+/**
+ * @class RequestBody
+ * @brief A request body, kept in memory while it is small and spilled to a file after.
+ *
+ * Bodies up to `client_body_buffer_size` bytes stay in a buffer recycled through
+ * utils::BufferPool, so a small POST costs no file system call at all. The first write
+ * past the limit moves the body to a utils::TempFile in `client_body_temp_path`, and
+ * everything after goes straight to that file.
+ *
+ * The body of a multipart/form-data upload is not kept at all: it streams through a
+ * MultipartUpload, which writes each file where it is to be stored; neither is the body
+ * of a CGI request with `cgi_request_buffering off`, which streams through a BodyPipe
+ * into the script's stdin.
+ */
+class RequestBody {
+public:
+    /**
+     * @param memoryLimit Largest body kept in memory; 0 writes every byte to the file.
+     * @param tempDirectory Where the file is created once the body outgrows the limit.
+     */
+    RequestBody(size_t memoryLimit, std::string const &tempDirectory);
+    ~RequestBody();
+
+    /**
+     * @brief Adds @p size bytes at the end of the body.
+     * @return false if the body could not be spilled or written to its file.
+     */
+    bool append(char const *data, size_t size);
+
+    /** @brief Moves the body to its file now, so that the rest can be written to fd(). */
+    bool spill();
+
+    /** @brief Accounts for @p size bytes the caller wrote to fd() itself (e.g. splice()). */
+    void addWritten(size_t size);
+
+    /** @brief Passes every byte appended from now on to @p upload (takes ownership). */
+    void streamTo(MultipartUpload *upload);
+
+    /** @brief The upload the body streams through, or NULL. */
+    MultipartUpload *multipart() const;
+
+    /** @brief Passes every byte appended from now on to @p pipe (takes ownership). */
+    void streamTo(BodyPipe *pipe);
+
+    /** @brief The pipe the body streams through, or NULL. */
+    BodyPipe *pipe() const;
+
+    /**
+     * @brief Hands the pipe over to the caller, which deletes it once the body is gone.
+     * The body keeps streaming through it: the reader of a pipe outlives the request
+     * when the request is cleared mid-body (a parse error).
+     */
+    BodyPipe *releasePipe();
+
+    size_t size() const;
+    bool inMemory() const;
+
+    /** @brief The body, while it is in memory. */
+    std::string const &data() const;
+
+    /** @brief The file holding the body, or -1 while it is in memory. */
+    int fd() const;
+
+    /** @brief Path of the file holding the body, empty while it is in memory. */
+    std::string const &path() const;
+
+    /** @brief Moves the file position back to the start, for reading. */
+    bool rewind();
+
+    /**
+     * @brief A new descriptor that reads the body from its start, e.g. for a CGI's stdin.
+     *
+     * A spilled body is shared through dup(). An in-memory body is written into a pipe
+     * when it fits in the pipe's buffer, and into a memfd otherwise; either way nothing
+     * touches the file system. The caller closes the descriptor.
+     * @return The descriptor, or -1 on failure.
+     */
+    int openReader() const;
+
+    /**
+     * @brief Stores the body at @p destPath: the file is renamed, an in-memory body
+     * is written to a new file.
+     * @see utils::TempFile::moveTo()
+     */
+    utils::TempFile::MoveStatus moveTo(std::string const &destPath);
+
+private:
+    size_t memoryLimit_;
+    std::string tempDirectory_;
+    std::string memory_; //!< Storage recycled through utils::BufferPool.
+    utils::TempFile file_;
+    MultipartUpload *multipart_;
+    BodyPipe *pipe_;
+    bool ownsPipe_;
+    size_t size_;
+
+    RequestBody(RequestBody const &);
+    RequestBody &operator=(RequestBody const &);
+};
+
+} // namespace http
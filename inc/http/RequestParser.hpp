@@ -2,6 +2,8 @@
 #include "http/HttpStatus.hpp"
 #include "http/Request.hpp"
 #include "http/internal/ChunkedBodyParser.hpp"
+#include "http/internal/RequestHeadParser.hpp"
+#include "utils/InputBuffer.hpp"
 #include <ostream>
 #include <string>
 #include <sys/types.h>
@@ -38,6 +40,32 @@ public:
      */
     State feed(char const *chunk, size_t size);
 
+    /**
+     * @brief Free space at the end of the input buffer, for the socket to be read into
+     * directly. At least @p minSize bytes; the actual amount is stored in @p space.
+     */
+    char *inputSpace(size_t minSize, size_t &space);
+
+    /**
+     * @brief Parses @p size bytes written to the space returned by inputSpace().
+     * @return The new state of the parser, as with feed().
+     */
+    State commitInput(size_t size);
+
+    /**
+     * @brief The file the rest of a Content-Length body may be spliced into from the
+     * socket, bypassing the input buffer; -1 unless the body is being written to a file
+     * and every byte received so far has been consumed.
+     * @param size Set to the number of body bytes still expected.
+     */
+    int spliceTarget(size_t &size) const;
+
+    /** @brief Accounts for @p size body bytes written to spliceTarget() directly. */
+    State commitSpliced(size_t size);
+
+    /** @brief Abandons the request with @p status, e.g. when the caller failed to store it. */
+    State fail(HttpStatus status);
+
     /**
      * @brief Resumes parsing after the HEADERS_READY pause.
      *
@@ -52,9 +80,12 @@ public:
 
     State state() const;
     HttpStatus errorStatus() const;
-    bool hasLeftoverData() const { return !buffer_.empty(); }
+    bool hasLeftoverData() const { return input_.size() > consumed_; }
 
 private:
+    /** @brief Internal: Runs the state machine over the buffered input. */
+    State parse();
+
     /**
      * @brief Internal: Tries to find and parse the full header block.
      * @return New state (READING_HEADERS or HEADERS_READY).
@@ -67,9 +98,22 @@ private:
      */
     State parseBody();
 
+    /**
+     * @brief Internal: Creates the Request's body: a multipart/form-data upload streams
+     * through a MultipartUpload, anything else is stored by the RequestBody.
+     * @return false (and ERROR) if its file could not be created.
+     */
+    bool createBody();
+
     void handleChunkedBody();
     void handleContentLengthBody();
-    bool writeToBodyFile(const std::string &data);
+    bool writeToBody(const std::string &data);
+
+    /**
+     * @brief Drops the body bytes consumed so far once that is cheap (see reset()),
+     * keeping the head in place: the request's headers point into it until reset().
+     */
+    void discardConsumedBody();
 
     /**
      * @brief Sets the parser to an error state and updates the Request's status.
@@ -81,7 +125,8 @@ private:
     State state_;
     HttpStatus errorStatus_;
 
-    std::string buffer_;
+    utils::InputBuffer input_;
+    size_t consumed_; //!< Bytes of input_ belonging to the current request.
 
     size_t maxHeaderSize_;  // Hard-coded server limit
     size_t maxContentSize_; // Policy-driven limit, set in proceedReadingBody()
@@ -92,7 +137,11 @@ private:
 
     Request &request_;
 
+    RequestHeadParser headParser_;
     ChunkedBodyParser chunkParser_;
+
+    RequestParser(RequestParser const &);
+    RequestParser &operator=(RequestParser const &);
 };
 
 std::ostream &operator<<(std::ostream &o, RequestParser::State st);
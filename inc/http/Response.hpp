@@ -2,10 +2,14 @@
 
 #include "http/Headers.hpp"
 #include "http/HttpStatus.hpp"
+#include "http/OpenFileCache.hpp"
 #include <vector>
 
 namespace http {
 
+/** @brief Product token sent as the Server field and as the CGI SERVER_SOFTWARE. */
+extern char const SERVER_SOFTWARE[];
+
 // Forward-declare the body interface
 class IResponseBody;
 
@@ -75,14 +79,37 @@ public:
      */
     Response &setBodyFromFile(std::string const &fpath, std::string const &contentType);
 
+    /**
+     * @brief Sets the response body to stream from an already opened file.
+     * @param file A pinned OpenFileCache entry of a regular file; ownership of the pin
+     * passes to the body (released here if the body cannot be created).
+     * @param contentType The MIME type of the file.
+     * @return A reference to this object for chaining.
+     */
+    Response &setBodyFromFile(OpenFileCache::Entry *file, std::string const &contentType);
+
     /**
      * @brief Sets the response body to stream from a CGI pipe.
      * @param pipeFd The file descriptor of the CGI script's output pipe.
+     * @param pid The script's process.
      * @param hasHeaderParsing If true, the response expects the pipe to contain HTTP headers that
      * need parsing before the body content.
      * @return A reference to this object for chaining.
      */
-    Response &setBodyFromCgi(int pipeFd, bool hasHeaderParsing);
+    Response &setBodyFromCgi(int pipeFd, pid_t pid, bool hasHeaderParsing);
+
+    /**
+     * @brief Sets the response body to come from a FastCGI backend (see FastCgiBody).
+     * @param backend The `fastcgi_pass` address.
+     * @param fd The backend connection; ownership passes to the body.
+     * @param envp The CGI environment, sent as the request's params.
+     * @param stdinFd Reads the request body, or -1; ownership passes to the body.
+     * @param hasHeaderParsing As for setBodyFromCgi().
+     * @return A reference to this object for chaining.
+     */
+    Response &setBodyFromFastCgi(std::string const &backend, int fd,
+                                 std::vector<std::string> const &envp, int stdinFd,
+                                 bool hasHeaderParsing);
 
     // --- Header & Status Management ---
 
@@ -97,8 +124,12 @@ public:
     Headers const &headers() const;
 
     /**
-     * @brief Appends the fully formatted start-line and headers to a buffer.
-     * @param buffer The send buffer to which headers will be appended.
+     * @brief Writes the status line, the Server and Date fields, and the headers.
+     *
+     * Everything is copied from prebuilt storage (see getStatusLine() and
+     * Headers::appendTo()) straight into @p buffer, whose capacity is kept from one
+     * response to the next.
+     * @param buffer The send buffer; cleared first.
      * @param addBodyLine If true, an extra CRLF line is added after the headers
      */
     void buildHeaders(std::vector<char> &buffer, bool addBodyLine = true) const;
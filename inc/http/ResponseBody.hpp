@@ -1,7 +1,9 @@
 #pragma once
 
+#include "http/OpenFileCache.hpp"
 #include <aio.h>
 #include <string>
+#include <sys/types.h>
 
 namespace http {
 
@@ -15,6 +17,8 @@ namespace http {
  */
 class IResponseBody {
 public:
+    enum RequestStatus { REQUEST_SENT, REQUEST_PENDING, REQUEST_FAILED };
+
     IResponseBody() {}
     virtual ~IResponseBody() {}
 
@@ -68,22 +72,91 @@ public:
      */
     virtual bool hasHeaderParsing() const;
 
+    /**
+     * @brief The process producing the body (a CGI script), for the Reactor to stop it
+     * if it overruns.
+     * @return The pid, or -1 if no local process is involved (default).
+     */
+    virtual pid_t processId() const;
+
+    /**
+     * @brief Writes the request to the event source, for sources that must receive it
+     * before answering (e.g. a FastCGI backend). Called again whenever the fd is writable.
+     *
+     * @return REQUEST_SENT once everything is written (default: nothing to write).
+     * @return REQUEST_PENDING if the fd is full; EPOLLOUT will report it writable.
+     * @return REQUEST_FAILED if the source cannot be reached.
+     */
+    virtual RequestStatus sendRequest();
+
+    /**
+     * @brief Exposes the unsent part of the body as a region of a regular file.
+     *
+     * Bodies backed by a file can be transmitted with sendfile(2), skipping the
+     * copy through a user-space buffer. After sending, the Reactor reports the
+     * progress with consume().
+     *
+     * @param[out] fd The file descriptor to send from.
+     * @param[out] offset The file offset of the first unsent byte.
+     * @param[out] length The number of bytes left to send.
+     * @return true if the body is file-backed and the outputs are valid.
+     * @return false if the body must be streamed through read() (default).
+     */
+    virtual bool fileRegion(int &fd, off_t &offset, size_t &length) const;
+
+    /**
+     * @brief Exposes the unsent part of the body as a contiguous memory segment.
+     *
+     * Lets the Reactor gather the body behind the headers in a single writev/sendmsg
+     * call instead of copying it through the send buffer.
+     *
+     * @param[out] data The first unsent byte.
+     * @param[out] length The number of bytes left to send.
+     * @return true if the body lives in memory and the outputs are valid.
+     * @return false otherwise (default).
+     */
+    virtual bool memoryRegion(char const *&data, size_t &length) const;
+
+    /**
+     * @brief Marks bytes as sent after a zero-copy transfer of the fileRegion() or
+     * memoryRegion().
+     * @param bytes The number of bytes the kernel transmitted.
+     */
+    virtual void consume(size_t bytes);
+
 private:
     IResponseBody(IResponseBody const &);
     IResponseBody const &operator=(IResponseBody const &);
 };
 
+/**
+ * @class FileBody
+ * @brief Streams a regular file obtained from the OpenFileCache.
+ *
+ * The descriptor may be shared with other responses, so the body keeps its own
+ * position and only ever uses positional I/O (pread, sendfile with an offset).
+ */
 class FileBody : public IResponseBody {
 public:
+    /**
+     * @brief Looks @p fpath up in the OpenFileCache.
+     * @throws std::runtime_error if the file cannot be opened or is not a regular file.
+     */
     explicit FileBody(std::string const &fpath);
+    /**
+     * @brief Takes over a pinned entry of a regular file (released on destruction).
+     */
+    explicit FileBody(OpenFileCache::Entry *file);
     ~FileBody();
 
     ssize_t read(char *buffer, size_t size);
     size_t size() const;
     bool isDone() const;
+    bool fileRegion(int &fd, off_t &offset, size_t &length) const;
+    void consume(size_t bytes);
 
 private:
-    int fd_;
+    OpenFileCache::Entry *file_;
     size_t size_;
     size_t sent_;
 };
@@ -95,6 +168,8 @@ public:
     ssize_t read(char *buffer, size_t size);
     size_t size() const;
     bool isDone() const;
+    bool memoryRegion(char const *&data, size_t &length) const;
+    void consume(size_t bytes);
 
 private:
     std::string body_;
@@ -103,17 +178,19 @@ private:
 
 class BodyFromCgi : public IResponseBody {
 public:
-    BodyFromCgi(int pipeFd, bool hasHeaderParsing);
+    BodyFromCgi(int pipeFd, pid_t pid, bool hasHeaderParsing);
     ~BodyFromCgi();
     ssize_t read(char *buffer, size_t size);
     size_t size() const;
     bool isDone() const;
     int getEventSourceFd() const;
     bool hasHeaderParsing() const;
+    pid_t processId() const;
 
 private:
     BodyFromCgi();
     int fd_;
+    pid_t pid_;
     bool isDone_;
     bool hasHeaderParsing_;
 };
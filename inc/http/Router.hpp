@@ -52,6 +52,9 @@ public:
     /** @copydoc handleError */
     void handleError(Request const &, Response &) const;
 
+    /** @brief The configuration requests are routed against. */
+    config::ServerConfig const &config() const;
+
 private:
     /**
      * @brief Populates an error response.
@@ -2,6 +2,7 @@
 
 #include "http/Handler.hpp"
 #include <string>
+#include <sys/types.h>
 #include <vector>
 
 namespace http {
@@ -12,17 +13,40 @@ public:
 
     static void handle(Request const &, Response &, MimeTypes const &);
 
+    /** @brief argv[1] that makes the server binary run as the `cgi_limits` exec wrapper. */
+    static char const *const LIMITS_WRAPPER;
+
+    /**
+     * @brief The `cgi_limits` exec wrapper: `webserv LIMITS_WRAPPER cpu as nofile path args`.
+     *
+     * Sets the limits that are not 0 on its own process, then execs the script with the
+     * same environment, so that they hold from the script's first instruction.
+     * @return 127 if a limit could not be set or the script could not be started;
+     * does not return otherwise.
+     */
+    static int execWithLimits(int argc, char **argv);
+
 private:
     CGIHandler(Request const &req, Response &res);
 
     void handle();
+    void passToFastCgi();
     void buildArgv();
     void buildEnvp();
     bool initPipes();
-    void fork();
-    int execve();
-    void runChildProcess();
-    void runParentProcess();
+    void closeStdin();
+    /**
+     * @brief Starts the script with posix_spawn(), its stdout on the pipe.
+     *
+     * posix_spawn() runs the child in the parent's address space until it has exec'd
+     * (vfork semantics): unlike fork(), the launch does not copy the page tables of
+     * the whole server, so its cost does not grow with the server's memory. An exec
+     * failure is returned by the call itself.
+     *
+     * posix_spawn() cannot set resource limits: with `cgi_limits`, the child execs the
+     * server binary as execWithLimits() first, which execs the script.
+     */
+    void spawn();
 
     Request const &req_;
     Response &res_;
@@ -30,8 +54,8 @@ private:
     std::vector<std::string> argv_;
     std::vector<std::string> envp_;
     int pipeFd_[2];
-    int errorFd_[2];
-    int pid_;
+    int stdinFd_; //!< Reads the request body from its start; -1 without a body.
+    pid_t pid_;
 };
 
 } // namespace http
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+namespace http {
+
+/**
+ * @brief Vectorized byte classification for the HTTP/1.1 grammar.
+ *
+ * The kernels test 32 (AVX2) or 16 (SSE2) bytes per step; the widest one the CPU
+ * supports is picked through cpuid at startup, with a table-driven scalar fallback
+ * for other CPUs and architectures. All of them return the same results.
+ */
+namespace scan {
+
+enum Level { SCALAR, SSE2, AVX2 };
+
+/**
+ * @brief Offset of the first control character other than HTAB (CR and LF included)
+ * or DEL in @p data, or @p size if there is none.
+ */
+size_t findControl(char const *data, size_t size);
+
+/**
+ * @brief Offset of the first byte that is not an RFC 9110 token character (such as
+ * ':' or whitespace after a field name), or @p size if there is none.
+ */
+size_t findNonToken(char const *data, size_t size);
+
+/** @brief The kernels in use. */
+Level level();
+
+/**
+ * @brief Switches kernels, clamped to what the CPU supports (for tests and benchmarks).
+ * @return The level now in use.
+ */
+Level setLevel(Level level);
+
+char const *levelName(Level level);
+
+} // namespace scan
+
+} // namespace http
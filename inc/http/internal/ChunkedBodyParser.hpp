@@ -57,8 +57,11 @@ private:
     ParseResult readTrailerCrlf(const char* input, size_t size, std::string& output);
     ParseResult readFinalCrlf(const char* input, size_t size, std::string& output);
 
+    /** @brief Handles a complete size line; @p consumed counts its input bytes. */
+    ParseResult onSizeLine(const char* line, size_t length, size_t consumed);
+
     ParseResult setError(HttpStatus status);
-    bool parseHex(const std::string& hex, size_t& result) const;
+    bool parseHex(const char* hex, size_t length, size_t& result) const;
 
     InternalState state_;
     std::string sizeBuffer_;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "http/HttpStatus.hpp"
+#include <string>
+
+namespace http {
+
+/** @brief The headers of one multipart/form-data part that matter to a receiver. */
+struct MultipartPart {
+    std::string name;        //!< `name` parameter of Content-Disposition.
+    std::string filename;    //!< `filename` parameter; empty for a plain form field.
+    bool hasFilename;        //!< Whether `filename` was given at all, even empty.
+    std::string contentType; //!< Content-Type of the part, if any.
+
+    MultipartPart();
+};
+
+/**
+ * @brief Receives the parts of a multipart body as MultipartParser finds them.
+ * Returning false from a callback stops the parser (MultipartParser::PARSE_ERROR).
+ */
+class IMultipartHandler {
+public:
+    virtual ~IMultipartHandler() {}
+    virtual bool onPartBegin(MultipartPart const &part) = 0;
+    /** @brief A piece of the current part's content; a part may arrive in any number. */
+    virtual bool onPartData(char const *data, size_t size) = 0;
+    virtual bool onPartEnd() = 0;
+};
+
+/**
+ * @class MultipartParser
+ * @brief Incremental RFC 2046 / RFC 7578 parser for multipart/form-data bodies.
+ *
+ * The body is fed as it arrives, in pieces of any size, and part contents are passed on
+ * without being buffered: only the bytes at the end of a piece that could start a
+ * delimiter are held back (at most its length minus one). Delimiters are found with a
+ * Boyer-Moore-Horspool search, so content is scanned once and mostly by skips of the
+ * delimiter's length.
+ */
+class MultipartParser {
+public:
+    enum Status {
+        PARSE_CONTINUE, //!< More body expected.
+        PARSE_DONE,     //!< The close delimiter was seen; what follows is ignored.
+        PARSE_ERROR
+    };
+
+    MultipartParser(std::string const &boundary, IMultipartHandler &handler);
+
+    /** @brief Parses the next @p size bytes of the body. */
+    Status feed(char const *data, size_t size);
+
+    Status status() const;
+    HttpStatus errorStatus() const;
+
+    /**
+     * @brief The `boundary` parameter of a multipart/form-data Content-Type.
+     * @return false if @p contentType is not multipart/form-data or has no valid boundary.
+     */
+    static bool boundaryOf(std::string const &contentType, std::string &boundary);
+
+    static const size_t MAX_PART_HEADER_SIZE = 8192;
+
+private:
+    enum InternalState {
+        PREAMBLE,       //!< Before the first delimiter; discarded.
+        AFTER_BOUNDARY, //!< Reading the "--" or CRLF that ends a delimiter line.
+        PART_HEADERS,
+        PART_DATA,
+        DONE,
+        ERROR
+    };
+
+    size_t scanContent(char const *data, size_t size);
+    size_t readBoundaryEnd(char const *data, size_t size);
+    size_t readPartHeaders(char const *data, size_t size);
+    bool parsePartHeaders(std::string const &block, MultipartPart &part) const;
+
+    /** @brief Offset of the delimiter in @p data, or @p size if it is not there. */
+    size_t findDelimiter(char const *data, size_t size) const;
+    /** @brief Length of the longest suffix of @p data that starts the delimiter. */
+    size_t partialDelimiter(char const *data, size_t size) const;
+    /** @brief Passes content on (PART_DATA) or drops it (PREAMBLE). */
+    bool emit(char const *data, size_t size);
+    bool onDelimiter();
+
+    Status setError(HttpStatus status);
+
+    std::string delimiter_; //!< CRLF "--" boundary
+    size_t skip_[256];      //!< Horspool shift for each byte value.
+    IMultipartHandler &handler_;
+    InternalState state_;
+    std::string held_;   //!< Bytes from the last piece that may start a delimiter.
+    std::string buffer_; //!< The part's header block, or the end of a delimiter line.
+    HttpStatus errorStatus_;
+};
+
+} // namespace http
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "http/Headers.hpp"
+#include <cstddef>
+
+namespace http {
+
+/**
+ * @class RequestHeadParser
+ * @brief Resumable scanner for the request line and header fields.
+ *
+ * Each call to parse() continues where the previous one stopped, so every byte of the
+ * head is examined once however the data is split across reads. Nothing is copied:
+ * the request line and the fields are recorded as offsets into the caller's buffer.
+ *
+ * Accepted: CRLF or bare LF line endings, empty lines before the request line, and
+ * runs of SP/HTAB between the request-line parts. Rejected: field names that are not
+ * tokens (including whitespace before the colon and obs-fold continuation lines) and
+ * control characters other than HTAB.
+ */
+class RequestHeadParser {
+public:
+    enum Status { HEAD_INCOMPLETE, HEAD_COMPLETE, HEAD_ERROR };
+
+    struct Span {
+        size_t offset;
+        size_t length;
+    };
+
+    RequestHeadParser();
+
+    /** @brief Starts over with a head that begins at @p offset of the buffer. */
+    void reset(size_t offset = 0);
+
+    /**
+     * @brief Continues scanning the buffered head.
+     * @param data The connection buffer; the bytes scanned by previous calls since the
+     * last reset() must be unchanged.
+     * @param size Number of bytes in @p data.
+     */
+    Status parse(char const *data, size_t size);
+
+    Span method() const;
+    Span target() const;
+    Span version() const;
+
+    /** @brief Parsed fields; may be swapped out (see Headers::assignRaw()). */
+    Headers::RawFields &fields();
+
+    /** @brief Offset just past the blank line ending the head, once HEAD_COMPLETE. */
+    size_t headEnd() const;
+
+private:
+    bool parseRequestLine(char const *data, size_t begin, size_t end);
+    bool parseField(char const *data, size_t begin, size_t end);
+
+    size_t scanned_;   //!< Bytes already examined.
+    size_t lineStart_; //!< Offset of the line being scanned.
+    size_t headEnd_;
+    bool hasRequestLine_;
+    Span method_;
+    Span target_;
+    Span version_;
+    Headers::RawFields fields_;
+};
+
+} // namespace http
@@ -7,6 +7,8 @@
 
 namespace network {
 
+class EventDispatcher;
+
 /**
  * @brief Acceptor inherent from IEventHandler  as a concrete class that accepts new client
  * connections.
@@ -19,8 +21,10 @@ namespace network {
  */
 class Acceptor : public IEventHandler {
 public:
-    Acceptor(int port, http::Router const &);
-    Acceptor(config::ServerBlock const &, http::Router const &);
+    Acceptor(int port, config::ListenOptions const &, http::Router const &, EventDispatcher &,
+             bool reusePort = false);
+    Acceptor(config::ServerBlock const &, http::Router const &, EventDispatcher &,
+             bool reusePort = false);
     ~Acceptor();
 
     void handleEvent(uint32_t events);
@@ -30,8 +34,10 @@ private:
     Socket socket_;
     int port_;
     http::Router const &router_;
+    EventDispatcher &dispatcher_;
 
-    void acceptNewConnection();
+    /// @brief Accepts every pending connection, until accept4() reports EAGAIN.
+    void acceptNewConnections();
 
     Acceptor(const Acceptor &);
     Acceptor &operator=(const Acceptor &);
@@ -1,22 +1,65 @@
 #pragma once
 
+#include "config/ServerConfig.hpp"
 #include "network/ClientHandler.hpp"
 #include "network/IEventHandler.hpp"
 
 namespace network {
 
+/**
+ * @brief Reads a CGI script's (or FastCGI backend's) output into its client's response.
+ *
+ * The handler enforces `cgi_timeout` on the whole exchange and `cgi_read_timeout`
+ * between two reads of the output (or two writes of a streamed request body, see
+ * restartTimer()); the latter does not run while the client is too slow to take the
+ * output. A script that times out, sends invalid headers or loses its client before its
+ * output ended is stopped through the ChildReaper.
+ */
 class CGIHandler : public IEventHandler {
 public:
-    CGIHandler(http::IResponseBody &body, ClientHandler &client, bool hasHeaderParsing);
+    CGIHandler(http::IResponseBody &body, ClientHandler &client, bool hasHeaderParsing,
+               config::Timeouts const &timeouts);
+    ~CGIHandler();
+
+    /**
+     * @brief Starts the timeouts, and sending the request for bodies that take one
+     * (FastCGI). Called once the handler is registered; EPOLLOUT drives the rest.
+     */
+    void start();
+
+    /** @brief Stops reading while the client's send buffer is full. */
+    void pause();
+
+    /** @brief Reads again once the client's send buffer has drained. */
+    void resume();
+
+    /** @brief Restarts `cgi_read_timeout`: the script makes progress reading its body. */
+    void restartTimer();
 
     void handleEvent(uint32_t events);
+    void handleTimeout();
     int getFd() const;
+    bool supportsEdgeTriggered() const;
 
 private:
     enum State { READING_HEADERS, STREAMING_BODY, COMPLETE };
 
+    static const size_t READ_BUDGET = 256 * 1024; //!< Per event, edge-triggered.
+
 private:
     void handleRead();
+    /** @return false if the request failed and the client got an error instead. */
+    bool handleWrite();
+    /**
+     * @brief Reads and forwards one chunk of CGI output.
+     * @param[out] bytesRead The number of bytes consumed from the pipe.
+     * @return true if the pipe may hold more data and the handler is still active.
+     */
+    bool readChunk(size_t &bytesRead);
+    /** @brief Stops the script and answers the client with @p status instead. */
+    void abort(http::HttpStatus status);
+    /** @brief Arms the timer for the nearer of the two timeouts, if any. */
+    void armTimer();
 
 private:
     http::IResponseBody &body_;
@@ -24,6 +67,11 @@ private:
     std::string headerBuffer_;
     State state_;
     int fd_;
+    pid_t pid_; //!< The script, or -1 for a FastCGI backend.
+    config::Timeouts const &timeouts_;
+    uint64_t deadline_; //!< When `cgi_timeout` expires (TimerWheel::now() time), 0 if never.
+    bool isSendingRequest_;
+    bool isPaused_;
 };
 
 } // namespace network
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "network/IEventHandler.hpp"
+
+namespace network {
+
+class ClientHandler;
+
+/**
+ * @class CgiInputHandler
+ * @brief Watches the stdin pipe of a CGI script that gets its body while it arrives.
+ *
+ * Registered by the ClientHandler when the script has started on a http::BodyPipe, and
+ * only waiting for EPOLLOUT while the pipe holds back part of the body. The pipe belongs
+ * to the request: events are passed on to the client, which writes what the pipe takes
+ * and resumes reading the socket once there is room.
+ */
+class CgiInputHandler : public IEventHandler {
+public:
+    /** @param fd The write end of the pipe, closed by its owner after removal. */
+    CgiInputHandler(int fd, ClientHandler &client);
+
+    void handleEvent(uint32_t events);
+    int getFd() const;
+    bool supportsEdgeTriggered() const;
+
+private:
+    int fd_;
+    ClientHandler &client_;
+};
+
+} // namespace network
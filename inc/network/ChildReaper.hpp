@@ -0,0 +1,66 @@
+#pragma once
+
+#include "IEventHandler.hpp"
+#include <map>
+#include <signal.h>
+#include <sys/types.h>
+
+namespace network {
+
+class EventDispatcher;
+
+/**
+ * @brief Reaps the worker's CGI processes as they exit, through the event loop.
+ *
+ * SIGCHLD is blocked in the worker and delivered to a signalfd instead, so an exiting
+ * child makes the fd readable rather than interrupting epoll_wait(). The reaper then
+ * collects every child that has exited; nothing polls waitpid() while none has.
+ *
+ * Children would inherit the blocked mask: http::CGIHandler::spawn() clears it in the
+ * child.
+ *
+ * The reaper also stops the scripts that overrun (see CGIHandler): terminate() sends
+ * SIGTERM to the script's process group, and SIGKILL KILL_DELAY_MS later if it is still
+ * there. Only watched children are signalled, and only until they are reaped, so a pid
+ * the kernel has handed to another process is never signalled.
+ */
+class ChildReaper : public IEventHandler {
+public:
+    static const uint64_t KILL_DELAY_MS = 5000; //!< From SIGTERM to SIGKILL.
+
+    /** @throws std::runtime_error if the signalfd cannot be created. */
+    explicit ChildReaper(EventDispatcher &dispatcher);
+    ~ChildReaper();
+
+    void handleEvent(uint32_t events);
+    void handleTimeout();
+    int getFd() const;
+    bool supportsEdgeTriggered() const;
+
+    /** @brief Collects the exited children. @return How many were collected. */
+    size_t reap();
+
+    /** @brief Lets terminate() signal @p pid, a child of this worker, until it is reaped. */
+    static void watch(pid_t pid);
+
+    /** @brief Stops a watched child (no-op for any other pid, or one being stopped). */
+    static void terminate(pid_t pid);
+
+private:
+    /** @brief Arms the timeout for the earliest SIGKILL due, if any. */
+    void armKillTimer();
+
+    static const uint64_t KILLED = static_cast<uint64_t>(-1);
+
+    /** Watched pid -> when it gets SIGKILL: 0 if it is not being stopped, or KILLED. */
+    typedef std::map<pid_t, uint64_t> ChildMap;
+
+    static ChildReaper *instance_; //!< The worker's reaper, NULL outside the event loop.
+
+    EventDispatcher &dispatcher_;
+    int fd_;
+    sigset_t previousMask_; //!< Restored on destruction.
+    ChildMap children_;
+};
+
+} // namespace network
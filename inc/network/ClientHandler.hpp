@@ -6,10 +6,18 @@
 #include "http/RequestParser.hpp"
 #include "http/Response.hpp"
 #include "http/Router.hpp"
-#include <ctime>
+#include "utils/SlabAllocator.hpp"
+
+namespace http {
+class BodyPipe;
+}
 
 namespace network {
 
+class CGIHandler;
+class CgiInputHandler;
+class EventDispatcher;
+
 /**
  * @class ClientHandler
  * @brief Manages the full lifecycle of a single client connection.
@@ -24,12 +32,22 @@ public:
     // Lifecycle & Interface
     // =========================================================================
 public:
-    ClientHandler(int clientFd, int port, std::string const &clientAddr, http::Router const &);
+    ClientHandler(int clientFd, int port, std::string const &clientAddr, http::Router const &,
+                  EventDispatcher &);
     virtual ~ClientHandler();
 
+    /**
+     * Connection churn is the hot allocation path: handlers live in a per-process slab
+     * (one per worker, hence one per dispatcher) and their buffers come from BufferPool.
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+
     // IEventHandler implementation
     virtual void handleEvent(uint32_t events);
     virtual int getFd() const;
+    virtual bool supportsEdgeTriggered() const;
+    virtual void handleTimeout();
 
     // =========================================================================
     // CGI / Buffer Interaction (Called by external helpers)
@@ -57,36 +75,90 @@ public:
      */
     void onCgiHeadersParsed(http::Headers const &);
 
+    /**
+     * @brief Called by the CgiInputHandler when the script's stdin pipe has room again.
+     */
+    void onCgiInputWritable();
+
+    /**
+     * @brief Called by CGIHandler when the script timed out: 504 Gateway Timeout, or the
+     * connection is closed if the response has already started.
+     */
+    void onCgiTimeout();
+
     /**
      * @brief Triggers an error response (e.g., 404, 500).
      */
     void handleError(http::HttpStatus);
 
+    /**
+     * @brief The dispatcher (worker event loop) this connection is registered with.
+     */
+    EventDispatcher &dispatcher() const;
+
     // =========================================================================
     // Internal Helper Structures
     // =========================================================================
 private:
-    // Helper to manage the output buffer logic
+    /**
+     * Helper to manage the output buffer logic.
+     *
+     * The owned bytes (headers, CGI output) are the head of a segment chain that may be
+     * followed by the zero-copy regions of a response body: an in-memory body is
+     * gathered into the same sendmsg() call, a file slice follows with sendfile(), the
+     * first call flagged MSG_MORE so headers and file data share segments. A small
+     * response thus leaves in a single syscall.
+     */
     struct SendBuffer {
         std::vector<char> buffer;
         size_t sent;
 
+        /** Storage comes from, and goes back to, the process-wide BufferPool. */
         explicit SendBuffer(size_t initialCapacity);
+        ~SendBuffer();
         void reset();
         bool isFullySent() const;
 
-        enum SendStatus { SEND_DONE, SEND_AGAIN, SEND_ERROR };
-        SendStatus send(int clientFd);
+        /**
+         * SEND_AGAIN means the socket is full (EPOLLOUT will report it writable again);
+         * SEND_PARTIAL means a capped sendfile() slice went out and the socket may still
+         * be writable, which an edge-triggered handler must not wait for.
+         */
+        enum SendStatus { SEND_DONE, SEND_AGAIN, SEND_PARTIAL, SEND_ERROR };
+        /**
+         * @brief Flushes the owned bytes, then the zero-copy regions of @p body.
+         * @return SEND_DONE once the buffer and every region of @p body are out; a body
+         * without regions must then be streamed through read().
+         */
+        SendStatus send(int clientFd, http::IResponseBody *body = NULL);
     };
 
     // Helper to group CGI/Event Source state
     struct CgiState {
-        IEventHandler *handler; // The worker handling the CGI script
+        CGIHandler *handler;    // The worker handling the CGI script
+        CgiInputHandler *input; // Its stdin, while it gets the body as it arrives
+        http::BodyPipe *pipe;   // Its body pipe, with input
         bool isDone;
 
         CgiState();
         void clear();
-        void remove();
+        void remove(EventDispatcher &dispatcher);
+        /** Closes the script's stdin, which then reads EOF. */
+        void removeInput(EventDispatcher &dispatcher);
+    };
+
+    /**
+     * What the connection timer currently guards. Header and keep-alive timers run from
+     * the first byte (or the end of the previous response) without being reset; body and
+     * send timers are reset whenever the client makes progress.
+     */
+    enum TimerPhase {
+        NO_TIMER,        //!< Waiting on a CGI script (see CGIHandler), not on the client.
+        HEADER_TIMER,    //!< `client_header_timeout`
+        BODY_TIMER,      //!< `client_body_timeout`
+        KEEPALIVE_TIMER, //!< `keepalive_timeout`
+        SEND_TIMER,      //!< `send_timeout`
+        DRAIN_TIMER      //!< Fixed DRAIN_TIMEOUT_MS before closing.
     };
 
 private:
@@ -98,6 +170,7 @@ private:
 
     // HTTP State
     http::Router const &router_;
+    EventDispatcher &dispatcher_;
     http::Request request_;
     http::Response response_;
     http::RequestParser reqParser_;
@@ -105,16 +178,39 @@ private:
     // Response State
     bool isKeepAlive_;
     bool isDraining_;
-    std::time_t drainStartTime_;
+    bool isClosed_;
+    bool isInputDeferred_;   //!< Edge-triggered: stopped reading before EAGAIN.
+    bool isDispatching_;     //!< Within dispatchRequest(): finalizeConnection() waits for it.
+    bool isFinalizePending_; //!< A response completed during dispatchRequest().
+    TimerPhase timerPhase_;
+    config::Timeouts const &timeouts_;
     SendBuffer rspBuffer_;
     CgiState cgiState_;
+    /// Adopted from the request body when the script reads it as it arrives: the parser
+    /// clears the request on an error, the pipe must stay until the script is removed.
+    http::BodyPipe *bodyPipe_;
+    int splicePipe_[2];  //!< Moves request bodies from the socket to their file.
+    bool spliceFailed_; //!< splice() is not supported here: read bodies with recv().
 
     static const size_t IO_BUFFER_SIZE = 8192;
+    static const size_t SENDFILE_CHUNK_SIZE = 1024 * 1024;
+    static const size_t SPLICE_CHUNK_SIZE = 64 * 1024; //!< The default pipe capacity.
+    static const size_t READ_BUDGET = 32 * IO_BUFFER_SIZE; //!< Per event, edge-triggered.
+    static const uint64_t DRAIN_TIMEOUT_MS = 5000;
 
 private:
     /// @brief Handles incoming data on the socket.
     void handleRead();
     void handleDraining();
+    /// @brief Creates splicePipe_ on first use; false if bodies cannot be spliced.
+    bool openSplicePipe();
+    /// @brief Moves the @p size bytes spliced into splicePipe_ on to @p fileFd.
+    bool flushSplicePipe(int fileFd, size_t size);
+    void closeSplicePipe();
+    /// @brief Whether the parser accepts more input right now.
+    bool wantsInput() const;
+    /// @brief Flushes the body pipe, then waits on the script or resumes reading the socket.
+    void updateCgiInput();
     /// @brief Handles outgoing data on the socket.
     void handleStaticResponseWrite();
     void handleCgiResponseWrite();
@@ -122,7 +218,17 @@ private:
     // Logic Steps
     /// @brief Processes a fully parsed request to generate a response.
     void generateResponse();
+    /**
+     * @brief Handles a parser result; the entry point of request processing.
+     *
+     * A response written at once completes within this call. The connection is
+     * finalized once it returns, and the pipelined requests after it are taken in
+     * turn, instead of through nested calls.
+     */
+    void dispatchRequest(http::RequestParser::State state);
     void handleRequestParsingState(http::RequestParser::State state);
+    /// @brief Sets isKeepAlive_ from the request's Connection header and version.
+    void updateKeepAlive();
     bool setupCgiHandler(http::IResponseBody *body);
     void setupStaticResponse();
 
@@ -133,11 +239,15 @@ private:
     void closeConnection();
     void initiateDraining();
     void finalizeConnection();
+    /// @brief Replaces the connection timer with the one for @p phase.
+    void armTimer(TimerPhase phase);
 
     ClientHandler(const ClientHandler &);
     ClientHandler &operator=(const ClientHandler &);
 
     std::string getLogSignature() const;
+
+    static utils::SlabAllocator &slab();
 };
 
 } // namespace network
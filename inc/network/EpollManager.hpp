@@ -21,8 +21,11 @@ public:
     EpollManager();
     ~EpollManager();
 
-    void addHandler(IEventHandler *handler, uint32_t events);
-    void modifyHandler(IEventHandler *handler, uint32_t events);
+    /**
+     * @param token Reported back in epoll_event::data.u64 (see EventDispatcher).
+     */
+    void addHandler(IEventHandler *handler, uint32_t events, uint64_t token);
+    void modifyHandler(IEventHandler *handler, uint32_t events, uint64_t token);
     void removeHandler(IEventHandler const *handler);
 
     int waitForEvents(struct epoll_event *events, int maxEvents, int timeout = -1);
@@ -2,8 +2,8 @@
 
 #include "EpollManager.hpp"
 #include "IEventHandler.hpp"
-#include <map>
-#include <set>
+#include "TimerWheel.hpp"
+#include <vector>
 
 namespace network {
 
@@ -15,17 +15,38 @@ namespace network {
  * to occur on monitored file descriptors, and dispatches events to appropriate handlers.
  * This implements the core of the ClientHandler pattern for non-blocking, event-driven I/O.
  *
+ * Each worker owns exactly one dispatcher (and therefore one epoll instance); handlers
+ * keep a reference to the dispatcher that registered them instead of reaching for a
+ * process-wide singleton.
+ *
+ * In edge-triggered mode, handlers that supportsEdgeTriggered() are registered with
+ * EPOLLET: they must consume their fd until EAGAIN, or call rearm() when they stop
+ * early (e.g. after exhausting a per-event byte budget).
+ *
+ * The dispatcher also owns the worker's TimerWheel: epoll_wait() sleeps until the next
+ * timer is due, and expired timers are reported through IEventHandler::handleTimeout().
+ *
+ * Handlers are kept in a table indexed by fd. Each slot carries a generation counter
+ * that is bumped whenever its handler is removed, and epoll reports (fd, generation)
+ * instead of a pointer: an event still queued for a removed handler no longer matches
+ * its slot and is dropped, even if the fd number was reused in the meantime. Removed
+ * handlers are deleted after the current batch of events, through an intrusive list.
+ * Dispatching an event is therefore O(1) and allocation-free.
  */
 class EventDispatcher {
 public:
+    explicit EventDispatcher(bool edgeTriggered = false);
     ~EventDispatcher();
 
+    /**
+     * @brief Starts watching the handler's fd for input; the dispatcher then owns it.
+     * @throws std::runtime_error if epoll rejects the fd: the handler is left unregistered.
+     */
     void registerHandler(IEventHandler *handler);
     void removeHandler(IEventHandler *handler);
     void handleEvents();
     void requestShutdown();
-
-    static EventDispatcher &getInstance();
+    bool isEdgeTriggered() const;
 
 public:
     /**
@@ -50,18 +71,46 @@ public:
      */
     void disableWrite(IEventHandler *handler);
 
+    /**
+     * @brief Re-queues an edge-triggered handler whose fd may still be ready.
+     * @note No-op for level-triggered handlers, which are reported again anyway.
+     */
+    void rearm(IEventHandler *handler);
+
+    /**
+     * @brief Arms (or re-arms) the handler's timeout, replacing any previous one.
+     * @param handler The handler to notify through handleTimeout().
+     * @param delayMs Milliseconds from now.
+     */
+    void setTimeout(IEventHandler *handler, uint64_t delayMs);
+
+    /** @brief Disarms the handler's timeout, if any. */
+    void cancelTimeout(IEventHandler *handler);
+
 private:
     void updateEventMask(IEventHandler *handler, uint32_t newMask);
+    uint32_t epollMask(IEventHandler const *handler, uint32_t events) const;
     void cleanUpGarbage();
+    IEventHandler *lookup(uint64_t token) const;
+    int nextTimeout();
+    void expireTimers();
 
 private:
     EpollManager epollManager_;
-    std::map<int, IEventHandler *> handlers_;
-    std::set<IEventHandler *> pendingRemovals_;
-    std::set<IEventHandler *> activeHandlers_;
+    bool edgeTriggered_;
+    TimerWheel timers_;
+
+    struct Slot {
+        IEventHandler *handler; //!< NULL while the fd has no registered handler.
+        uint32_t generation;
+
+        Slot();
+    };
+    std::vector<Slot> slots_;        //!< Indexed by fd.
+    IEventHandler *pendingRemovals_; //!< Head of the intrusive pending-removal list.
+    bool isTearingDown_;             //!< Set by the destructor: removals are ignored.
 
 private:
-    EventDispatcher();
     EventDispatcher(const EventDispatcher &);
     EventDispatcher &operator=(const EventDispatcher &);
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "IEventHandler.hpp"
+#include "http/OpenFileCache.hpp"
+
+namespace network {
+
+/**
+ * @brief Feeds the OpenFileCache's inotify events through the event loop.
+ *
+ * The descriptor belongs to the cache; the watcher only forwards readiness so that
+ * stale entries are invalidated as soon as the file changes on disk.
+ */
+class FileCacheWatcher : public IEventHandler {
+public:
+    explicit FileCacheWatcher(http::OpenFileCache &cache);
+
+    void handleEvent(uint32_t events);
+    int getFd() const;
+
+private:
+    http::OpenFileCache &cache_;
+    int fd_;
+};
+
+} // namespace network
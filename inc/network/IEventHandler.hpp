@@ -1,5 +1,6 @@
 #pragma once
 
+#include "network/TimerWheel.hpp"
 #include <stdint.h>
 
 namespace network {
@@ -22,6 +23,19 @@ public:
     virtual void handleEvent(uint32_t events) = 0;
     virtual int getFd() const = 0;
 
+    /**
+     * @brief Whether the handler drains its fd until EAGAIN on every event.
+     *
+     * Only such handlers are registered with EPOLLET when the dispatcher runs in
+     * edge-triggered mode; the others (default) stay level-triggered.
+     */
+    virtual bool supportsEdgeTriggered() const;
+
+    /**
+     * @brief Called when the timeout armed with EventDispatcher::setTimeout() expires.
+     */
+    virtual void handleTimeout();
+
 protected:
     IEventHandler();
 
@@ -37,6 +51,15 @@ private:
      * Prevents redundant syscalls.
      */
     uint32_t registeredEvents_;
+
+    /** @brief The handler's node in the dispatcher's timer wheel (one timeout at a time). */
+    TimerWheel::Timer timer_;
+
+    /** @brief epoll user data: fd and the generation of its dispatcher slot. */
+    uint64_t token_;
+    bool isActive_;              //!< Registered and not removed yet.
+    bool isPendingRemoval_;      //!< Linked in the dispatcher's pending-removal list.
+    IEventHandler *nextRemoval_; //!< Next handler in that list.
 };
 
 } // namespace network
@@ -9,9 +9,11 @@ namespace network {
 class Socket {
 public:
     Socket();
-    explicit Socket(int port);
-    Socket(std::string const &address, int port);
-    explicit Socket(config::ServerBlock const &);
+    explicit Socket(int port, bool reusePort = false,
+                    config::ListenOptions const &options = config::ListenOptions());
+    Socket(std::string const &address, int port, bool reusePort = false,
+           config::ListenOptions const &options = config::ListenOptions());
+    explicit Socket(config::ServerBlock const &, bool reusePort = false);
     ~Socket();
 
     int getFd(void) const;
@@ -23,7 +25,15 @@ private:
     sockaddr_in addr_;
     int fd_;
 
-    void createAndBind(std::string const &ipAddress, int port);
+    /**
+     * @brief Creates the listening socket and binds it to ipAddress:port.
+     * @param reusePort If true, SO_REUSEPORT is set so several workers can bind
+     * the same address and let the kernel balance incoming connections.
+     * @param options `deferred` and `fastopen` are applied here; they are best effort
+     * and only logged if the kernel refuses them.
+     */
+    void createAndBind(std::string const &ipAddress, int port, bool reusePort,
+                       config::ListenOptions const &options);
     Socket(Socket const &rhs);
     Socket const &operator=(Socket const &rhs);
 };
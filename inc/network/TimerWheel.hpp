@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace network {
+
+class IEventHandler;
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel with O(1) schedule and cancel.
+ *
+ * Four levels of 64 slots, level 0 ticking every TICK_MS. A timer is linked into
+ * the slot matching its expiry at the coarsest level that still separates it from
+ * "now"; whenever level 0 wraps, the due slot of the next level is cascaded down.
+ * The wheel covers about 19 days (longer delays are clamped).
+ *
+ * Timers are intrusive nodes owned by their handlers, so scheduling never allocates.
+ * The wheel does not call anything itself: advance() moves due timers to an expired
+ * list the owner drains with popExpired(), which keeps callbacks free to (re)schedule
+ * or cancel any timer.
+ */
+class TimerWheel {
+public:
+    static const uint64_t TICK_MS = 100;
+
+    struct Timer {
+        Timer *prev;
+        Timer *next;
+        uint64_t expires; //!< Absolute tick.
+        IEventHandler *handler;
+
+        Timer();
+        bool isPending() const;
+    };
+
+    explicit TimerWheel(uint64_t nowMs);
+
+    /** @brief (Re)schedules @p timer to expire @p delayMs after @p nowMs. */
+    void schedule(Timer &timer, uint64_t nowMs, uint64_t delayMs);
+    void cancel(Timer &timer);
+
+    /** @brief Moves every timer due at @p nowMs to the expired list. */
+    void advance(uint64_t nowMs);
+
+    /** @brief Unlinks and returns the next expired timer, or NULL. */
+    Timer *popExpired();
+
+    /**
+     * @brief Milliseconds until the wheel needs to advance again.
+     * @return -1 if no timer is pending.
+     */
+    int nextTimeout(uint64_t nowMs) const;
+
+    size_t size() const;
+
+    /** @brief Current CLOCK_MONOTONIC time in milliseconds. */
+    static uint64_t now();
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const uint64_t SLOTS = 1 << SLOT_BITS;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    void link(Timer &timer);
+    static void unlink(Timer &timer);
+    static void pushBack(Timer &head, Timer &timer);
+    static bool isEmpty(Timer const &head);
+    /** @brief Number of ticks covered by one full turn of @p level levels. */
+    static uint64_t levelSpan(int level);
+
+    uint64_t current_; //!< Last processed tick.
+    size_t count_;
+    Timer slots_[LEVELS][SLOTS]; //!< List heads (circular, doubly linked).
+    Timer expired_;
+
+    TimerWheel(TimerWheel const &);
+    TimerWheel &operator=(TimerWheel const &);
+};
+
+} // namespace network
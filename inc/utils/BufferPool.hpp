@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @class BufferPool
+ * @brief Recycles the heap storage of growable buffers (std::string, std::vector<char>).
+ *
+ * A connection acquire()s its buffers when it starts and release()s them when it
+ * ends; storage changes hands by swap(), so a recycled buffer keeps its capacity and
+ * the next connection starts without any allocation. Buffers that grew past
+ * maxCapacity (a large CGI response, a huge header block) are freed instead of
+ * pooled, and at most maxPooled buffers are kept.
+ *
+ * One pool per buffer type and process, created on first use.
+ */
+template <typename Buffer> class BufferPool {
+public:
+    static BufferPool &getInstance() {
+        static BufferPool instance;
+        return instance;
+    }
+
+    /**
+     * @brief Hands a recycled buffer's storage to @p buffer (emptied), or reserves
+     * @p initialCapacity if the pool is empty.
+     */
+    void acquire(Buffer &buffer, size_t initialCapacity) {
+        buffer.clear();
+        if (pool_.empty()) {
+            buffer.reserve(initialCapacity);
+            return;
+        }
+        buffer.swap(pool_.back());
+        pool_.pop_back();
+    }
+
+    /** @brief Takes back @p buffer's storage, leaving @p buffer empty. */
+    void release(Buffer &buffer) {
+        if (buffer.capacity() == 0 || buffer.capacity() > maxCapacity_ ||
+            pool_.size() >= maxPooled_) {
+            Buffer().swap(buffer);
+            return;
+        }
+        buffer.clear();
+        pool_.push_back(Buffer());
+        pool_.back().swap(buffer);
+    }
+
+    size_t size() const { return pool_.size(); }
+
+    /** @brief Frees every pooled buffer. */
+    void clear() { std::vector<Buffer>().swap(pool_); }
+
+private:
+    BufferPool() : maxCapacity_(64 * 1024), maxPooled_(256) { pool_.reserve(maxPooled_); }
+
+    size_t maxCapacity_;
+    size_t maxPooled_;
+    std::vector<Buffer> pool_;
+
+    BufferPool(BufferPool const &);
+    BufferPool &operator=(BufferPool const &);
+};
+
+} // namespace utils
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @class InputBuffer
+ * @brief Receive buffer that the socket is read into directly.
+ *
+ * Bytes are addressed by their offset from data(): readers keep their own cursors and
+ * tell the buffer which bytes they are done with. Dropping the bytes at the end is free,
+ * so a reader that keeps up with its input never moves a byte; the buffer grows by
+ * doubling only when the bytes still needed fill it.
+ *
+ * Unlike a ring buffer, the stored bytes are always contiguous: a request head can be
+ * scanned in place and kept as spans of the buffer. The storage comes from, and goes
+ * back to, BufferPool.
+ */
+class InputBuffer {
+public:
+    explicit InputBuffer(size_t initialCapacity);
+    ~InputBuffer();
+
+    char const *data() const;
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+
+    /**
+     * @brief Writable space after the last byte, growing the buffer if fewer than
+     * @p minSize bytes are free.
+     * @param space Set to the number of bytes that may be written.
+     */
+    char *prepare(size_t minSize, size_t &space);
+
+    /** @brief Appends @p size bytes written to the space returned by prepare(). */
+    void commit(size_t size);
+
+    void append(char const *bytes, size_t size);
+
+    /** @brief Drops every byte from @p offset on. */
+    void truncate(size_t offset);
+
+    /** @brief Drops @p length bytes at @p offset; the bytes after them move down. */
+    void erase(size_t offset, size_t length);
+
+    void clear();
+
+private:
+    std::vector<char> storage_; //!< Sized to its capacity; size_ bytes are in use.
+    size_t size_;
+
+    InputBuffer(InputBuffer const &);
+    InputBuffer &operator=(InputBuffer const &);
+};
+
+} // namespace utils
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @class SlabAllocator
+ * @brief Fixed-size block allocator backed by a free-list.
+ *
+ * Blocks are carved out of slabs of blocksPerSlab blocks, so a burst of allocations
+ * costs one malloc() per slab instead of one per object. Freed blocks go back to
+ * the free-list and are reused LIFO, which keeps recently touched memory hot.
+ * Slabs are only returned to the system when the allocator is destroyed, so memory
+ * use follows the peak number of live blocks.
+ *
+ * Not thread-safe: each worker process owns its own instances.
+ */
+class SlabAllocator {
+public:
+    explicit SlabAllocator(size_t blockSize, size_t blocksPerSlab = 64);
+    ~SlabAllocator();
+
+    /** @brief Returns an uninitialised block of blockSize() bytes. Throws std::bad_alloc. */
+    void *allocate();
+    /** @brief Returns a block obtained from allocate() to the free-list. */
+    void deallocate(void *block);
+
+    size_t blockSize() const;
+    size_t inUse() const;    //!< Blocks handed out and not yet returned.
+    size_t capacity() const; //!< Blocks owned, in use or free.
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    void grow();
+
+    size_t blockSize_;
+    size_t blocksPerSlab_;
+    FreeBlock *free_;
+    std::vector<void *> slabs_;
+    size_t inUse_;
+
+    SlabAllocator(SlabAllocator const &);
+    SlabAllocator &operator=(SlabAllocator const &);
+};
+
+} // namespace utils
@@ -0,0 +1,46 @@
+BENCH_NAME		=	loadgen
+BENCH_DIR		=	bench
+BENCH_SRCS		:=	$(BENCH_DIR)/loadgen.cpp
+BENCH_CXXFLAGS	=	-std=c++98 -Wall -Wextra -Werror -O2
+
+HBENCH_NAME		=	headers_bench
+HBENCH_SRCS		:=	$(BENCH_DIR)/headers.cpp $(addprefix $(SDIR)/, http/Headers.cpp \
+					http/HeaderNames.cpp http/internal/ByteScan.cpp common/string.cpp \
+					utils/InputBuffer.cpp)
+LBENCH_NAME		=	locations_bench
+LBENCH_SRCS		:=	$(BENCH_DIR)/locations.cpp $(filter-out $(SDIR)/main.cpp, $(SRCS))
+SBENCH_NAME		=	spawn_bench
+SBENCH_SRCS		:=	$(BENCH_DIR)/spawn.cpp
+
+BENCH_CONF		?=	config/test.conf
+BENCH_OUT		?=	bench_output.txt
+
+bench: | $(LOGDIR)
+	@$(FMAKE) $(NAME) $(BENCH_NAME) > /dev/null
+	@./$(BENCH_DIR)/run.sh ./$(NAME) ./$(BENCH_NAME) $(BENCH_CONF) $(BENCH_OUT)
+
+$(BENCH_NAME): $(BENCH_SRCS)
+	@$(CXX) $(BENCH_CXXFLAGS) -o $@ $^
+
+bench_headers: $(HBENCH_NAME)
+	@./$(HBENCH_NAME)
+
+$(HBENCH_NAME): $(HBENCH_SRCS)
+	@$(CXX) $(BENCH_CXXFLAGS) -I$(HDIR) -DLOGLEVEL=INFO -o $@ $^
+
+bench_locations: $(LBENCH_NAME)
+	@./$(LBENCH_NAME)
+
+$(LBENCH_NAME): $(LBENCH_SRCS)
+	@$(CXX) $(BENCH_CXXFLAGS) -I$(HDIR) -DLOGLEVEL=INFO -o $@ $^
+
+bench_spawn: $(SBENCH_NAME)
+	@./$(SBENCH_NAME)
+
+$(SBENCH_NAME): $(SBENCH_SRCS)
+	@$(CXX) $(BENCH_CXXFLAGS) -o $@ $^
+
+bench_clean:
+	@rm -rf $(BENCH_NAME) $(HBENCH_NAME) $(LBENCH_NAME) $(SBENCH_NAME)
+
+.PHONY: bench bench_headers bench_locations bench_spawn bench_clean
@@ -32,7 +32,11 @@ help:
 	@echo "$(YELLOW)🚀 Run & Test Targets:$(RESET)"
 	@echo "  $(GREEN)run, r$(RESET)       Build and run the program."
 	@echo "  $(GREEN)rerun, rr$(RESET)    Rebuild and run the program."
-	@echo "  $(GREEN)valgrind, v$(RESET)  Run with Valgrind memory checker.\n"
+	@echo "  $(GREEN)valgrind, v$(RESET)  Run with Valgrind memory checker."
+	@echo "  $(GREEN)bench$(RESET)        Run the load generator against config/test.conf."
+	@echo "  $(GREEN)bench_headers$(RESET) Compare the header store with the previous std::map one."
+	@echo "  $(GREEN)bench_locations$(RESET) Time location matching against 10 to 10000 locations."
+	@echo "  $(GREEN)bench_spawn$(RESET)  Compare fork+exec with posix_spawn as the heap grows.\n"
 	@echo "$(YELLOW)🔧 Development Tools:$(RESET)"
 	@echo "  $(GREEN)check$(RESET)        Run static analysis with cppcheck."
 	@echo "  $(GREEN)cdb, compiledb$(RESET)    Generate compile_commands.json for your editor."
@@ -41,5 +45,6 @@ help:
 	@echo "$(YELLOW)⚙️  Run Options:$(RESET)"
 	@echo "  $(GREEN)ARGS=$(RESET)        Pass arguments to the executable."
 	@echo "               e.g., make run ARGS=\"config/default.conf\""
+	@echo "  $(GREEN)BENCH_OUT=$(RESET)   File receiving the JSON bench results (bench_output.txt)."
 
 .PHONY: help first-run-help
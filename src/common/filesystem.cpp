@@ -4,15 +4,15 @@
 #include <cerrno>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <stdlib.h>
 #include <string>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-#define READ_BUFFER_SIZE 16384
-
 namespace utils {
 
 namespace {
@@ -25,6 +25,20 @@ bool compareFileEntries(const FileEntry &a, const FileEntry &b) {
 }
 } // namespace
 
+bool writeAll(int fd, char const *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
 bool writeFile(const std::string &content, const char *path) {
     std::ofstream out(path, std::ios::binary);
 
@@ -94,17 +108,20 @@ std::string getFileExtension(const std::string &fpath) {
 TempFile::TempFile() : fd_(-1) {}
 TempFile::~TempFile() { close(); }
 
-bool TempFile::open() {
+bool TempFile::open(std::string const &directory) {
     if (fd_ != -1)
         close();
-    char templateFileName[] = "/tmp/.webserv-file-body-XXXXXX";
-    fd_ = mkstemp(templateFileName);
+    std::vector<char> templateFileName;
+    std::string pattern = joinPaths(directory, ".webserv-file-body-XXXXXX");
+    templateFileName.assign(pattern.begin(), pattern.end());
+    templateFileName.push_back('\0');
+    fd_ = mkstemp(&templateFileName[0]);
     if (fd_ < 1) {
-        std::cerr << "Error: couldn't create a file for a request body: " << strerror(errno)
-                  << std::endl;
+        std::cerr << "Error: couldn't create a file for a request body in " << directory << ": "
+                  << strerror(errno) << std::endl;
         return false;
     }
-    filePath_ = templateFileName;
+    filePath_ = &templateFileName[0];
     return true;
 }
 
@@ -143,47 +160,37 @@ TempFile::MoveStatus TempFile::moveTo(const std::string &destPath) {
 
     LOG_SDEBUG("Atomic rename failed (" << strerror(errno) << "), falling back to copy.");
 
-    std::ifstream src(filePath_.c_str(), std::ios::binary);
-    std::ofstream dest(destPath.c_str(), std::ios::binary | std::ios::trunc);
-
-    if (!src.is_open()) {
-        LOG_SERROR("Failed to open source for copying: " << filePath_);
+    // Across file systems: copy inside the kernel, from the start of our descriptor
+    struct stat st;
+    if (fstat(fd_, &st) == -1) {
+        LOG_SERROR("Failed to stat source for copying: " << filePath_);
         return MOVE_SYS_ERR;
     }
-    if (!dest.is_open()) {
+    int dest = ::open(destPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (dest == -1) {
         LOG_SERROR("Failed to open destination for copying: " << destPath << " (" << strerror(errno)
                                                               << ")");
         return MOVE_IO_ERR;
     }
-
-    char buf[READ_BUFFER_SIZE];
-    while (src.good()) {
-        src.read(buf, READ_BUFFER_SIZE);
-        std::streamsize bytesRead = src.gcount();
-        if (bytesRead > 0) {
-            dest.write(buf, bytesRead);
-            if (!dest.good()) {
-                LOG_SERROR("Write error to destination: " << destPath);
-                ::unlink(destPath.c_str());
-                return MOVE_IO_ERR;
-            }
+    off_t offset = 0;
+    while (offset < st.st_size) {
+        ssize_t copied = sendfile(dest, fd_, &offset, st.st_size - offset);
+        if (copied <= 0) {
+            if (copied < 0 && errno == EINTR)
+                continue;
+            LOG_SERROR("Copy to " << destPath << " failed: "
+                                  << (copied < 0 ? strerror(errno) : "source truncated"));
+            ::close(dest);
+            ::unlink(destPath.c_str());
+            return MOVE_IO_ERR;
         }
     }
-
-    if (!src.eof()) {
-        LOG_SERROR("Read error from source: " << filePath_);
+    if (::close(dest) == -1) {
+        LOG_SERROR("Final write failed for: " << destPath);
         ::unlink(destPath.c_str());
         return MOVE_IO_ERR;
     }
 
-    src.close();
-    dest.close();
-
-    if (!dest.good()) {
-        LOG_SERROR("Final stream check failed for: " << destPath);
-        return MOVE_IO_ERR;
-    }
-
     // After successfull copy, delete source and invalidate self
     ::unlink(filePath_.c_str());
     if (fd_ >= 0)
@@ -1,4 +1,5 @@
 #include "config/LocationBlock.hpp"
+#include "common/string.hpp"
 #include "config/Block.hpp"
 #include "config/ServerBlock.hpp"
 #include "utils/IndentManager.hpp"
@@ -34,6 +35,24 @@ LocationBlock &LocationBlock::extension(std::string const &v) {
 
 bool LocationBlock::hasCgiPass() const { return has("cgi_pass"); }
 
+bool LocationBlock::hasFastCgiPass() const { return has("fastcgi_pass"); }
+
+bool LocationBlock::cgiRequestBuffering() const {
+    return !has("cgi_request_buffering") || getFirstRawValue("cgi_request_buffering") == "on";
+}
+
+void LocationBlock::cgiLimits(size_t &cpu, size_t &addressSpace, size_t &openFiles) const {
+    cpu = 0;
+    addressSpace = 0;
+    openFiles = 0;
+    if (!has("cgi_limits"))
+        return;
+    std::vector<std::string> values = getRawValues("cgi_limits");
+    cpu = utils::fromString<size_t>(values[0]);
+    addressSpace = utils::fromString<size_t>(values[1]);
+    openFiles = utils::fromString<size_t>(values[2]);
+}
+
 LocationBlock &LocationBlock::parent(ServerBlock *parent) {
     parent_ = parent;
     return *this;
@@ -0,0 +1,220 @@
+#include "config/LocationIndex.hpp"
+#include "config/LocationBlock.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace config {
+
+namespace {
+
+const size_t HASH_SEED = 5381;
+
+/** Hashes one more byte of a suffix read backwards, from its last byte. */
+inline size_t hashBefore(size_t hash, char c) {
+    return hash * 31 + static_cast<unsigned char>(c);
+}
+
+size_t suffixHash(std::string const &suffix) {
+    size_t hash = HASH_SEED;
+    for (size_t i = suffix.size(); i-- > 0;)
+        hash = hashBefore(hash, suffix[i]);
+    return hash;
+}
+
+} // namespace
+
+LocationIndex::Node::Node() : location(NULL) {}
+
+LocationIndex::Extension::Extension() : hash(0), location(NULL), order(0) {}
+
+LocationIndex::LocationIndex() : root_(NULL), extensionCount_(0) { clear(); }
+
+void LocationIndex::clear() {
+    nodes_.assign(1, Node());
+    root_ = NULL;
+    extensions_.assign(8, Extension());
+    extensionCount_ = 0;
+    suffixLengths_.clear();
+}
+
+void LocationIndex::add(LocationBlock const &location) {
+    if (location.matchType() == LocationBlock::EXTENSION)
+        addExtension(location.extension(), &location);
+    else
+        addPrefix(location.path(), &location);
+}
+
+// =============================================================================
+// Prefix locations
+// =============================================================================
+
+size_t LocationIndex::childOf(size_t node, char c) const {
+    std::string const &keys = nodes_[node].keys;
+    size_t i = std::lower_bound(keys.begin(), keys.end(), c) - keys.begin();
+    if (i < keys.size() && keys[i] == c)
+        return nodes_[node].children[i];
+    return NONE;
+}
+
+void LocationIndex::link(size_t parent, size_t child) {
+    char c = nodes_[child].label[0];
+    Node &p = nodes_[parent];
+    size_t i = std::lower_bound(p.keys.begin(), p.keys.end(), c) - p.keys.begin();
+    p.keys.insert(p.keys.begin() + i, c);
+    p.children.insert(p.children.begin() + i, child);
+}
+
+void LocationIndex::addPrefix(std::string const &path, LocationBlock const *location) {
+    if (path == "/" && !root_)
+        root_ = location;
+    size_t node = 0;
+    size_t depth = 0;
+    while (depth < path.size()) {
+        size_t child = childOf(node, path[depth]);
+        if (child == NONE) {
+            Node leaf;
+            leaf.label = path.substr(depth);
+            leaf.location = location;
+            nodes_.push_back(leaf);
+            link(node, nodes_.size() - 1);
+            return;
+        }
+        std::string const &label = nodes_[child].label;
+        size_t common = 1;
+        while (common < label.size() && depth + common < path.size() &&
+               label[common] == path[depth + common])
+            ++common;
+        if (common < label.size()) {
+            // Split the edge: node -> middle (label[0, common)) -> child (the rest)
+            Node middle;
+            middle.label = label.substr(0, common);
+            nodes_[child].label.erase(0, common);
+            nodes_.push_back(middle);
+            size_t middleIndex = nodes_.size() - 1;
+            Node &parent = nodes_[node];
+            *std::find(parent.children.begin(), parent.children.end(), child) = middleIndex;
+            link(middleIndex, child);
+            child = middleIndex;
+        }
+        node = child;
+        depth += common;
+    }
+    if (!nodes_[node].location)
+        nodes_[node].location = location;
+}
+
+LocationBlock const *LocationIndex::matchPrefix(std::string const &path) const {
+    char const *p = path.data();
+    size_t n = path.size();
+    LocationBlock const *longest = NULL; // Longest match ending in '/'
+    size_t node = 0;
+    size_t depth = 0;
+    for (;;) {
+        Node const &current = nodes_[node];
+        if (current.location && depth > 0 && p[depth - 1] == '/')
+            longest = current.location;
+        if (depth == n) {
+            if (current.location)
+                return current.location;
+            size_t slash = childOf(node, '/');
+            if (n > 0 && p[n - 1] != '/' && slash != NONE && nodes_[slash].label.size() == 1 &&
+                nodes_[slash].location)
+                return nodes_[slash].location;
+            break;
+        }
+        size_t child = childOf(node, p[depth]);
+        if (child == NONE)
+            break;
+        std::string const &label = nodes_[child].label;
+        size_t length = std::min(label.size(), n - depth);
+        if (std::memcmp(label.data(), p + depth, length) != 0)
+            break;
+        if (length < label.size()) {
+            // The path ends inside the edge: only "path/" can still match
+            if (length + 1 == label.size() && label[length] == '/' && p[n - 1] != '/' &&
+                nodes_[child].location)
+                return nodes_[child].location;
+            break;
+        }
+        depth += length;
+        node = child;
+    }
+    return longest ? longest : root_;
+}
+
+// =============================================================================
+// Extension locations
+// =============================================================================
+
+void LocationIndex::addExtension(std::string const &suffix, LocationBlock const *location) {
+    size_t hash = suffixHash(suffix);
+    size_t order;
+    if (findExtension(hash, suffix.data(), suffix.size(), order))
+        return; // An earlier location has the same extension
+    if ((extensionCount_ + 1) * 2 > extensions_.size())
+        growExtensions();
+    size_t mask = extensions_.size() - 1;
+    size_t i = hash & mask;
+    while (extensions_[i].location)
+        i = (i + 1) & mask;
+    extensions_[i].hash = hash;
+    extensions_[i].suffix = suffix;
+    extensions_[i].location = location;
+    extensions_[i].order = extensionCount_++;
+    if (suffixLengths_.size() <= suffix.size())
+        suffixLengths_.resize(suffix.size() + 1, false);
+    suffixLengths_[suffix.size()] = true;
+}
+
+void LocationIndex::growExtensions() {
+    std::vector<Extension> old(extensions_.size() * 2, Extension());
+    old.swap(extensions_);
+    size_t mask = extensions_.size() - 1;
+    for (size_t j = 0; j < old.size(); ++j) {
+        if (!old[j].location)
+            continue;
+        size_t i = old[j].hash & mask;
+        while (extensions_[i].location)
+            i = (i + 1) & mask;
+        extensions_[i] = old[j];
+    }
+}
+
+LocationBlock const *LocationIndex::findExtension(size_t hash, char const *suffix,
+                                                  size_t length, size_t &order) const {
+    size_t mask = extensions_.size() - 1;
+    for (size_t i = hash & mask; extensions_[i].location; i = (i + 1) & mask) {
+        Extension const &e = extensions_[i];
+        if (e.hash == hash && e.suffix.size() == length &&
+            std::memcmp(e.suffix.data(), suffix, length) == 0) {
+            order = e.order;
+            return e.location;
+        }
+    }
+    return NULL;
+}
+
+LocationBlock const *LocationIndex::matchExtension(std::string const &uri) const {
+    if (extensionCount_ == 0)
+        return NULL;
+    LocationBlock const *best = NULL;
+    size_t bestOrder = NONE;
+    size_t maxLength = std::min(suffixLengths_.size() - 1, uri.size());
+    size_t hash = HASH_SEED;
+    for (size_t length = 0;; ++length) {
+        size_t order;
+        LocationBlock const *found = NULL;
+        if (suffixLengths_[length])
+            found = findExtension(hash, uri.data() + uri.size() - length, length, order);
+        if (found && order < bestOrder) {
+            best = found;
+            bestOrder = order;
+        }
+        if (length == maxLength)
+            break;
+        hash = hashBefore(hash, uri[uri.size() - length - 1]);
+    }
+    return best;
+}
+
+} // namespace config
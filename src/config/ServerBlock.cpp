@@ -2,24 +2,63 @@
 #include "config/Block.hpp"
 #include "http/Request.hpp"
 #include "utils/IndentManager.hpp"
+#include "utils/Logger.hpp"
+#include <algorithm>
 #include <utility>
 
 namespace config {
 
+ListenOptions::ListenOptions() : backlog(511), deferred(false), fastOpen(0) {}
+
+void ListenOptions::merge(ListenOptions const &other) {
+    backlog = std::max(backlog, other.backlog);
+    deferred = deferred || other.deferred;
+    fastOpen = std::max(fastOpen, other.fastOpen);
+}
+
 ServerBlock::ServerBlock() : Block("server"), port_(-1) {}
 
-LocationBlock const *ServerBlock::matchLocation(http::Request const &req) const {
-    LocationBlock const *bestPrefix = details::bestMatchLocation(locations_, req.uri());
+ServerBlock::ServerBlock(ServerBlock const &other)
+    : Block(other), port_(other.port_), address_(other.address_),
+      listenOptions_(other.listenOptions_), locations_(other.locations_),
+      extensionPaths_(other.extensionPaths_) {
+    indexLocations();
+}
+
+ServerBlock &ServerBlock::operator=(ServerBlock const &other) {
+    if (this != &other) {
+        Block::operator=(other);
+        port_ = other.port_;
+        address_ = other.address_;
+        listenOptions_ = other.listenOptions_;
+        locations_ = other.locations_;
+        extensionPaths_ = other.extensionPaths_;
+        indexLocations();
+    }
+    return *this;
+}
 
-    LocationBlock const *extMatch =
-        details::matchExtensionLocation(locations_, extensionPaths_, req.uri());
+void ServerBlock::indexLocations() {
+    locationIndex_.clear();
+    for (LocationBlockMap::iterator it = locations_.begin(); it != locations_.end(); ++it) {
+        it->second.parent(this);
+        if (it->second.matchType() != LocationBlock::EXTENSION)
+            locationIndex_.add(it->second);
+    }
+    for (size_t i = 0; i < extensionPaths_.size(); ++i)
+        locationIndex_.add(locations_.find(extensionPaths_[i])->second);
+}
+
+LocationBlock const *ServerBlock::matchLocation(http::Request const &req) const {
+    LocationBlock const *extMatch = locationIndex_.matchExtension(req.uri());
     if (extMatch) {
+        LOG_TRACE("matchLocation: matched extension " << extMatch->path());
         return extMatch;
     }
-    return bestPrefix;
+    return locationIndex_.matchPrefix(req.uri());
 }
 LocationBlock const *ServerBlock::matchPrefixLocation(http::Request const &req) const {
-    return details::bestMatchLocation(locations_, req.uri());
+    return locationIndex_.matchPrefix(req.uri());
 }
 
 bool ServerBlock::hasLocation(LocationBlock const &b) const {
@@ -34,6 +73,7 @@ void ServerBlock::addLocation(LocationBlock const &b) {
     if (inserted.matchType() == LocationBlock::EXTENSION) {
         extensionPaths_.push_back(inserted.path());
     }
+    locationIndex_.add(inserted);
 }
 
 ServerBlock &ServerBlock::port(int port) {
@@ -50,6 +90,13 @@ ServerBlock &ServerBlock::address(std::string const &address) {
 
 std::string const &ServerBlock::address() const { return address_; }
 
+ServerBlock &ServerBlock::listenOptions(ListenOptions const &options) {
+    listenOptions_ = options;
+    return *this;
+}
+
+ListenOptions const &ServerBlock::listenOptions() const { return listenOptions_; }
+
 std::ostream &operator<<(std::ostream &o, const ServerBlock &t) {
     o << "--- [ServerBlock] --- \n";
     o << "{\n";
@@ -58,6 +105,7 @@ std::ostream &operator<<(std::ostream &o, const ServerBlock &t) {
 
     o << printIndent << "listen address: '" << t.address() << "'\n";
     o << printIndent << "port: '" << t.port() << "'\n";
+    o << printIndent << "backlog: '" << t.listenOptions().backlog << "'\n";
 
     o << static_cast<Block const &>(t);
 
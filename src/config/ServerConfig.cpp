@@ -1,5 +1,6 @@
 #include "config/ServerConfig.hpp"
 
+#include "common/string.hpp"
 #include "config/ServerBlock.hpp"
 #include "config/pipeline/Lexer.hpp"
 #include "config/pipeline/Mapper.hpp"
@@ -13,12 +14,22 @@
 
 namespace config {
 
-ServerConfig::ServerConfig() {}
-ServerConfig::ServerConfig(std::string const &content, bool perform_fs_checks) {
+namespace {
+void resolveTimeout(Block const &main, std::string const &name, size_t &seconds) {
+    if (main.has(name))
+        seconds = utils::fromString<size_t>(main.getFirstRawValue(name));
+}
+} // namespace
+
+Timeouts::Timeouts()
+    : clientHeader(60), clientBody(60), keepalive(75), send(60), cgi(0), cgiRead(60) {}
+
+ServerConfig::ServerConfig() : main_("main") {}
+ServerConfig::ServerConfig(std::string const &content, bool perform_fs_checks) : main_("main") {
     build(content, perform_fs_checks);
 }
 
-ServerConfig::ServerConfig(char const *fpath, bool perform_fs_checks) {
+ServerConfig::ServerConfig(char const *fpath, bool perform_fs_checks) : main_("main") {
     std::ifstream file(fpath);
     if (!file.is_open()) {
         throw std::runtime_error("Could not open config file.");
@@ -32,6 +43,13 @@ void ServerConfig::build(std::string const &content, bool perform_fs_checks) {
     TokenArray tokens = Lexer::tokenize(content);
     std::vector<ConfigNode> ir = Parser::parse(tokens);
     ServerBlockVec servers = Mapper::map(ir);
+    Mapper::mapMainBlock(main_, ir);
+    resolveTimeout(main_, "client_header_timeout", timeouts_.clientHeader);
+    resolveTimeout(main_, "client_body_timeout", timeouts_.clientBody);
+    resolveTimeout(main_, "keepalive_timeout", timeouts_.keepalive);
+    resolveTimeout(main_, "send_timeout", timeouts_.send);
+    resolveTimeout(main_, "cgi_timeout", timeouts_.cgi);
+    resolveTimeout(main_, "cgi_read_timeout", timeouts_.cgiRead);
     Validator::validate(servers, perform_fs_checks);
     for (size_t i = 0; i < servers.size(); i++) {
         addServer(servers[i]);
@@ -41,32 +59,51 @@ void ServerConfig::build(std::string const &content, bool perform_fs_checks) {
 
 ServerBlockMap const &ServerConfig::getServersMap() const { return servers_; }
 
-ServerBlock const *ServerConfig::getServer(int port, http::Request const &req) const {
-    std::string host = req.headers().get("Host");
-    size_t colon_pos = host.find(':');
-    if (colon_pos != std::string::npos) {
-        host.resize(colon_pos);
-    }
+Block const &ServerConfig::mainBlock() const { return main_; }
+
+size_t ServerConfig::workerProcesses() const {
+    if (!main_.has("worker_processes"))
+        return 1;
+    size_t n = utils::fromString<size_t>(main_.getFirstRawValue("worker_processes"));
+    return n ? n : 1;
+}
+
+void ServerConfig::openFileCache(size_t &maxEntries, size_t &validity) const {
+    maxEntries = 0;
+    validity = 0;
+    if (!main_.has("open_file_cache"))
+        return;
+    std::vector<std::string> values = main_.getRawValues("open_file_cache");
+    maxEntries = utils::fromString<size_t>(values[0]);
+    validity = utils::fromString<size_t>(values[1]);
+}
 
+bool ServerConfig::edgeTriggered() const {
+    return main_.has("edge_triggered") && main_.getFirstRawValue("edge_triggered") == "on";
+}
+
+Timeouts const &ServerConfig::timeouts() const { return timeouts_; }
+
+ServerBlock const *ServerConfig::getServer(int port, http::Request const &req) const {
     ServerBlockMap::const_iterator it = servers_.find(port);
     if (it == servers_.end())
         return NULL;
 
-    ServerBlockVec const &blocks = it->second;
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        if (blocks[i].has("server_name")) {
-            std::vector<std::string> names = blocks[i].getRawValues("server_name");
-            if (details::matchServerName(names, host)) {
-                return &blocks[i];
-            }
-        }
-    }
-
-    return &blocks[0];
+    std::string host;
+    req.headers().get(http::header::HOST, host);
+    size_t index = virtualHosts_.find(port)->second.find(host);
+    return &it->second[index == VirtualHosts::NONE ? 0 : index];
 }
 
 void ServerConfig::addServer(ServerBlock const &server) {
-    servers_[server.port()].push_back(server);
+    ServerBlockVec &blocks = servers_[server.port()];
+    VirtualHosts &hosts = virtualHosts_[server.port()];
+    if (server.has("server_name")) {
+        std::vector<std::string> names = server.getRawValues("server_name");
+        for (size_t i = 0; i < names.size(); ++i)
+            hosts.add(names[i], blocks.size());
+    }
+    blocks.push_back(server);
 }
 
 std::ostream &operator<<(std::ostream &o, const ServerConfig &t) {
@@ -0,0 +1,133 @@
+#include "config/VirtualHosts.hpp"
+
+namespace config {
+
+namespace {
+
+inline unsigned char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : static_cast<unsigned char>(c);
+}
+
+/** FNV-1a over the lowercased bytes. */
+size_t hashName(char const *name, size_t length) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= lower(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool equalsLowercase(char const *a, std::string const &lowercase) {
+    for (size_t i = 0; i < lowercase.size(); ++i) {
+        if (lower(a[i]) != static_cast<unsigned char>(lowercase[i]))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+const size_t VirtualHosts::NONE;
+
+// =============================================================================
+// NameTable
+// =============================================================================
+
+VirtualHosts::NameTable::Entry::Entry() : hash(0), server(NONE) {}
+
+VirtualHosts::NameTable::NameTable() : slots_(8), count_(0) {}
+
+void VirtualHosts::NameTable::add(std::string const &name, size_t server) {
+    if (find(name.data(), name.size()) != NONE)
+        return; // Declared by an earlier server
+    if ((count_ + 1) * 2 > slots_.size()) {
+        std::vector<Entry> old(slots_.size() * 2);
+        old.swap(slots_);
+        count_ = 0;
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].server != NONE)
+                add(old[i].name, old[i].server);
+        }
+    }
+    size_t hash = hashName(name.data(), name.size());
+    size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i].server != NONE)
+        i = (i + 1) & mask;
+    slots_[i].hash = hash;
+    slots_[i].name = name;
+    slots_[i].server = server;
+    ++count_;
+}
+
+size_t VirtualHosts::NameTable::find(char const *name, size_t length) const {
+    if (count_ == 0)
+        return NONE;
+    size_t hash = hashName(name, length);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask; slots_[i].server != NONE; i = (i + 1) & mask) {
+        Entry const &e = slots_[i];
+        if (e.hash == hash && e.name.size() == length && equalsLowercase(name, e.name))
+            return e.server;
+    }
+    return NONE;
+}
+
+// =============================================================================
+// VirtualHosts
+// =============================================================================
+
+VirtualHosts::VirtualHosts() {}
+
+void VirtualHosts::add(std::string const &name, size_t server) {
+    std::string key(name.size(), '\0');
+    for (size_t i = 0; i < name.size(); ++i)
+        key[i] = lower(name[i]);
+    if (key.size() > 1 && key[key.size() - 1] == '.')
+        key.resize(key.size() - 1);
+
+    if (key.size() > 2 && key[0] == '*' && key[1] == '.') {
+        leading_.add(key.substr(1), server);
+    } else if (key.size() > 1 && key[0] == '.') {
+        exact_.add(key.substr(1), server);
+        leading_.add(key, server);
+    } else if (key.size() > 2 && key[key.size() - 1] == '*' && key[key.size() - 2] == '.') {
+        trailing_.add(key.substr(0, key.size() - 1), server);
+    } else {
+        exact_.add(key, server);
+    }
+}
+
+size_t VirtualHosts::find(std::string const &host) const {
+    char const *name = host.data();
+    size_t length = host.size();
+    if (length > 0 && name[0] == '[') {
+        size_t close = host.find(']');
+        if (close != std::string::npos)
+            length = close + 1; // IPv6 literal, the port follows the bracket
+    } else {
+        size_t colon = host.find(':');
+        if (colon != std::string::npos)
+            length = colon;
+    }
+    if (length > 1 && name[length - 1] == '.')
+        --length;
+
+    size_t server = exact_.find(name, length);
+    if (server != NONE)
+        return server;
+    // Longest suffix first: the leftmost dot that is not the first byte
+    for (size_t i = 1; i < length; ++i) {
+        if (name[i] == '.' && (server = leading_.find(name + i, length - i)) != NONE)
+            return server;
+    }
+    // Longest prefix first: up to the rightmost dot that is not the last byte
+    for (size_t end = length; end-- > 1;) {
+        if (name[end - 1] == '.' && (server = trailing_.find(name, end)) != NONE)
+            return server;
+    }
+    return NONE;
+}
+
+} // namespace config
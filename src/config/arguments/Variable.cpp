@@ -1,5 +1,6 @@
 #include "config/arguments/Variable.hpp"
 #include "http/Request.hpp"
+#include <map>
 
 namespace config {
 
@@ -16,7 +17,7 @@ std::string Variable::evaluate(http::Request const &req) const {
     return it->second(req);
 }
 
-std::string HostFunc(http::Request const &req) { return req.headers().get("Host"); }
+std::string HostFunc(http::Request const &req) { return req.headers().get(http::header::HOST); }
 
 FuncMap const &getMap() {
     static FuncMap map;
@@ -0,0 +1,52 @@
+#include "config/directives/CgiLimitsDirective.hpp"
+#include "common/string.hpp"
+#include "config/arguments/Integer.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include "config/internal/utils.hpp"
+
+namespace config {
+
+const std::string CgiLimitsDirective::name_ = "cgi_limits";
+
+void CgiLimitsDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "location", name_);
+    ValidatorUtils::checkArgs(args, 1, 3, name_);
+    if (b.has(name_)) {
+        throw ConfigError("'" + name_ + "' directive is duplicate.");
+    }
+
+    enum { CPU, ADDRESS_SPACE, OPEN_FILES };
+    size_t limits[3] = {0, 0, 0};
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string const &literal = args[i].literal;
+        size_t pos = literal.find('=');
+        std::string key = literal.substr(0, pos);
+        std::string value = pos == std::string::npos ? "" : literal.substr(pos + 1);
+        size_t parsed = 0;
+        bool isValid;
+        int limit;
+        if (key == "cpu") {
+            limit = CPU;
+            isValid = utils::parseDuration(value, parsed);
+        } else if (key == "as") {
+            limit = ADDRESS_SPACE;
+            isValid = utils::parseSize(value, parsed);
+        } else if (key == "nofile") {
+            limit = OPEN_FILES;
+            isValid = !value.empty() && value.size() <= 7 && utils::isAllDigit(value);
+            if (isValid)
+                parsed = utils::fromString<size_t>(value);
+        } else {
+            throw ConfigError("'" + name_ + "' invalid parameter: " + literal);
+        }
+        // 0 would not limit anything, and stands for "not set" once stored
+        if (!isValid || parsed == 0 || pos == std::string::npos || limits[limit] != 0)
+            throw ConfigError("'" + name_ + "' invalid limit: " + literal);
+        limits[limit] = parsed;
+    }
+    b.add(name_, new Integer(limits[CPU]));
+    b.add(name_, new Integer(limits[ADDRESS_SPACE]));
+    b.add(name_, new Integer(limits[OPEN_FILES]));
+}
+
+} // namespace config
@@ -8,6 +8,9 @@ const std::string CgiPassDirective::name_ = "cgi_pass";
 void CgiPassDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
     ValidatorUtils::checkContext(b, "location", name_);
     ValidatorUtils::checkArgs(args, 0, 2, name_);
+    if (b.has("fastcgi_pass")) {
+        throw ConfigError("'" + name_ + "' cannot be combined with 'fastcgi_pass'.");
+    }
 
     if (args.empty()) {
         b.add(name_, "enabled");
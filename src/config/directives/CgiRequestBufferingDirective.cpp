@@ -0,0 +1,18 @@
+#include "config/directives/CgiRequestBufferingDirective.hpp"
+#include "config/arguments/Bool.hpp"
+#include "config/internal/ValidationUtils.hpp"
+
+namespace config {
+
+const std::string CgiRequestBufferingDirective::name_ = "cgi_request_buffering";
+
+void CgiRequestBufferingDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "location", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+    if (b.has(name_)) {
+        throw ConfigError("'" + name_ + "' directive is duplicate.");
+    }
+    b.add(name_, new Bool(args[0].literal));
+}
+
+} // namespace config
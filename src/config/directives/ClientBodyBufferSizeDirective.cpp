@@ -0,0 +1,21 @@
+#include "config/directives/ClientBodyBufferSizeDirective.hpp"
+#include "config/arguments/Integer.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include "config/internal/utils.hpp"
+
+namespace config {
+
+const std::string ClientBodyBufferSizeDirective::name_ = "client_body_buffer_size";
+
+void ClientBodyBufferSizeDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "server location", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+
+    size_t size = 0;
+    if (!utils::parseSize(args[0].literal, size)) {
+        throw ConfigError("'" + name_ + "' invalid size: " + args[0].literal);
+    }
+    b.add(name_, new Integer(size));
+}
+
+} // namespace config
@@ -0,0 +1,18 @@
+#include "config/directives/ClientBodyTempPathDirective.hpp"
+#include "config/internal/ValidationUtils.hpp"
+
+namespace config {
+
+const std::string ClientBodyTempPathDirective::name_ = "client_body_temp_path";
+
+void ClientBodyTempPathDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "server location", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+
+    if (args[0].literal.empty()) {
+        throw ConfigError("'" + name_ + "' value cannot be empty.");
+    }
+    b.add(name_, args);
+}
+
+} // namespace config
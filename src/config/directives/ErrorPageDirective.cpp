@@ -11,8 +11,8 @@ void ErrorPageDirective::process(Block &b, ParsedDirectiveArgs const &args) cons
     ValidatorUtils::checkArgs(args, 2, 20, name_); // Arbitrary max to prevent abuse
 
     const std::string path = args[args.size() - 1].literal;
-    static const char *codes[] = {"400", "401", "403", "404", "405", "409", "411",
-                                  "413", "415", "500", "501", "502", "503", "504"};
+    static const char *codes[] = {"400", "401", "403", "404", "405", "408", "409",
+                                  "411", "413", "415", "500", "501", "502", "503", "504"};
     static const std::set<std::string> validCodes(codes, codes + sizeof(codes) / sizeof(codes[0]));
 
     for (size_t j = 0; j < args.size() - 1; j++) {
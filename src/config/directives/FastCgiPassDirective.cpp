@@ -0,0 +1,39 @@
+#include "config/directives/FastCgiPassDirective.hpp"
+#include "common/string.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include "config/internal/utils.hpp"
+#include <sys/un.h>
+
+namespace config {
+
+const std::string FastCgiPassDirective::name_ = "fastcgi_pass";
+
+namespace {
+const size_t MAX_SOCKET_PATH = sizeof(((sockaddr_un *)0)->sun_path) - 1;
+} // namespace
+
+void FastCgiPassDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "location", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+    if (b.has(name_)) {
+        throw ConfigError("'" + name_ + "' directive is duplicate.");
+    }
+    if (b.has("cgi_pass")) {
+        throw ConfigError("'" + name_ + "' cannot be combined with 'cgi_pass'.");
+    }
+
+    std::string const &address = args[0].literal;
+    if (address.compare(0, 5, "unix:") == 0) {
+        if (address.size() == 5 || address.size() - 5 > MAX_SOCKET_PATH)
+            throw ConfigError("'" + name_ + "' invalid socket path: " + address);
+        b.add(name_, address);
+        return;
+    }
+    // Stored as ip:port, which the connection pool parses without a resolver
+    utils::IpInfo ipInfo;
+    if (!utils::extractIpInfo(address, ipInfo) || ipInfo.ip.empty() || ipInfo.port == -1)
+        throw ConfigError("'" + name_ + "' invalid address: " + address);
+    b.add(name_, ipInfo.ip + ":" + utils::toString(ipInfo.port));
+}
+
+} // namespace config
@@ -1,4 +1,5 @@
 #include "config/directives/ListenDirective.hpp"
+#include "common/string.hpp"
 #include "config/Block.hpp"
 #include "config/ServerBlock.hpp"
 #include "config/internal/ConfigException.hpp"
@@ -12,18 +13,46 @@ namespace config {
 
 const std::string ListenDirective::name_ = "listen";
 
+namespace {
+const int MAX_QUEUE = 65535;
+
+bool parseQueueLength(std::string const &value, int &length) {
+    if (value.empty() || value.size() > 5 || !utils::isAllDigit(value))
+        return false;
+    length = utils::fromString<int>(value);
+    return length > 0 && length <= MAX_QUEUE;
+}
+} // namespace
+
 void ListenDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
     ValidatorUtils::checkContext(b, "server", name_);
-    ValidatorUtils::checkArgs(args, 1, 1, name_);
+    ValidatorUtils::checkArgs(args, 1, 4, name_);
 
     utils::IpInfo ipInfo;
     if (!utils::extractIpInfo(args[0].literal, ipInfo)) {
         throw ConfigError("'listen' directive '" + args[0].literal + "' has an invalid format.");
     }
 
+    ListenOptions options;
+    for (size_t i = 1; i < args.size(); ++i) {
+        std::string const &param = args[i].literal;
+        if (param.compare(0, 8, "backlog=") == 0) {
+            if (!parseQueueLength(param.substr(8), options.backlog))
+                throw ConfigError("'" + name_ + "' invalid backlog: " + param);
+        } else if (param.compare(0, 9, "fastopen=") == 0) {
+            if (!parseQueueLength(param.substr(9), options.fastOpen))
+                throw ConfigError("'" + name_ + "' invalid fastopen: " + param);
+        } else if (param == "deferred") {
+            options.deferred = true;
+        } else {
+            throw ConfigError("'" + name_ + "' invalid parameter: " + param);
+        }
+    }
+
     ServerBlock *serverBlock = static_cast<ServerBlock *>(&b);
     serverBlock->port((ipInfo.port == -1 ? 9191 : ipInfo.port));
     serverBlock->address((ipInfo.ip.empty() ? "0.0.0.0" : ipInfo.ip));
+    serverBlock->listenOptions(options);
     b.add(name_, args);
 }
 
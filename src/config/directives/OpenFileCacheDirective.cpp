@@ -0,0 +1,56 @@
+#include "config/directives/OpenFileCacheDirective.hpp"
+#include "common/string.hpp"
+#include "config/arguments/Integer.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include "config/internal/utils.hpp"
+
+namespace config {
+
+const std::string OpenFileCacheDirective::name_ = "open_file_cache";
+
+namespace {
+const size_t MAX_ENTRIES = 1000000;
+const size_t DEFAULT_VALIDITY = 60;
+} // namespace
+
+void OpenFileCacheDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "main", name_);
+    ValidatorUtils::checkArgs(args, 1, 2, name_);
+    if (b.has(name_)) {
+        throw ConfigError("'" + name_ + "' directive is duplicate.");
+    }
+
+    if (args[0].literal == "off") {
+        if (args.size() != 1)
+            throw ConfigError("'" + name_ + " off' takes no parameters.");
+        b.add(name_, new Integer(0));
+        b.add(name_, new Integer(0));
+        return;
+    }
+
+    size_t maxEntries = 0;
+    size_t validity = DEFAULT_VALIDITY;
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string const &literal = args[i].literal;
+        if (literal.compare(0, 4, "max=") == 0) {
+            std::string value = literal.substr(4);
+            if (value.empty() || value.size() > 7 || !utils::isAllDigit(value))
+                throw ConfigError("'" + name_ + "' invalid max: " + literal);
+            maxEntries = utils::fromString<size_t>(value);
+        } else if (literal.compare(0, 6, "valid=") == 0) {
+            if (!utils::parseDuration(literal.substr(6), validity) || validity == 0)
+                throw ConfigError("'" + name_ + "' invalid valid: " + literal);
+        } else {
+            throw ConfigError("'" + name_ + "' invalid parameter: " + literal);
+        }
+    }
+
+    if (maxEntries == 0 || maxEntries > MAX_ENTRIES) {
+        throw ConfigError("'" + name_ + "' requires max= between 1 and " +
+                          utils::toString(MAX_ENTRIES) + ".");
+    }
+    b.add(name_, new Integer(maxEntries));
+    b.add(name_, new Integer(validity));
+}
+
+} // namespace config
@@ -0,0 +1,24 @@
+#include "config/directives/TimeoutDirective.hpp"
+#include "config/arguments/Integer.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include "config/internal/utils.hpp"
+
+namespace config {
+
+TimeoutDirective::TimeoutDirective(std::string const &name) : name_(name) {}
+
+void TimeoutDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "main", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+    if (b.has(name_)) {
+        throw ConfigError("'" + name_ + "' directive is duplicate.");
+    }
+
+    size_t seconds = 0;
+    if (!utils::parseDuration(args[0].literal, seconds)) {
+        throw ConfigError("'" + name_ + "' invalid duration: " + args[0].literal);
+    }
+    b.add(name_, new Integer(seconds));
+}
+
+} // namespace config
@@ -0,0 +1,38 @@
+#include "config/directives/WorkerProcessesDirective.hpp"
+#include "common/string.hpp"
+#include "config/arguments/Integer.hpp"
+#include "config/internal/ValidationUtils.hpp"
+#include <unistd.h>
+
+namespace config {
+
+const std::string WorkerProcessesDirective::name_ = "worker_processes";
+
+namespace {
+const size_t MAX_WORKER_PROCESSES = 1024;
+} // namespace
+
+void WorkerProcessesDirective::process(Block &b, ParsedDirectiveArgs const &args) const {
+    ValidatorUtils::checkContext(b, "main", name_);
+    ValidatorUtils::checkArgs(args, 1, 1, name_);
+
+    std::string const &literal = args[0].literal;
+    size_t count;
+    if (literal == "auto") {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = cpus > 0 ? static_cast<size_t>(cpus) : 1;
+    } else {
+        if (literal.empty() || !utils::isAllDigit(literal)) {
+            throw ConfigError("'" + name_ + "' invalid value: " + literal);
+        }
+        count = utils::fromString<size_t>(literal);
+    }
+
+    if (count == 0 || count > MAX_WORKER_PROCESSES) {
+        throw ConfigError("'" + name_ + "' must be between 1 and " +
+                          utils::toString(MAX_WORKER_PROCESSES) + ": " + literal);
+    }
+    b.add(name_, new Integer(count));
+}
+
+} // namespace config
@@ -199,8 +199,16 @@ std::ostream &operator<<(std::ostream &o, Block const &b) {
     return o;
 }
 
-size_t Block::maxBodySize() const {
-    std::string const key = "client_max_body_size";
+size_t Block::maxBodySize() const { return getSize("client_max_body_size"); }
+
+Block &Block::bodyBufferSize(size_t size) {
+    add("client_body_buffer_size", size);
+    return *this;
+}
+
+size_t Block::bodyBufferSize() const { return getSize("client_body_buffer_size"); }
+
+size_t Block::getSize(std::string const &key) const {
     if (!has(key))
         return 0;
     ArgumentVector const &argv = get(key);
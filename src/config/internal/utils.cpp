@@ -47,4 +47,63 @@ bool extractIpInfo(std::string const &s, IpInfo &info) {
     return true;
 }
 
+bool parseDuration(std::string const &s, size_t &seconds) {
+    if (s.empty())
+        return false;
+    size_t multiplier = 1;
+    std::string numberPart = s;
+    switch (s[s.size() - 1]) {
+    case 's':
+        numberPart.resize(s.size() - 1);
+        break;
+    case 'm':
+        multiplier = 60;
+        numberPart.resize(s.size() - 1);
+        break;
+    case 'h':
+        multiplier = 60 * 60;
+        numberPart.resize(s.size() - 1);
+        break;
+    case 'd':
+        multiplier = 24 * 60 * 60;
+        numberPart.resize(s.size() - 1);
+        break;
+    }
+    if (numberPart.empty() || numberPart.size() > 9 || !isAllDigit(numberPart))
+        return false;
+    seconds = fromString<size_t>(numberPart) * multiplier;
+    return true;
+}
+
+bool parseSize(std::string const &s, size_t &bytes) {
+    if (s.empty())
+        return false;
+    size_t multiplier = 1;
+    std::string numberPart = s;
+    switch (s[s.size() - 1]) {
+    case 'k':
+    case 'K':
+        multiplier = 1024;
+        numberPart.resize(s.size() - 1);
+        break;
+    case 'm':
+    case 'M':
+        multiplier = 1024 * 1024;
+        numberPart.resize(s.size() - 1);
+        break;
+    case 'g':
+    case 'G':
+        multiplier = 1024 * 1024 * 1024;
+        numberPart.resize(s.size() - 1);
+        break;
+    }
+    if (numberPart.empty() || numberPart.size() > 19 || !isAllDigit(numberPart))
+        return false;
+    size_t size = fromString<size_t>(numberPart);
+    if (size > static_cast<size_t>(-1) / multiplier)
+        return false;
+    bytes = size * multiplier;
+    return true;
+}
+
 } // namespace utils
@@ -2,16 +2,25 @@
 #include "config/directives/AliasDirective.hpp"
 #include "config/directives/AllowMethodsDirective.hpp"
 #include "config/directives/AutoIndexDirective.hpp"
+#include "config/directives/CgiLimitsDirective.hpp"
 #include "config/directives/CgiPassDirective.hpp"
+#include "config/directives/CgiRequestBufferingDirective.hpp"
+#include "config/directives/ClientBodyBufferSizeDirective.hpp"
+#include "config/directives/ClientBodyTempPathDirective.hpp"
 #include "config/directives/ClientMaxBodySize.hpp"
+#include "config/directives/EdgeTriggeredDirective.hpp"
 #include "config/directives/ErrorPageDirective.hpp"
+#include "config/directives/FastCgiPassDirective.hpp"
 #include "config/directives/IDirective.hpp"
 #include "config/directives/IndexDirective.hpp"
 #include "config/directives/ListenDirective.hpp"
+#include "config/directives/OpenFileCacheDirective.hpp"
 #include "config/directives/ReturnDirective.hpp"
 #include "config/directives/RootDirective.hpp"
 #include "config/directives/ServerNameDirective.hpp"
+#include "config/directives/TimeoutDirective.hpp"
 #include "config/directives/UploadPathDirective.hpp"
+#include "config/directives/WorkerProcessesDirective.hpp"
 
 namespace config {
 
@@ -21,13 +30,27 @@ DirectiveHandler::DirectiveHandler() {
     registerHandler(new ErrorPageDirective);
     registerHandler(new ReturnDirective);
     registerHandler(new ClientMaxBodySize);
+    registerHandler(new ClientBodyBufferSizeDirective);
+    registerHandler(new ClientBodyTempPathDirective);
     registerHandler(new IndexDirective);
     registerHandler(new AliasDirective);
     registerHandler(new ServerNameDirective);
     registerHandler(new UploadPathDirective);
     registerHandler(new AllowMethodsDirective);
     registerHandler(new CgiPassDirective);
+    registerHandler(new CgiRequestBufferingDirective);
+    registerHandler(new CgiLimitsDirective);
+    registerHandler(new FastCgiPassDirective);
     registerHandler(new AutoIndexDirective);
+    registerHandler(new WorkerProcessesDirective);
+    registerHandler(new OpenFileCacheDirective);
+    registerHandler(new EdgeTriggeredDirective);
+    registerHandler(new TimeoutDirective("client_header_timeout"));
+    registerHandler(new TimeoutDirective("client_body_timeout"));
+    registerHandler(new TimeoutDirective("keepalive_timeout"));
+    registerHandler(new TimeoutDirective("send_timeout"));
+    registerHandler(new TimeoutDirective("cgi_timeout"));
+    registerHandler(new TimeoutDirective("cgi_read_timeout"));
 }
 
 void DirectiveHandler::registerHandler(IDirective *h) {
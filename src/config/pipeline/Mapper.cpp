@@ -14,6 +14,8 @@ ServerBlockVec Mapper::map(const ConfigNodeVec &nodes) {
         return server_blocks;
     server_blocks.reserve(nodes.size());
     for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].name == "main")
+            continue;
         ServerBlock sb;
         mapServerBlock(sb, nodes[i]);
         server_blocks.push_back(sb);
@@ -21,6 +23,13 @@ ServerBlockVec Mapper::map(const ConfigNodeVec &nodes) {
     return server_blocks;
 }
 
+void Mapper::mapMainBlock(Block &main, ConfigNodeVec const &nodes) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].name == "main")
+            DirectiveHandler::getInstance().process(main, nodes[i].directives);
+    }
+}
+
 void Mapper::mapServerBlock(ServerBlock &b, ConfigNode const &node) {
     DirectiveHandler::getInstance().process(b, node.directives);
 
@@ -9,7 +9,7 @@ Parser::Parser(TokenArray const &tokens) : tokens_(tokens), pos_(0) { nodes_.res
 
 std::vector<ConfigNode> Parser::parse(TokenArray const &tokens) {
     Parser parser(tokens);
-    parser.handleServerBlock();
+    parser.handleMainContext();
     return parser.nodes_;
 }
 
@@ -62,17 +62,32 @@ bool Parser::isTokenAValue() const {
     return currentToken().isTypeIn(validTypes, validTypesCount);
 }
 
-void Parser::handleServerBlock() {
+void Parser::handleMainContext() {
     while (currentToken().type != END_OF_FILE) {
-        expectToken("server");
-        expectToken(LEFT_BRACE);
-        nodes_.push_back(ConfigNode("server"));
-        while (currentToken().type != RIGHT_BRACE)
-            handleStatement();
-        expectToken(RIGHT_BRACE);
+        if (currentToken().literal == "server") {
+            handleServerBlock();
+            continue;
+        }
+        // Top-level directives are collected into a single "main" node
+        // that is created the first time one is seen.
+        size_t i = 0;
+        while (i < nodes_.size() && nodes_[i].name != "main")
+            i++;
+        if (i == nodes_.size())
+            nodes_.push_back(ConfigNode("main"));
+        addDirective(nodes_[i], handleDirective());
     }
 }
 
+void Parser::handleServerBlock() {
+    expectToken("server");
+    expectToken(LEFT_BRACE);
+    nodes_.push_back(ConfigNode("server"));
+    while (currentToken().type != RIGHT_BRACE)
+        handleStatement();
+    expectToken(RIGHT_BRACE);
+}
+
 void Parser::handleStatement() {
     if (currentToken().literal == "location")
         handleLocationBlock();
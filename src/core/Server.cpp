@@ -1,12 +1,18 @@
 #include "core/Server.hpp"
 #include "config/ServerConfig.hpp"
+#include "http/OpenFileCache.hpp"
 #include "http/Router.hpp"
+#include "network/ChildReaper.hpp"
 #include "network/EventDispatcher.hpp"
+#include "network/FileCacheWatcher.hpp"
 #include "utils/Logger.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
 #include <iostream>
+#include <sched.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -19,11 +25,12 @@ namespace {
 
 Server *instance_ = NULL;
 
+const time_t RESPAWN_DELAY = 1; //!< Seconds a worker must live to be respawned at once.
+
 void signalHandler(int sig) {
     if (instance_) {
         LOG_TRACE("Signal " << sig << " received. Initiating graceful shutdown.");
         instance_->requestShutDown();
-        network::EventDispatcher::getInstance().requestShutdown();
     }
 }
 
@@ -47,13 +54,37 @@ void setupSignalHandlers() {
     LOG_DEBUG("Signal handlers installed.");
 }
 
+// Pins the calling process to the slot-th CPU it is allowed to run on.
+void pinToCpu(size_t slot) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        LOG_WARN("Worker " << slot << ": sched_getaffinity failed: " << strerror(errno));
+        return;
+    }
+    int target = static_cast<int>(slot % CPU_COUNT(&allowed));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed) || target-- > 0)
+            continue;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            LOG_WARN("Worker " << slot << ": sched_setaffinity failed: " << strerror(errno));
+        } else {
+            LOG_DEBUG("Worker " << slot << " pinned to CPU " << cpu);
+        }
+        return;
+    }
+}
+
 } // namespace
 
 Server::Server(config::ServerConfig const &config)
     : isRunning_(false),
       shutdownRequested_(false),
       config_(config),
-      dispatcher_(network::EventDispatcher::getInstance()),
+      dispatcher_(NULL),
       router_(config_, mimeTypes_),
       nullFd_(open("/dev/null", O_RDONLY)) {
 
@@ -81,19 +112,109 @@ void Server::start() {
         return;
     }
     LOG_INFO("Starting server...");
-    setupAcceptors();
+    size_t workerCount = config_.workerProcesses();
+    if (workerCount > 1 && runMaster(workerCount)) {
+        LOG_INFO("All workers exited. Server shutdown complete.");
+        return;
+    }
+    network::EventDispatcher dispatcher(config_.edgeTriggered());
+    runWorker(dispatcher, workerCount > 1);
+}
+
+void Server::stop() {
+    LOG_TRACE("Server::stop() called.");
+    requestShutDown();
+}
+
+void Server::runWorker(network::EventDispatcher &dispatcher, bool reusePort) {
+    dispatcher_ = &dispatcher;
+    if (shutdownRequested_)
+        dispatcher.requestShutdown();
+    try {
+        setupAcceptors(reusePort);
+        setupFileCache();
+        dispatcher.registerHandler(new network::ChildReaper(dispatcher));
+    } catch (...) {
+        acceptors_.clear(); // Already owned (and deleted) by the dispatcher.
+        dispatcher_ = NULL;
+        throw;
+    }
     isRunning_ = true;
 
     LOG_INFO("Server is now running. Waiting for events...");
     LOG_INFO("Send SIGTERM (kill) or SIGINT (Ctrl+C) for graceful shutdown.");
-    dispatcher_.handleEvents();
+    dispatcher.handleEvents();
     gracefulShutdown();
+    dispatcher_ = NULL;
 }
 
-void Server::stop() {
-    LOG_TRACE("Server::stop() called.");
-    requestShutDown();
-    dispatcher_.requestShutdown();
+bool Server::runMaster(size_t workerCount) {
+    LOG_INFO("Starting " << workerCount << " worker processes...");
+    workers_.assign(workerCount, -1);
+    std::vector<time_t> started(workerCount, time(NULL));
+    size_t alive = 0;
+    for (size_t i = 0; i < workerCount; ++i) {
+        pid_t pid = spawnWorker(i);
+        if (pid == 0)
+            return false;
+        if (pid > 0)
+            alive++;
+    }
+
+    while (alive > 0) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("waitpid failed: " << strerror(errno));
+            break;
+        }
+        std::vector<pid_t>::iterator it = std::find(workers_.begin(), workers_.end(), pid);
+        if (it == workers_.end())
+            continue;
+        *it = -1;
+        alive--;
+        size_t slot = it - workers_.begin();
+        if (shutdownRequested_ || !WIFSIGNALED(status)) {
+            if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+                LOG_ERROR("Worker " << slot << " exited with status " << WEXITSTATUS(status));
+            continue;
+        }
+        LOG_WARN("Worker " << slot << " killed by signal " << WTERMSIG(status) << ", respawning.");
+        if (time(NULL) - started[slot] < RESPAWN_DELAY) {
+            // Crashing as it starts: do not fork in a tight loop. A signal cuts the wait short
+            sleep(RESPAWN_DELAY);
+            if (shutdownRequested_)
+                continue;
+        }
+        started[slot] = time(NULL);
+        pid = spawnWorker(slot);
+        if (pid == 0)
+            return false;
+        if (pid > 0)
+            alive++;
+    }
+    workers_.clear();
+    return true;
+}
+
+pid_t Server::spawnWorker(size_t slot) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("Failed to fork worker " << slot << ": " << strerror(errno));
+        return -1;
+    }
+    if (pid == 0) {
+        workers_.clear();
+        pinToCpu(slot);
+        return 0;
+    }
+    workers_[slot] = pid;
+    LOG_INFO("Worker " << slot << " started (pid " << pid << ").");
+    if (shutdownRequested_) // The signal came before the pid was stored: it missed this worker
+        kill(pid, SIGTERM);
+    return pid;
 }
 
 void Server::gracefulShutdown() {
@@ -108,7 +229,7 @@ void Server::gracefulShutdown() {
 
 bool Server::getisRunning() const { return isRunning_; }
 
-void Server::setupAcceptors() {
+void Server::setupAcceptors(bool reusePort) {
     LOG_TRACE("Setting up server listeners (acceptors)...");
     config::ServerBlockMap const &servers = config_.getServersMap();
     for (config::ServerBlockMap::const_iterator it = servers.begin(); it != servers.end(); ++it) {
@@ -117,28 +238,51 @@ void Server::setupAcceptors() {
             // Since we've got multiple servers Listening on same port then default address would be
             // "0.0.0.0" and all requests would be accepted and virtual server name matching would
             // decide which server block to get
-            acceptor = new network::Acceptor(it->first, router_);
+            config::ListenOptions options;
+            for (size_t i = 0; i < it->second.size(); ++i)
+                options.merge(it->second[i].listenOptions());
+            acceptor = new network::Acceptor(it->first, options, router_, *dispatcher_, reusePort);
             LOG_INFO("Listening on 0.0.0.0:" << it->first);
         } else if (it->second.size() == 1) {
-            acceptor = new network::Acceptor(it->second[0], router_);
+            acceptor = new network::Acceptor(it->second[0], router_, *dispatcher_, reusePort);
             LOG_INFO("Listening on port: " << it->second[0].port());
         } else
             continue;
-        dispatcher_.registerHandler(acceptor);
+        dispatcher_->registerHandler(acceptor);
         acceptors_.push_back(acceptor);
     }
 }
 
+void Server::setupFileCache() {
+    size_t maxEntries, validity;
+    config_.openFileCache(maxEntries, validity);
+    // Configured here, after fork(), so every worker gets its own inotify instance
+    http::OpenFileCache &cache = http::OpenFileCache::getInstance();
+    cache.configure(maxEntries, validity);
+    if (cache.watchFd() != -1)
+        dispatcher_->registerHandler(new network::FileCacheWatcher(cache));
+}
+
 void Server::cleanup() {
-    for (std::vector<network::Acceptor *>::iterator it = acceptors_.begin(); it != acceptors_.end();
-         ++it) {
-        dispatcher_.removeHandler(*it);
+    if (dispatcher_) {
+        for (std::vector<network::Acceptor *>::iterator it = acceptors_.begin();
+             it != acceptors_.end(); ++it) {
+            dispatcher_->removeHandler(*it);
+        }
     }
     acceptors_.clear();
 }
 
 int core::Server::getNullFd() { return instance_->nullFd_; }
 
-void Server::requestShutDown() { shutdownRequested_ = true; }
+void Server::requestShutDown() {
+    shutdownRequested_ = true;
+    if (dispatcher_)
+        dispatcher_->requestShutdown();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i] > 0)
+            kill(workers_[i], SIGTERM);
+    }
+}
 
 } // namespace core
@@ -0,0 +1,98 @@
+#include "http/BodyPipe.hpp"
+#include "utils/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace http {
+
+const size_t BodyPipe::HIGH_WATER;
+
+BodyPipe::BodyPipe() : fd_(-1), sent_(0), isFinished_(false), isDropped_(false) {}
+
+BodyPipe::~BodyPipe() {
+    if (fd_ != -1)
+        ::close(fd_);
+}
+
+int BodyPipe::open() {
+    int fds[2];
+    // Both ends close on exec; only the write end is non-blocking, the script's stdin
+    // stays an ordinary blocking one
+    if (pipe2(fds, O_CLOEXEC) == -1)
+        return -1;
+    if (fcntl(fds[1], F_SETFL, O_NONBLOCK) == -1) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return -1;
+    }
+    fd_ = fds[1];
+    return fds[0];
+}
+
+void BodyPipe::write(char const *data, size_t size) {
+    if (isDropped_ || size == 0)
+        return;
+    if (fd_ != -1 && sent_ == buffer_.size()) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_DEBUG("BodyPipe::write: " << strerror(errno) << ", dropping the body");
+            return drop();
+        }
+        if (written > 0) {
+            data += written;
+            size -= written;
+        }
+        buffer_.clear();
+        sent_ = 0;
+    } else if (sent_ > 0 && sent_ >= buffer_.size() / 2) {
+        buffer_.erase(0, sent_);
+        sent_ = 0;
+    }
+    buffer_.append(data, size);
+}
+
+BodyPipe::Status BodyPipe::flush() {
+    while (!isDropped_ && fd_ != -1 && sent_ < buffer_.size()) {
+        ssize_t written = ::write(fd_, buffer_.data() + sent_, buffer_.size() - sent_);
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return PENDING;
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0) {
+            LOG_DEBUG("BodyPipe::flush: " << strerror(errno) << ", dropping the body");
+            drop();
+            break;
+        }
+        sent_ += written;
+    }
+    if (isDropped_)
+        return DONE;
+    if (sent_ < buffer_.size())
+        return PENDING;
+    buffer_.clear();
+    sent_ = 0;
+    return isFinished_ && fd_ != -1 ? DONE : FLUSHED;
+}
+
+void BodyPipe::finish() { isFinished_ = true; }
+
+void BodyPipe::close() {
+    if (fd_ != -1)
+        ::close(fd_);
+    fd_ = -1;
+    drop();
+}
+
+void BodyPipe::drop() {
+    isDropped_ = true;
+    std::string().swap(buffer_);
+    sent_ = 0;
+}
+
+int BodyPipe::fd() const { return fd_; }
+
+bool BodyPipe::isFull() const { return buffer_.size() - sent_ >= HIGH_WATER; }
+
+} // namespace http
@@ -0,0 +1,362 @@
+#include "http/FastCgi.hpp"
+#include "utils/Logger.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace http {
+
+namespace fastcgi {
+
+namespace {
+
+const unsigned char VERSION = 1;
+const unsigned char RESPONDER = 1;
+const unsigned char KEEP_CONN = 1;
+
+void appendHeader(std::vector<char> &out, RecordType type, size_t length, size_t padding) {
+    char header[HEADER_SIZE] = {static_cast<char>(VERSION),
+                                static_cast<char>(type),
+                                static_cast<char>(REQUEST_ID >> 8),
+                                static_cast<char>(REQUEST_ID & 0xff),
+                                static_cast<char>(length >> 8),
+                                static_cast<char>(length & 0xff),
+                                static_cast<char>(padding),
+                                0};
+    out.insert(out.end(), header, header + HEADER_SIZE);
+}
+
+void appendLength(std::vector<char> &out, size_t length) {
+    if (length < 128) {
+        out.push_back(static_cast<char>(length));
+        return;
+    }
+    out.push_back(static_cast<char>(((length >> 24) & 0x7f) | 0x80));
+    out.push_back(static_cast<char>(length >> 16));
+    out.push_back(static_cast<char>(length >> 8));
+    out.push_back(static_cast<char>(length));
+}
+
+} // namespace
+
+void appendRecord(std::vector<char> &out, RecordType type, char const *content, size_t length) {
+    do {
+        size_t chunk = std::min(length, MAX_CONTENT_LENGTH);
+        size_t padding = (8 - chunk % 8) % 8; // Keeps the next header 8-byte aligned
+        appendHeader(out, type, chunk, padding);
+        out.insert(out.end(), content, content + chunk);
+        out.insert(out.end(), padding, '\0');
+        content += chunk;
+        length -= chunk;
+    } while (length > 0);
+}
+
+void appendBeginRequest(std::vector<char> &out) {
+    char const body[8] = {0, static_cast<char>(RESPONDER), static_cast<char>(KEEP_CONN)};
+    appendHeader(out, BEGIN_REQUEST, sizeof(body), 0);
+    out.insert(out.end(), body, body + sizeof(body));
+}
+
+void appendParam(std::vector<char> &out, char const *name, size_t nameLength,
+                 char const *value, size_t valueLength) {
+    appendLength(out, nameLength);
+    appendLength(out, valueLength);
+    out.insert(out.end(), name, name + nameLength);
+    out.insert(out.end(), value, value + valueLength);
+}
+
+// =============================================================================
+// ResponseDecoder
+// =============================================================================
+
+ResponseDecoder::ResponseDecoder() : headerLength_(0), contentLeft_(0), paddingLeft_(0) {}
+
+ResponseDecoder::Event ResponseDecoder::next(char const *&data, size_t &length,
+                                             char const *&payload, size_t &payloadLength) {
+    for (;;) {
+        if (headerLength_ == HEADER_SIZE && contentLeft_ == 0 && paddingLeft_ == 0) {
+            headerLength_ = 0; // The record is complete
+            if (header_[1] == END_REQUEST)
+                return END;
+        }
+        if (length == 0)
+            return NEED_MORE;
+
+        if (headerLength_ < HEADER_SIZE) {
+            size_t n = std::min(HEADER_SIZE - headerLength_, length);
+            std::memcpy(header_ + headerLength_, data, n);
+            headerLength_ += n;
+            data += n;
+            length -= n;
+            if (headerLength_ < HEADER_SIZE)
+                return NEED_MORE;
+            if (header_[0] != VERSION)
+                return INVALID;
+            contentLeft_ = (static_cast<size_t>(header_[4]) << 8) | header_[5];
+            paddingLeft_ = header_[6];
+            continue;
+        }
+
+        size_t n = std::min(contentLeft_ ? contentLeft_ : paddingLeft_, length);
+        char const *slice = data;
+        data += n;
+        length -= n;
+        if (contentLeft_ == 0) {
+            paddingLeft_ -= n;
+            continue;
+        }
+        contentLeft_ -= n;
+        if (header_[1] == STDOUT || header_[1] == STDERR) {
+            payload = slice;
+            payloadLength = n;
+            return header_[1] == STDOUT ? OUTPUT : ERROR_OUTPUT;
+        }
+        // END_REQUEST's status and management records carry nothing we act on
+    }
+}
+
+// =============================================================================
+// ConnectionPool
+// =============================================================================
+
+ConnectionPool &ConnectionPool::getInstance() {
+    static ConnectionPool instance;
+    return instance;
+}
+
+ConnectionPool::ConnectionPool() {}
+
+ConnectionPool::~ConnectionPool() { clear(); }
+
+bool ConnectionPool::parseAddress(std::string const &backend, Backend &entry) {
+    std::memset(&entry.address, 0, sizeof(entry.address));
+    if (backend.compare(0, 5, "unix:") == 0) {
+        sockaddr_un *un = reinterpret_cast<sockaddr_un *>(&entry.address);
+        if (backend.size() - 5 >= sizeof(un->sun_path))
+            return false;
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, backend.data() + 5, backend.size() - 5);
+        entry.addressLength = sizeof(sockaddr_un);
+        return true;
+    }
+    size_t colon = backend.rfind(':');
+    if (colon == std::string::npos)
+        return false;
+    sockaddr_in *in = reinterpret_cast<sockaddr_in *>(&entry.address);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(static_cast<uint16_t>(std::atoi(backend.c_str() + colon + 1)));
+    entry.addressLength = sizeof(sockaddr_in);
+    return inet_pton(AF_INET, backend.substr(0, colon).c_str(), &in->sin_addr) == 1;
+}
+
+int ConnectionPool::acquire(std::string const &backend) {
+    BackendMap::iterator it = backends_.find(backend);
+    if (it == backends_.end()) {
+        Backend entry;
+        if (!parseAddress(backend, entry)) {
+            errno = EINVAL;
+            return -1;
+        }
+        it = backends_.insert(std::make_pair(backend, entry)).first;
+    }
+    Backend &entry = it->second;
+
+    while (!entry.idle.empty()) {
+        int fd = entry.idle.back();
+        entry.idle.pop_back();
+        // An idle connection has nothing to read: EOF or data means the backend gave up
+        char c;
+        if (::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) < 0 &&
+            (errno == EAGAIN || errno == EWOULDBLOCK))
+            return fd;
+        ::close(fd);
+    }
+
+    int family = entry.address.ss_family;
+    int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+        return -1;
+    if (family == AF_INET) {
+        int on = 1; // Requests are written whole: do not hold their last segment back
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&entry.address), entry.addressLength) == -1 &&
+        errno != EINPROGRESS) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+void ConnectionPool::release(std::string const &backend, int fd) {
+    BackendMap::iterator it = backends_.find(backend);
+    if (it == backends_.end() || it->second.idle.size() >= MAX_IDLE) {
+        ::close(fd);
+        return;
+    }
+    it->second.idle.push_back(fd);
+}
+
+size_t ConnectionPool::idleCount(std::string const &backend) const {
+    BackendMap::const_iterator it = backends_.find(backend);
+    return it == backends_.end() ? 0 : it->second.idle.size();
+}
+
+void ConnectionPool::clear() {
+    for (BackendMap::iterator it = backends_.begin(); it != backends_.end(); ++it) {
+        for (size_t i = 0; i < it->second.idle.size(); ++i)
+            ::close(it->second.idle[i]);
+        it->second.idle.clear();
+    }
+}
+
+} // namespace fastcgi
+
+// =============================================================================
+// FastCgiBody
+// =============================================================================
+
+FastCgiBody::FastCgiBody(std::string const &backend, int fd,
+                         std::vector<std::string> const &envp, int stdinFd,
+                         bool hasHeaderParsing)
+    : backend_(backend),
+      fd_(fd),
+      stdinFd_(stdinFd),
+      sent_(0),
+      stdinDone_(false),
+      requestSent_(false),
+      isDone_(false),
+      isComplete_(false),
+      hasHeaderParsing_(hasHeaderParsing) {
+    std::vector<char> params;
+    for (size_t i = 0; i < envp.size(); ++i) {
+        std::string const &var = envp[i];
+        size_t eq = var.find('=');
+        if (eq == std::string::npos)
+            continue;
+        fastcgi::appendParam(params, var.data(), eq, var.data() + eq + 1, var.size() - eq - 1);
+    }
+    output_.reserve(fastcgi::HEADER_SIZE * 4 + params.size() + 8);
+    fastcgi::appendBeginRequest(output_);
+    if (!params.empty())
+        fastcgi::appendRecord(output_, fastcgi::PARAMS, &params[0], params.size());
+    fastcgi::appendRecord(output_, fastcgi::PARAMS, NULL, 0);
+}
+
+FastCgiBody::~FastCgiBody() {
+    if (stdinFd_ >= 0)
+        ::close(stdinFd_);
+    if (isComplete_ && requestSent_)
+        fastcgi::ConnectionPool::getInstance().release(backend_, fd_);
+    else
+        ::close(fd_);
+}
+
+bool FastCgiBody::readStdin() {
+    output_.clear();
+    sent_ = 0;
+    char buffer[STDIN_CHUNK_SIZE];
+    ssize_t n = 0;
+    if (stdinFd_ >= 0) {
+        do
+            n = ::read(stdinFd_, buffer, sizeof(buffer));
+        while (n < 0 && errno == EINTR);
+    }
+    if (n < 0) {
+        LOG_ERROR("FastCgiBody: cannot read the request body: " << strerror(errno));
+        return false;
+    }
+    // At the end of the body, this is the empty record that closes the stream
+    fastcgi::appendRecord(output_, fastcgi::STDIN, buffer, static_cast<size_t>(n));
+    stdinDone_ = n == 0;
+    return true;
+}
+
+IResponseBody::RequestStatus FastCgiBody::sendRequest() {
+    while (!requestSent_) {
+        if (sent_ == output_.size()) {
+            if (stdinDone_) {
+                requestSent_ = true;
+                std::vector<char>().swap(output_);
+                break;
+            }
+            if (!readStdin())
+                return REQUEST_FAILED;
+            continue;
+        }
+        ssize_t n = ::send(fd_, &output_[sent_], output_.size() - sent_, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return REQUEST_PENDING;
+            LOG_ERROR("FastCGI backend " << backend_ << ": " << strerror(errno));
+            return REQUEST_FAILED;
+        }
+        sent_ += static_cast<size_t>(n);
+    }
+    return REQUEST_SENT;
+}
+
+ssize_t FastCgiBody::read(char *buffer, size_t size) {
+    while (!isDone_) {
+        ssize_t received = ::recv(fd_, buffer, size, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return -1;
+        if (received <= 0) {
+            LOG_ERROR("FastCGI backend " << backend_ << ": "
+                                         << (received == 0 ? "connection closed"
+                                                           : strerror(errno)));
+            isDone_ = true;
+            return received;
+        }
+
+        // STDOUT slices are moved to the front of the buffer, in place
+        char const *data = buffer;
+        size_t length = static_cast<size_t>(received);
+        size_t output = 0;
+        for (;;) {
+            char const *payload;
+            size_t payloadLength;
+            fastcgi::ResponseDecoder::Event event =
+                decoder_.next(data, length, payload, payloadLength);
+            if (event == fastcgi::ResponseDecoder::OUTPUT) {
+                std::memmove(buffer + output, payload, payloadLength);
+                output += payloadLength;
+            } else if (event == fastcgi::ResponseDecoder::ERROR_OUTPUT) {
+                LOG_WARN("FastCGI backend " << backend_
+                                            << ": stderr: " << std::string(payload, payloadLength));
+            } else if (event == fastcgi::ResponseDecoder::END) {
+                isComplete_ = length == 0;
+                isDone_ = true;
+                break;
+            } else if (event == fastcgi::ResponseDecoder::INVALID) {
+                LOG_ERROR("FastCGI backend " << backend_ << ": invalid record");
+                isDone_ = true;
+                break;
+            } else {
+                break;
+            }
+        }
+        if (output > 0)
+            return static_cast<ssize_t>(output);
+    }
+    return 0;
+}
+
+size_t FastCgiBody::size() const { return 0; }
+bool FastCgiBody::isDone() const { return isDone_; }
+int FastCgiBody::getEventSourceFd() const { return fd_; }
+bool FastCgiBody::hasHeaderParsing() const { return hasHeaderParsing_; }
+
+} // namespace http
@@ -73,8 +73,14 @@ UploadValidationResult parseFilename(Request const &req, MimeTypes const &) {
         return UploadValidationResult::fail(
             BAD_REQUEST, "Missing filename (X-Filename, Content-Disposition, or URI path)");
     }
+    return validateFilename(filename);
+}
+
+UploadValidationResult validateFilename(std::string const &filename) {
+    if (filename.empty())
+        return UploadValidationResult::fail(BAD_REQUEST, "Missing filename");
 
-    // 3. Security & Validity Sanitization
+    // Security & Validity Sanitization
     // Prevent directory traversal
     if (filename.find('/') != std::string::npos || filename.find('\\') != std::string::npos ||
         filename.find("..") != std::string::npos) {
@@ -92,15 +98,8 @@ UploadValidationResult parseFilename(Request const &req, MimeTypes const &) {
         return UploadValidationResult::fail(BAD_REQUEST, "Invalid filename: trailing dot");
     }
 
-    // 4. Content-Type check (Advisory)
-    // We don't strictly enforce mime-match here anymore as it prevents valid raw uploads
-    // from tools that don't know the mime type (like simple curl).
-    std::string contentType = req.headers().get("Content-Type");
-    if (contentType.find("multipart/form-data") != std::string::npos) {
-        return UploadValidationResult::fail(NOT_IMPLEMENTED,
-                                            "multipart/form-data not yet supported");
-    }
-
+    // No Content-Type check: it would reject valid raw uploads from tools that don't
+    // know the mime type (like simple curl)
     return UploadValidationResult::ok(filename);
 }
 
@@ -0,0 +1,87 @@
+#include "http/HeaderNames.hpp"
+
+namespace http {
+
+namespace header {
+
+namespace {
+
+// In Id order, in the case they are sent in
+char const *const NAMES[COUNT] = {
+    "Accept",          "Accept-Charset",     "Accept-Encoding",     "Accept-Language",
+    "Accept-Ranges",   "Age",                "Allow",               "Authorization",
+    "Cache-Control",   "Connection",         "Content-Disposition", "Content-Encoding",
+    "Content-Language", "Content-Length",    "Content-Location",    "Content-Range",
+    "Content-Type",    "Cookie",             "Date",                "ETag",
+    "Expect",          "Expires",            "Forwarded",           "Host",
+    "If-Match",        "If-Modified-Since",  "If-None-Match",       "If-Range",
+    "If-Unmodified-Since", "Keep-Alive",     "Last-Modified",       "Location",
+    "Origin",          "Pragma",             "Range",               "Referer",
+    "Retry-After",     "Server",             "Set-Cookie",          "Status",
+    "TE",              "Trailer",            "Transfer-Encoding",   "Upgrade",
+    "User-Agent",      "Vary",               "Via",                 "WWW-Authenticate",
+    "X-Filename",      "X-Forwarded-For"};
+
+const size_t TABLE_SIZE = 128;
+
+inline unsigned char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : static_cast<unsigned char>(c);
+}
+
+/**
+ * The multipliers were found by search so that every name in NAMES gets a slot of its
+ * own (tests/http/HeadersTest.cpp checks it); adding a name may require new ones.
+ */
+inline size_t hash(char const *name, size_t length) {
+    return (length * 11 + lower(name[0]) * 28 + lower(name[length - 1]) * 22 +
+            lower(name[length / 2])) &
+           (TABLE_SIZE - 1);
+}
+
+struct Table {
+    Id slots[TABLE_SIZE];
+    std::string names[COUNT];
+    std::string canonicalNames[COUNT];
+
+    Table() {
+        for (size_t i = 0; i < TABLE_SIZE; ++i)
+            slots[i] = UNKNOWN;
+        for (int id = 0; id < COUNT; ++id) {
+            canonicalNames[id] = NAMES[id];
+            names[id] = NAMES[id];
+            for (size_t i = 0; i < names[id].size(); ++i)
+                names[id][i] = lower(names[id][i]);
+            slots[hash(NAMES[id], names[id].size())] = static_cast<Id>(id);
+        }
+    }
+};
+
+Table const &table() {
+    static Table const instance;
+    return instance;
+}
+
+} // namespace
+
+Id lookup(char const *name, size_t length) {
+    if (length == 0)
+        return UNKNOWN;
+    Table const &t = table();
+    Id id = t.slots[hash(name, length)];
+    if (id == UNKNOWN || t.names[id].size() != length)
+        return UNKNOWN;
+    char const *known = t.names[id].data();
+    for (size_t i = 0; i < length; ++i) {
+        if (lower(name[i]) != static_cast<unsigned char>(known[i]))
+            return UNKNOWN;
+    }
+    return id;
+}
+
+std::string const &name(Id id) { return table().names[id]; }
+
+std::string const &canonicalName(Id id) { return table().canonicalNames[id]; }
+
+} // namespace header
+
+} // namespace http
@@ -1,49 +1,233 @@
 #include "http/Headers.hpp"
 #include "common/string.hpp"
+#include "http/internal/ByteScan.hpp"
+#include "utils/InputBuffer.hpp"
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <sstream>
 
 namespace http {
 
-Headers::Headers() {}
+namespace {
 
-void Headers::normalizeKey(std::string &key) {
-    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+/** @brief Compares @p length bytes, @p b being lowercase. */
+bool equalsLowercase(char const *a, char const *b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != static_cast<unsigned char>(b[i]))
+            return false;
+    }
+    return true;
 }
 
-std::string Headers::normalizeKey(std::string const &key) {
-    std::string res = key;
-    normalizeKey(res);
-    return res;
+bool equalsIgnoreCase(char const *a, char const *b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
+}
+
+/** @brief Parses a Content-Length value: digits only, without overflow. */
+bool parseLength(char const *value, size_t size, size_t &length) {
+    static size_t const max = static_cast<size_t>(-1);
+    if (size == 0)
+        return false;
+    length = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (value[i] < '0' || value[i] > '9')
+            return false;
+        size_t digit = value[i] - '0';
+        if (length > (max - digit) / 10)
+            return false;
+        length = length * 10 + digit;
+    }
+    return true;
+}
+
+void swapFields(Headers::Field &a, Headers::Field &b) {
+    std::swap(a.id, b.id);
+    a.name.swap(b.name);
+    a.value.swap(b.value);
+}
+
+} // namespace
+
+Headers::Headers() : count_(0), rawBuffer_(NULL) { std::memset(slots_, 0, sizeof(slots_)); }
+
+Headers::Headers(Headers const &other) : count_(0), rawBuffer_(NULL) {
+    std::memset(slots_, 0, sizeof(slots_));
+    setAll(other);
+}
+
+Headers &Headers::operator=(Headers const &other) {
+    if (this != &other) {
+        clear();
+        setAll(other);
+    }
+    return *this;
+}
+
+void Headers::setAll(Headers const &other) {
+    if (other.rawBuffer_) {
+        char const *data = other.rawBuffer_->data();
+        for (size_t i = 0; i < other.raw_.size(); ++i) {
+            RawField const &f = other.raw_[i];
+            set(f.id, data + f.nameOffset, f.nameLength, data + f.valueOffset, f.valueLength);
+        }
+        return;
+    }
+    for (size_t i = 0; i < other.count_; ++i) {
+        Field const &f = other.fields_[i];
+        set(f.id, f.name.data(), f.name.size(), f.value.data(), f.value.size());
+    }
+}
+
+Headers &Headers::assignRaw(utils::InputBuffer const &buffer, RawFields &fields) {
+    clear();
+    raw_.swap(fields);
+    rawBuffer_ = &buffer;
+    char const *data = buffer.data();
+    for (size_t i = 0; i < raw_.size(); ++i) {
+        raw_[i].id = header::lookup(data + raw_[i].nameOffset, raw_[i].nameLength);
+        if (raw_[i].id != header::UNKNOWN)
+            slots_[raw_[i].id] = i + 1; // The last one wins
+    }
+    return *this;
+}
+
+size_t Headers::indexOf(header::Id id, char const *key, size_t length) const {
+    if (id != header::UNKNOWN)
+        return slots_[id] ? slots_[id] - 1 : NPOS;
+    if (rawBuffer_) {
+        for (size_t i = raw_.size(); i-- > 0;) {
+            RawField const &field = raw_[i];
+            if (field.id == header::UNKNOWN && field.nameLength == length &&
+                equalsIgnoreCase(rawBuffer_->data() + field.nameOffset, key, length))
+                return i;
+        }
+        return NPOS;
+    }
+    for (size_t i = 0; i < count_; ++i) {
+        Field const &field = fields_[i];
+        if (field.id == header::UNKNOWN && field.name.size() == length &&
+            equalsLowercase(key, field.name.data(), length))
+            return i;
+    }
+    return NPOS;
+}
+
+void Headers::set(header::Id id, char const *name, size_t nameLength, char const *value,
+                  size_t valueLength) const {
+    size_t i = indexOf(id, name, nameLength);
+    if (i == NPOS) {
+        if (count_ == fields_.size())
+            fields_.push_back(Field());
+        i = count_++;
+        Field &field = fields_[i];
+        field.id = id;
+        if (id != header::UNKNOWN) {
+            field.name = header::name(id);
+            slots_[id] = i + 1;
+        } else {
+            field.name.assign(name, nameLength);
+            for (size_t j = 0; j < nameLength; ++j)
+                field.name[j] = std::tolower(static_cast<unsigned char>(field.name[j]));
+        }
+    }
+    fields_[i].value.assign(value, valueLength);
+}
+
+void Headers::removeAt(size_t index) {
+    header::Id id = fields_[index].id;
+    // Bubble the field to the spares, keeping the order of the others
+    for (size_t i = index; i + 1 < count_; ++i) {
+        swapFields(fields_[i], fields_[i + 1]);
+        if (fields_[i].id != header::UNKNOWN)
+            slots_[fields_[i].id] = i + 1;
+    }
+    if (id != header::UNKNOWN)
+        slots_[id] = 0;
+    --count_;
+}
+
+void Headers::materialize() const {
+    if (!rawBuffer_)
+        return;
+    char const *data = rawBuffer_->data();
+    rawBuffer_ = NULL;
+    std::memset(slots_, 0, sizeof(slots_));
+    for (size_t i = 0; i < raw_.size(); ++i) {
+        RawField const &f = raw_[i];
+        set(f.id, data + f.nameOffset, f.nameLength, data + f.valueOffset, f.valueLength);
+    }
+    raw_.clear();
 }
 
 Headers &Headers::add(std::string const &key, std::string const &value) {
     if (key.empty())
         return *this;
-    map_[normalizeKey(key)] = value;
+    materialize();
+    set(header::lookup(key), key.data(), key.size(), value.data(), value.size());
     return *this;
 }
 
-bool Headers::get(std::string const &key, std::string &value) const {
-    HeaderMap::const_iterator it = map_.find(normalizeKey(key));
-    if (it == map_.end())
+Headers &Headers::add(header::Id id, std::string const &value) {
+    materialize();
+    set(id, NULL, 0, value.data(), value.size());
+    return *this;
+}
+
+bool Headers::valueAt(size_t index, std::string &value) const {
+    if (index == NPOS)
         return false;
-    value = it->second;
+    if (rawBuffer_)
+        value.assign(rawBuffer_->data() + raw_[index].valueOffset, raw_[index].valueLength);
+    else
+        value = fields_[index].value;
     return true;
 }
 
+bool Headers::get(std::string const &key, std::string &value) const {
+    return valueAt(indexOf(header::lookup(key), key.data(), key.size()), value);
+}
+
+bool Headers::get(header::Id id, std::string &value) const {
+    return valueAt(indexOf(id, NULL, 0), value);
+}
+
 std::string Headers::get(std::string const &key) const {
     std::string res;
     get(key, res);
     return res;
 }
 
-size_t Headers::getContentLength() const {
-    static const std::string key = normalizeKey("content-length");
-    HeaderMap::const_iterator it = map_.find(key);
-    if (it == map_.end())
-        return 0;
-    return std::strtol(it->second.c_str(), NULL, 10);
+std::string Headers::get(header::Id id) const {
+    std::string res;
+    get(id, res);
+    return res;
+}
+
+bool Headers::getContentLength(size_t &length) const {
+    length = 0;
+    if (!rawBuffer_) {
+        size_t i = indexOf(header::CONTENT_LENGTH, NULL, 0);
+        return i == NPOS || parseLength(fields_[i].value.data(), fields_[i].value.size(), length);
+    }
+    // Every field counts here, not only the last one: a proxy may have used another
+    bool isFound = false;
+    for (size_t i = 0; i < raw_.size(); ++i) {
+        if (raw_[i].id != header::CONTENT_LENGTH)
+            continue;
+        size_t value;
+        if (!parseLength(rawBuffer_->data() + raw_[i].valueOffset, raw_[i].valueLength, value) ||
+            (isFound && value != length))
+            return false;
+        length = value;
+        isFound = true;
+    }
+    return true;
 }
 
 bool Headers::parse(std::istringstream &s, Headers &res, bool strict) {
@@ -80,52 +264,106 @@ bool Headers::parse(std::string &buffer, Headers &headers, bool strict) {
 }
 
 bool Headers::isContentChunked() const {
-    std::string value;
     // TODO: add parsing to check if chunked exists there
-    if (!get("Transfer-Encoding", value))
-        return false;
-    return true;
+    return has(header::TRANSFER_ENCODING);
 }
 
 Headers &Headers::clear() {
-    map_.clear();
+    count_ = 0;
+    std::memset(slots_, 0, sizeof(slots_));
+    raw_.clear();
+    rawBuffer_ = NULL;
     return *this;
 }
 
 Headers &Headers::erase(std::string const &key) {
-    map_.erase(normalizeKey(key));
+    materialize();
+    size_t i = indexOf(header::lookup(key), key.data(), key.size());
+    if (i != NPOS)
+        removeAt(i);
     return *this;
 }
 
-std::string Headers::toString() const {
-    std::ostringstream oss;
+Headers &Headers::erase(header::Id id) {
+    materialize();
+    size_t i = indexOf(id, NULL, 0);
+    if (i != NPOS)
+        removeAt(i);
+    return *this;
+}
 
-    for (HeaderMap::const_iterator it = map_.begin(); it != map_.end(); ++it) {
-        oss << it->first << ": " << it->second << "\r\n";
+size_t Headers::size() const {
+    materialize();
+    return count_;
+}
+
+void Headers::appendTo(std::vector<char> &buffer) const {
+    materialize();
+    for (size_t i = 0; i < count_; ++i) {
+        Field const &field = fields_[i];
+        if (field.id != header::UNKNOWN) {
+            std::string const &name = header::canonicalName(field.id);
+            buffer.insert(buffer.end(), name.begin(), name.end());
+        } else {
+            // Capitalize each word of the lowercase name: "x-powered-by" -> "X-Powered-By"
+            size_t start = buffer.size();
+            buffer.insert(buffer.end(), field.name.begin(), field.name.end());
+            for (size_t j = start; j < buffer.size(); ++j) {
+                if ((j == start || buffer[j - 1] == '-') && buffer[j] >= 'a' && buffer[j] <= 'z')
+                    buffer[j] = buffer[j] - 'a' + 'A';
+            }
+        }
+        buffer.push_back(':');
+        buffer.push_back(' ');
+        buffer.insert(buffer.end(), field.value.begin(), field.value.end());
+        buffer.push_back('\r');
+        buffer.push_back('\n');
     }
-    return oss.str();
 }
 
-Headers::HeaderMap const &Headers::getMap() const { return map_; }
-bool Headers::has(std::string const &key) const { return map_.count(normalizeKey(key)); }
-Headers::const_iterator Headers::begin() const { return map_.begin(); }
-Headers::const_iterator Headers::end() const { return map_.end(); }
+std::string Headers::toString() const {
+    std::vector<char> buffer;
+    appendTo(buffer);
+    return std::string(buffer.begin(), buffer.end());
+}
+
+bool Headers::has(std::string const &key) const {
+    return indexOf(header::lookup(key), key.data(), key.size()) != NPOS;
+}
+
+bool Headers::has(header::Id id) const { return indexOf(id, NULL, 0) != NPOS; }
+
+Headers::const_iterator Headers::begin() const {
+    materialize();
+    return fields_.begin();
+}
+
+Headers::const_iterator Headers::end() const {
+    materialize();
+    return fields_.begin() + count_;
+}
 
 Headers::const_iterator Headers::find(std::string const &key) const {
-    return map_.find(normalizeKey(key));
+    materialize();
+    size_t i = indexOf(header::lookup(key), key.data(), key.size());
+    return i == NPOS ? end() : begin() + i;
 }
 
 size_t Headers::findHeaderEnd(const std::string &buffer, size_t &offset) {
-    for (size_t i = 0; i < buffer.size(); ++i) {
-        if (buffer[i] == '\n') {
-            if (i + 1 < buffer.size() && buffer[i + 1] == '\n') {
-                offset = (i > 0 && buffer[i - 1] == '\r') ? 3 : 2;
-                return (i > 0 && buffer[i - 1] == '\r') ? i - 1 : i;
-            }
-            if (i + 2 < buffer.size() && buffer[i + 1] == '\r' && buffer[i + 2] == '\n') {
-                offset = (i > 0 && buffer[i - 1] == '\r') ? 4 : 3;
-                return (i > 0 && buffer[i - 1] == '\r') ? i - 1 : i;
-            }
+    char const *data = buffer.data();
+    size_t size = buffer.size();
+    // Only line breaks matter: jump from one control character to the next
+    for (size_t i = scan::findControl(data, size); i < size;
+         i += 1 + scan::findControl(data + i + 1, size - i - 1)) {
+        if (data[i] != '\n')
+            continue;
+        if (i + 1 < size && data[i + 1] == '\n') {
+            offset = (i > 0 && data[i - 1] == '\r') ? 3 : 2;
+            return (i > 0 && data[i - 1] == '\r') ? i - 1 : i;
+        }
+        if (i + 2 < size && data[i + 1] == '\r' && data[i + 2] == '\n') {
+            offset = (i > 0 && data[i - 1] == '\r') ? 4 : 3;
+            return (i > 0 && data[i - 1] == '\r') ? i - 1 : i;
         }
     }
     return std::string::npos;
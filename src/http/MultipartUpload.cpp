@@ -0,0 +1,85 @@
+#include "http/MultipartUpload.hpp"
+#include "http/FileUploadValidator.hpp"
+#include "utils/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+
+namespace http {
+
+MultipartUpload::MultipartUpload(std::string const &boundary, std::string const &directory)
+    : parser_(boundary, *this), directory_(directory), writing_(false), ioFailed_(false),
+      errorStatus_(OK) {}
+
+MultipartUpload::~MultipartUpload() {
+    for (size_t i = 0; i < files_.size(); ++i)
+        delete files_[i].file; // Removes the files that were not stored
+}
+
+bool MultipartUpload::feed(char const *data, size_t size) {
+    parser_.feed(data, size);
+    return !ioFailed_;
+}
+
+bool MultipartUpload::complete() const {
+    return parser_.status() == MultipartParser::PARSE_DONE && errorStatus_ == OK;
+}
+
+HttpStatus MultipartUpload::errorStatus() const {
+    if (errorStatus_ != OK)
+        return errorStatus_;
+    return parser_.status() == MultipartParser::PARSE_ERROR ? parser_.errorStatus() : BAD_REQUEST;
+}
+
+std::string const &MultipartUpload::errorMessage() const {
+    static const std::string malformed = "Malformed multipart/form-data body";
+    return errorStatus_ != OK ? errorMessage_ : malformed;
+}
+
+std::vector<MultipartUpload::File> const &MultipartUpload::files() const { return files_; }
+
+bool MultipartUpload::onPartBegin(MultipartPart const &part) {
+    writing_ = part.hasFilename && !part.filename.empty();
+    if (!writing_)
+        return true; // A plain field, or a file input left empty
+    upload::UploadValidationResult name = upload::validateFilename(part.filename);
+    if (!name.result)
+        return reject(name.status, name.message);
+    if (files_.size() == MAX_FILES)
+        return reject(PAYLOAD_TOO_LARGE, "Too many files in one upload");
+
+    File file;
+    file.filename = part.filename;
+    file.file = new utils::TempFile;
+    files_.push_back(file);
+    if (!file.file->open(directory_)) {
+        ioFailed_ = true;
+        return reject(INTERNAL_SERVER_ERROR, "Failed to write uploaded file to disk");
+    }
+    LOG_SDEBUG("multipart file \"" << part.filename << "\" -> " << file.file->path());
+    return true;
+}
+
+bool MultipartUpload::onPartData(char const *data, size_t size) {
+    if (!writing_)
+        return true;
+    if (!utils::writeAll(files_.back().file->fd(), data, size)) {
+        LOG_SERROR("write to " << files_.back().file->path() << " failed: " << strerror(errno));
+        ioFailed_ = true;
+        return reject(INTERNAL_SERVER_ERROR, "Failed to write uploaded file to disk");
+    }
+    return true;
+}
+
+bool MultipartUpload::onPartEnd() {
+    writing_ = false;
+    return true;
+}
+
+bool MultipartUpload::reject(HttpStatus status, std::string const &message) {
+    errorStatus_ = status;
+    errorMessage_ = message;
+    writing_ = false;
+    return false;
+}
+
+} // namespace http
@@ -0,0 +1,189 @@
+#include "http/OpenFileCache.hpp"
+#include "utils/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <vector>
+
+namespace http {
+
+namespace {
+const uint32_t WATCH_MASK =
+    IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+} // namespace
+
+OpenFileCache &OpenFileCache::getInstance() {
+    static OpenFileCache instance;
+    return instance;
+}
+
+OpenFileCache::OpenFileCache() : maxEntries_(0), validity_(0), inotifyFd_(-1) {}
+
+OpenFileCache::~OpenFileCache() {
+    clear();
+    if (inotifyFd_ != -1)
+        close(inotifyFd_);
+}
+
+void OpenFileCache::configure(size_t maxEntries, time_t validity) {
+    clear();
+    maxEntries_ = maxEntries;
+    validity_ = validity;
+    if (inotifyFd_ != -1) {
+        close(inotifyFd_);
+        inotifyFd_ = -1;
+    }
+    if (!maxEntries_)
+        return;
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ == -1) {
+        LOG_WARN("OpenFileCache: inotify unavailable (" << strerror(errno)
+                                                        << "), relying on validity only");
+    }
+    LOG_DEBUG("OpenFileCache: max=" << maxEntries_ << " valid=" << validity_ << "s");
+}
+
+bool OpenFileCache::enabled() const { return maxEntries_ > 0; }
+size_t OpenFileCache::size() const { return entries_.size(); }
+int OpenFileCache::watchFd() const { return inotifyFd_; }
+
+OpenFileCache::Entry *OpenFileCache::acquire(std::string const &path) {
+    if (!enabled())
+        return load(path);
+
+    EntryMap::iterator it = entries_.find(path);
+    if (it != entries_.end()) {
+        Entry *entry = it->second;
+        if (entry->expiresAt > time(NULL)) {
+            lru_.splice(lru_.begin(), lru_, entry->lruPos);
+            entry->refs++;
+            return entry;
+        }
+        invalidate(entry);
+    }
+
+    Entry *entry = load(path);
+    if (entry)
+        insert(entry);
+    return entry;
+}
+
+void OpenFileCache::release(Entry *entry) {
+    if (!entry)
+        return;
+    if (--entry->refs == 0 && !entry->cached)
+        destroy(entry);
+}
+
+void OpenFileCache::processEvents() {
+    if (inotifyFd_ == -1)
+        return;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(inotifyFd_, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len;) {
+            struct inotify_event const *ev = reinterpret_cast<struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            std::pair<WatchMap::iterator, WatchMap::iterator> range = watches_.equal_range(ev->wd);
+            std::vector<Entry *> stale;
+            for (WatchMap::iterator it = range.first; it != range.second; ++it)
+                stale.push_back(it->second);
+            for (size_t i = 0; i < stale.size(); ++i) {
+                LOG_TRACE("OpenFileCache: " << stale[i]->path << " changed, invalidating");
+                if (ev->mask & IN_IGNORED) // The kernel already dropped the watch
+                    stale[i]->wd = -1;
+                invalidate(stale[i]);
+            }
+            if (ev->mask & IN_IGNORED)
+                watches_.erase(ev->wd);
+        }
+    }
+}
+
+void OpenFileCache::clear() {
+    while (!lru_.empty())
+        invalidate(lru_.back());
+}
+
+OpenFileCache::Entry *OpenFileCache::load(std::string const &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return NULL;
+
+    int fd = -1;
+    if (S_ISREG(st.st_mode)) {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return NULL;
+    }
+
+    Entry *entry = new Entry;
+    entry->path = path;
+    entry->fd = fd;
+    entry->st = st;
+    entry->expiresAt = time(NULL) + validity_;
+    entry->wd = -1;
+    entry->refs = 1;
+    entry->cached = false;
+    return entry;
+}
+
+void OpenFileCache::insert(Entry *entry) {
+    while (entries_.size() >= maxEntries_ && !lru_.empty())
+        invalidate(lru_.back());
+
+    if (inotifyFd_ != -1) {
+        entry->wd = inotify_add_watch(inotifyFd_, entry->path.c_str(), WATCH_MASK);
+        if (entry->wd == -1) {
+            LOG_DEBUG("OpenFileCache: inotify_add_watch(" << entry->path
+                                                          << "): " << strerror(errno));
+        } else {
+            watches_.insert(std::make_pair(entry->wd, entry));
+        }
+    }
+    entries_[entry->path] = entry;
+    lru_.push_front(entry);
+    entry->lruPos = lru_.begin();
+    entry->cached = true;
+}
+
+void OpenFileCache::invalidate(Entry *entry) {
+    if (!entry->cached)
+        return;
+    unwatch(entry);
+    entries_.erase(entry->path);
+    lru_.erase(entry->lruPos);
+    entry->cached = false;
+    if (entry->refs == 0)
+        destroy(entry);
+}
+
+void OpenFileCache::unwatch(Entry *entry) {
+    if (entry->wd == -1)
+        return;
+    bool shared = false;
+    std::pair<WatchMap::iterator, WatchMap::iterator> range = watches_.equal_range(entry->wd);
+    for (WatchMap::iterator it = range.first; it != range.second;) {
+        if (it->second == entry)
+            watches_.erase(it++);
+        else {
+            shared = true;
+            ++it;
+        }
+    }
+    // Hard links to the same inode share a watch descriptor.
+    if (!shared)
+        inotify_rm_watch(inotifyFd_, entry->wd);
+    entry->wd = -1;
+}
+
+void OpenFileCache::destroy(Entry *entry) {
+    if (entry->fd != -1)
+        close(entry->fd);
+    delete entry;
+}
+
+} // namespace http
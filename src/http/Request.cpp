@@ -2,48 +2,48 @@
 #include "common/filesystem.hpp"
 #include "config/LocationBlock.hpp"
 #include "config/ServerBlock.hpp"
-#include <sstream>
+#include <cstring>
 
 namespace http {
 
 RequestStartLine::RequestStartLine() : method(RequestStartLine::UNKNOWN), version("HTTP/1.1") {}
 
-RequestStartLine RequestStartLine::parse(std::string const &line) {
-    RequestStartLine rsl;
-    std::istringstream iss(line);
-    std::string methodStr;
-
-    if (!(iss >> methodStr >> rsl.uri >> rsl.version)) {
-        rsl.method = UNKNOWN;
-        return rsl;
+void RequestStartLine::setTarget(char const *target, size_t length) {
+    uri.assign(target, length);
+    void const *query = std::memchr(target, '?', length);
+    if (!query) {
+        path = uri;
+        queryString.clear();
+        return;
     }
-
-    rsl.method = matchHttpMethod(methodStr);
-
-    size_t queryPos = rsl.uri.find('?');
-
-    if (queryPos == std::string::npos) {
-        rsl.path = rsl.uri;
-        rsl.queryString = "";
-    } else {
-        rsl.path = rsl.uri.substr(0, queryPos);
-        rsl.queryString = rsl.uri.substr(queryPos + 1);
-    }
-
-    return rsl;
+    size_t pathLength = static_cast<char const *>(query) - target;
+    path.assign(target, pathLength);
+    queryString.assign(target + pathLength + 1, length - pathLength - 1);
 }
 
 RequestStartLine::Method RequestStartLine::matchHttpMethod(std::string const &s) {
-    if (s == "GET")
-        return GET;
-    if (s == "POST")
-        return POST;
-    if (s == "PUT")
-        return PUT;
-    if (s == "DELETE")
-        return DELETE;
-    if (s == "HEAD")
-        return HEAD;
+    return matchHttpMethod(s.data(), s.size());
+}
+
+RequestStartLine::Method RequestStartLine::matchHttpMethod(char const *s, size_t length) {
+    switch (length) {
+    case 3:
+        if (std::memcmp(s, "GET", 3) == 0)
+            return GET;
+        if (std::memcmp(s, "PUT", 3) == 0)
+            return PUT;
+        break;
+    case 4:
+        if (std::memcmp(s, "POST", 4) == 0)
+            return POST;
+        if (std::memcmp(s, "HEAD", 4) == 0)
+            return HEAD;
+        break;
+    case 6:
+        if (std::memcmp(s, "DELETE", 6) == 0)
+            return DELETE;
+        break;
+    }
     return RequestStartLine::UNKNOWN;
 }
 
@@ -64,11 +64,13 @@ char const *RequestStartLine::methodToString(Method m) {
     }
 }
 
-Request::Request() : body_(NULL), location_(NULL), server_(NULL), status_(OK), remoteAddr_("") {}
+Request::Request()
+    : body_(NULL), location_(NULL), server_(NULL), status_(OK), remoteAddr_(""),
+      pipesBody_(false) {}
 
 Request::~Request() { delete body_; }
 
-bool Request::wantsJson() const { return headers_.get("Accept") == "application/json"; }
+bool Request::wantsJson() const { return headers_.get(header::ACCEPT) == "application/json"; }
 
 void Request::clear() {
     headers_.clear();
@@ -82,6 +84,8 @@ void Request::clear() {
     delete body_;
     body_ = NULL;
     remoteAddr_.clear();
+    uploadDirectory_.clear();
+    pipesBody_ = false;
 }
 
 size_t Request::getMaxAllowedContentSize() const {
@@ -96,6 +100,24 @@ size_t Request::getMaxAllowedContentSize() const {
     return limit;
 }
 
+size_t Request::getBodyBufferSize() const {
+    if (location_ && location_->has("client_body_buffer_size"))
+        return location_->bodyBufferSize();
+    if (server_ && server_->has("client_body_buffer_size"))
+        return server_->bodyBufferSize();
+    return 16 * 1024;
+}
+
+std::string Request::getBodyTempPath() const {
+    if (!uploadDirectory_.empty())
+        return uploadDirectory_;
+    if (location_ && location_->has("client_body_temp_path"))
+        return location_->getFirstRawValue("client_body_temp_path");
+    if (server_ && server_->has("client_body_temp_path"))
+        return server_->getFirstRawValue("client_body_temp_path");
+    return "/tmp";
+}
+
 // clang-format off
 config::LocationBlock const *Request::location() const { return location_; }
 config::ServerBlock const *Request::server() const { return server_; }
@@ -114,9 +136,9 @@ Request &Request::uri(std::string const &uri) {requestLine_.uri = uri;return *th
 Request &Request::version(std::string const &version) {requestLine_.version= version;return *this;}
 Request &Request::status(HttpStatus statusCode) { status_ = statusCode; return *this; }
 HttpStatus Request::status() const { return status_; }
-utils::TempFile const *Request::body() const { return body_; }
-utils::TempFile *Request::body() { return body_; }
-Request &Request::body(utils::TempFile *body) {
+RequestBody const *Request::body() const { return body_; }
+RequestBody *Request::body() { return body_; }
+Request &Request::body(RequestBody *body) {
     if (body_ != body) {
         delete body_;
         body_ = body;
@@ -135,6 +157,8 @@ utils::TempFile::MoveStatus Request::moveBody(const std::string &destPath) const
 }
 std::string const &Request::remoteAddr() const { return remoteAddr_; }
 Request &Request::remoteAddr(std::string const &addr) { remoteAddr_ = addr; return *this; }
+Request &Request::uploadDirectory(std::string const &dir) { uploadDirectory_ = dir; return *this; }
+Request &Request::pipesBody(bool pipes) { pipesBody_ = pipes; return *this; }
 // clang-format on
 
 std::string Request::resolvePath() const {
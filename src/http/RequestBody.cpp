@@ -0,0 +1,167 @@
+#include "http/RequestBody.hpp"
+#include "http/BodyPipe.hpp"
+#include "http/MultipartUpload.hpp"
+#include "utils/BufferPool.hpp"
+#include "utils/Logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace http {
+
+namespace {
+
+/** @brief A pipe holding @p data, or -1 if it does not fit in the pipe's buffer. */
+int pipeReader(std::string const &data) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1)
+        return -1;
+    int capacity = fcntl(fds[1], F_GETPIPE_SZ);
+    if (capacity < 0 || data.size() > static_cast<size_t>(capacity) ||
+        !utils::writeAll(fds[1], data.data(), data.size())) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+int memfdReader(std::string const &data) {
+    int fd = memfd_create("webserv-request-body", MFD_CLOEXEC);
+    if (fd == -1)
+        return -1;
+    if (!utils::writeAll(fd, data.data(), data.size()) || lseek(fd, 0, SEEK_SET) == (off_t)-1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+RequestBody::RequestBody(size_t memoryLimit, std::string const &tempDirectory)
+    : memoryLimit_(memoryLimit), tempDirectory_(tempDirectory), multipart_(NULL), pipe_(NULL),
+      ownsPipe_(false), size_(0) {}
+
+RequestBody::~RequestBody() {
+    delete multipart_;
+    if (ownsPipe_)
+        delete pipe_;
+    utils::BufferPool<std::string>::getInstance().release(memory_);
+}
+
+bool RequestBody::append(char const *data, size_t size) {
+    if (!size)
+        return true;
+    if (multipart_) {
+        size_ += size;
+        return multipart_->feed(data, size);
+    }
+    if (pipe_) {
+        size_ += size;
+        pipe_->write(data, size);
+        return true;
+    }
+    if (!file_.isOpen() && size_ + size <= memoryLimit_) {
+        if (memory_.capacity() == 0) {
+            size_t initialCapacity = std::min<size_t>(memoryLimit_, 16384);
+            utils::BufferPool<std::string>::getInstance().acquire(memory_, initialCapacity);
+        }
+        memory_.append(data, size);
+        size_ += size;
+        return true;
+    }
+    if (!file_.isOpen() && !spill())
+        return false;
+    if (!utils::writeAll(file_.fd(), data, size)) {
+        LOG_SERROR("write to " << file_.path() << " failed: " << strerror(errno));
+        return false;
+    }
+    size_ += size;
+    return true;
+}
+
+bool RequestBody::spill() {
+    if (file_.isOpen())
+        return true;
+    if (!file_.open(tempDirectory_))
+        return false;
+    LOG_SDEBUG("body of " << size_ << "+ bytes spills to " << file_.path());
+    if (!utils::writeAll(file_.fd(), memory_.data(), memory_.size())) {
+        LOG_SERROR("write to " << file_.path() << " failed: " << strerror(errno));
+        return false;
+    }
+    utils::BufferPool<std::string>::getInstance().release(memory_);
+    return true;
+}
+
+void RequestBody::addWritten(size_t size) { size_ += size; }
+
+void RequestBody::streamTo(MultipartUpload *upload) {
+    delete multipart_;
+    multipart_ = upload;
+}
+
+MultipartUpload *RequestBody::multipart() const { return multipart_; }
+
+void RequestBody::streamTo(BodyPipe *pipe) {
+    if (ownsPipe_)
+        delete pipe_;
+    pipe_ = pipe;
+    ownsPipe_ = true;
+}
+
+BodyPipe *RequestBody::pipe() const { return pipe_; }
+
+BodyPipe *RequestBody::releasePipe() {
+    ownsPipe_ = false;
+    return pipe_;
+}
+
+size_t RequestBody::size() const { return size_; }
+
+bool RequestBody::inMemory() const { return !file_.isOpen(); }
+
+std::string const &RequestBody::data() const { return memory_; }
+
+int RequestBody::fd() const { return file_.isOpen() ? file_.fd() : -1; }
+
+std::string const &RequestBody::path() const { return file_.path(); }
+
+bool RequestBody::rewind() {
+    return !file_.isOpen() || lseek(file_.fd(), 0, SEEK_SET) != (off_t)-1;
+}
+
+int RequestBody::openReader() const {
+    if (file_.isOpen())
+        return fcntl(file_.fd(), F_DUPFD_CLOEXEC, 0);
+    int fd = pipeReader(memory_);
+    return fd != -1 ? fd : memfdReader(memory_);
+}
+
+utils::TempFile::MoveStatus RequestBody::moveTo(std::string const &destPath) {
+    if (file_.isOpen())
+        return file_.moveTo(destPath);
+
+    // Same permissions as a renamed mkstemp() file
+    int fd = ::open(destPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        LOG_SERROR("open(" << destPath << ") failed: " << strerror(errno));
+        return utils::TempFile::MOVE_IO_ERR;
+    }
+    bool ok = utils::writeAll(fd, memory_.data(), memory_.size());
+    if (::close(fd) == -1)
+        ok = false;
+    if (!ok) {
+        LOG_SERROR("write to " << destPath << " failed: " << strerror(errno));
+        unlink(destPath.c_str());
+        return utils::TempFile::MOVE_IO_ERR;
+    }
+    return utils::TempFile::MOVE_SUCCESS;
+}
+
+} // namespace http
@@ -1,6 +1,8 @@
 #include "http/RequestParser.hpp"
-#include "common/filesystem.hpp"
+#include "http/BodyPipe.hpp"
 #include "http/Headers.hpp"
+#include "http/MultipartUpload.hpp"
+#include "http/RequestBody.hpp"
 #include "utils/Logger.hpp"
 #include <algorithm>
 #include <iostream>
@@ -11,7 +13,8 @@
 namespace http {
 
 RequestParser::RequestParser(Request &req, size_t maxHeaderSize)
-    : maxHeaderSize_(maxHeaderSize), request_(req), chunkParser_() {
+    : input_(maxHeaderSize), consumed_(0), maxHeaderSize_(maxHeaderSize), request_(req),
+      chunkParser_() {
     LOG_TRACE("RequestParser::RequestParser(): Initializing...");
     reset();
 }
@@ -24,8 +27,18 @@ void RequestParser::reset() {
     bytesWrittenToBody_ = 0;
     maxContentSize_ = 0;
     isContentChunked_ = false;
-    // buffer_.clear(); // Preserve buffer for pipelined requests
+    chunkParser_.reset();
     request_.clear();
+    // What follows the request belongs to the next, pipelined one: it is parsed in place
+    // and only moved to the front once that copies no more than what was consumed
+    if (consumed_ == input_.size()) {
+        input_.clear();
+        consumed_ = 0;
+    } else if (consumed_ >= input_.size() - consumed_) {
+        input_.erase(0, consumed_);
+        consumed_ = 0;
+    }
+    headParser_.reset(consumed_);
 }
 
 RequestParser::State RequestParser::state() const { return state_; }
@@ -40,14 +53,42 @@ RequestParser::State RequestParser::setError(HttpStatus status) {
 }
 
 RequestParser::State RequestParser::feed(char const *chunk, size_t size) {
-    if (state_ == READING_HEADERS) {
-        buffer_.append(chunk, size);
+    input_.append(chunk, size);
+    return parse();
+}
+
+char *RequestParser::inputSpace(size_t minSize, size_t &space) {
+    return input_.prepare(minSize, space);
+}
+
+RequestParser::State RequestParser::commitInput(size_t size) {
+    input_.commit(size);
+    return parse();
+}
+
+int RequestParser::spliceTarget(size_t &size) const {
+    if (state_ != READING_BODY || isContentChunked_ || !request_.body_ ||
+        request_.body_->inMemory() || input_.size() > consumed_)
+        return -1;
+    size = contentLength_ - bytesWrittenToBody_;
+    return request_.body_->fd();
+}
+
+RequestParser::State RequestParser::commitSpliced(size_t size) {
+    request_.body_->addWritten(size);
+    bytesWrittenToBody_ += size;
+    if (bytesWrittenToBody_ == contentLength_)
+        setRequestReady();
+    return state_;
+}
+
+RequestParser::State RequestParser::fail(HttpStatus status) { return setError(status); }
+
+RequestParser::State RequestParser::parse() {
+    if (state_ == READING_HEADERS)
         parseHeaders();
-    }
-    if (state_ == READING_BODY) {
-        buffer_.append(chunk, size);
+    if (state_ == READING_BODY)
         parseBody();
-    }
     return state_;
 }
 
@@ -69,71 +110,59 @@ RequestParser::State RequestParser::proceedReadingBody() {
 }
 
 RequestParser::State RequestParser::parseHeaders() {
-    // RFC 7230: skip leading CRLFs
-    size_t start = buffer_.find_first_not_of("\r\n");
-    if (start != std::string::npos && start > 0) {
-        buffer_.erase(0, start);
-    } else if (start == std::string::npos && !buffer_.empty()) {
-        // Only CRLFs in buffer, keep them but maybe keep buffer small
-        if (buffer_.length() > 1024)
-            buffer_.clear();
-        return state_;
-    }
-
-    if (buffer_.length() > maxHeaderSize_) {
-        LOG_SDEBUG("Header size limit exceeded: " << buffer_.length() << " > " << maxHeaderSize_);
+    RequestHeadParser::Status status = headParser_.parse(input_.data(), input_.size());
+    size_t headSize = (status == RequestHeadParser::HEAD_COMPLETE ? headParser_.headEnd()
+                                                                   : input_.size()) -
+                      consumed_;
+    if (headSize > maxHeaderSize_) {
+        LOG_SDEBUG("Header size limit exceeded: " << headSize << " > " << maxHeaderSize_);
         return setError(BAD_REQUEST);
     }
-
-    size_t offset = 0;
-    size_t headerEnd = http::Headers::findHeaderEnd(buffer_, offset);
-
-    if (headerEnd == std::string::npos) {
+    if (status == RequestHeadParser::HEAD_INCOMPLETE)
         return state_;
-    }
-
-    state_ = HEADERS_READY;
-    request_.requestLine_ = RequestStartLine::parse(buffer_);
-    if (request_.method() == RequestStartLine::UNKNOWN) {
-        LOG_SDEBUG("Unknown method or failed to parse request line: "
-                   << buffer_.substr(0, buffer_.find('\n')));
+    if (status == RequestHeadParser::HEAD_ERROR) {
+        char const *line = input_.data() + consumed_;
+        char const *lineEnd = std::find(line, input_.data() + input_.size(), '\n');
+        LOG_SDEBUG("Malformed request head: " << std::string(line, lineEnd));
         return setError(BAD_REQUEST);
     }
 
-    // Only parse the header section, not the body
-    size_t headerSectionStart = buffer_.find('\n');
-    if (headerSectionStart == std::string::npos) {
-        LOG_SDEBUG("Failed to find end of request line even though delimiter was found");
+    char const *data = input_.data();
+    RequestHeadParser::Span method = headParser_.method();
+    RequestHeadParser::Span target = headParser_.target();
+    RequestHeadParser::Span version = headParser_.version();
+    RequestStartLine &line = request_.requestLine_;
+    line.method = RequestStartLine::matchHttpMethod(data + method.offset, method.length);
+    if (line.method == RequestStartLine::UNKNOWN) {
+        LOG_SDEBUG("Unknown method: " << std::string(data + method.offset, method.length));
         return setError(BAD_REQUEST);
     }
-    headerSectionStart += 1;
+    line.setTarget(data + target.offset, target.length);
+    line.version.assign(data + version.offset, version.length);
+
+    request_.headers_.assignRaw(input_, headParser_.fields());
+    consumed_ = headParser_.headEnd();
+    state_ = HEADERS_READY;
 
-    std::string headerSection =
-        buffer_.substr(headerSectionStart, headerEnd - headerSectionStart + (offset - 2));
-    if (!http::Headers::parse(headerSection, request_.headers_)) {
-        LOG_SDEBUG("Failed to parse header section: " << headerSection);
+    if (!request_.headers_.getContentLength(contentLength_)) {
+        // Read differently by a proxy in front, the body would frame another request
+        LOG_SDEBUG("Invalid Content-Length: " << request_.headers_.get(header::CONTENT_LENGTH));
         return setError(BAD_REQUEST);
     }
-    contentLength_ = request_.headers_.getContentLength();
     isContentChunked_ = request_.headers_.isContentChunked();
-    bool isBodyExpected = contentLength_ > 0 || isContentChunked_;
-    if (isBodyExpected) {
-        buffer_.erase(0, headerEnd + offset);
-    } else {
-        buffer_.erase(0, headerEnd + offset);
-        setRequestReady();
+    if (isContentChunked_ && request_.headers_.has(header::CONTENT_LENGTH)) {
+        // Same smuggling risk: a proxy framing the body by Content-Length reads another request
+        LOG_SDEBUG("Both Content-Length and Transfer-Encoding");
+        return setError(BAD_REQUEST);
     }
+    if (contentLength_ == 0 && !isContentChunked_)
+        setRequestReady();
     return state_;
 }
 
 RequestParser::State RequestParser::parseBody() {
-    if (!request_.body_) {
-        request_.body_ = new utils::TempFile();
-    }
-    if (!request_.body_->isOpen() && !request_.body_->open()) {
-        LOG_SERROR("Failed to open TempFile. State=ERROR");
-        return setError(INTERNAL_SERVER_ERROR);
-    }
+    if (!request_.body_ && !createBody())
+        return state_;
     if (isContentChunked_) {
         handleChunkedBody();
     } else {
@@ -142,40 +171,63 @@ RequestParser::State RequestParser::parseBody() {
     return state_;
 }
 
+bool RequestParser::createBody() {
+    if (request_.pipesBody_) {
+        request_.body_ = new RequestBody(0, request_.getBodyTempPath());
+        request_.body_->streamTo(new BodyPipe);
+        return true;
+    }
+    std::string boundary;
+    if (!request_.uploadDirectory_.empty() &&
+        MultipartParser::boundaryOf(request_.headers_.get(header::CONTENT_TYPE), boundary)) {
+        request_.body_ = new RequestBody(0, request_.uploadDirectory_);
+        request_.body_->streamTo(new MultipartUpload(boundary, request_.uploadDirectory_));
+        return true;
+    }
+    size_t memoryLimit = request_.getBodyBufferSize();
+    if (!isContentChunked_ && contentLength_ > memoryLimit)
+        memoryLimit = 0; // Known not to fit: straight to the file
+    request_.body_ = new RequestBody(memoryLimit, request_.getBodyTempPath());
+    if (memoryLimit == 0 && !request_.body_->spill()) {
+        LOG_SERROR("Failed to create the request body file.");
+        setError(INTERNAL_SERVER_ERROR);
+        return false;
+    }
+    return true;
+}
+
 void RequestParser::handleContentLengthBody() {
     if (bytesWrittenToBody_ == contentLength_) {
         setRequestReady();
         return;
     }
     size_t bytesLeftToWrite = contentLength_ - bytesWrittenToBody_;
-    size_t bytesToWrite = std::min(buffer_.length(), bytesLeftToWrite);
+    size_t bytesToWrite = std::min(input_.size() - consumed_, bytesLeftToWrite);
     if (!bytesToWrite)
         return;
-    ssize_t written = write(request_.body_->fd(), buffer_.c_str(), bytesToWrite);
-
-    if (written < 0) {
-        LOG_SERROR("Write error to TempFile.");
+    if (!request_.body_->append(input_.data() + consumed_, bytesToWrite)) {
+        LOG_SERROR("Failed to store the request body.");
         return (void)setError(INTERNAL_SERVER_ERROR);
     }
 
-    buffer_.erase(0, written);
-    bytesWrittenToBody_ += written;
+    consumed_ += bytesToWrite;
+    discardConsumedBody();
+    bytesWrittenToBody_ += bytesToWrite;
 
     if (bytesWrittenToBody_ == contentLength_) {
         setRequestReady();
     }
 }
 
-bool RequestParser::writeToBodyFile(const std::string &data) {
+bool RequestParser::writeToBody(const std::string &data) {
     if (!request_.body_)
         return false;
-    ssize_t written = write(request_.body_->fd(), data.c_str(), data.size());
-    if (written < 0) {
-        LOG_ERROR("RequestParser::writeToBodyFile(): Write error to TempFile.");
+    if (!request_.body_->append(data.data(), data.size())) {
+        LOG_ERROR("RequestParser::writeToBody(): Failed to store the request body.");
         setError(INTERNAL_SERVER_ERROR);
         return false;
     }
-    bytesWrittenToBody_ += written;
+    bytesWrittenToBody_ += data.size();
     return true;
 }
 
@@ -183,14 +235,15 @@ void RequestParser::handleChunkedBody() {
     std::string decodedData;
     size_t bytesConsumed = 0;
 
-    ChunkedBodyParser::Status status =
-        chunkParser_.parse(buffer_.c_str(), buffer_.size(), decodedData, bytesConsumed);
+    ChunkedBodyParser::Status status = chunkParser_.parse(
+        input_.data() + consumed_, input_.size() - consumed_, decodedData, bytesConsumed);
 
-    buffer_.erase(0, bytesConsumed);
+    consumed_ += bytesConsumed;
+    discardConsumedBody();
 
     if (!decodedData.empty()) {
         LOG_STRACE("decoded " << decodedData.size() << " bytes: \"" << decodedData << "\"");
-        if (!writeToBodyFile(decodedData))
+        if (!writeToBody(decodedData))
             return;
     }
 
@@ -206,13 +259,22 @@ void RequestParser::handleChunkedBody() {
     }
 }
 
+void RequestParser::discardConsumedBody() {
+    size_t head = headParser_.headEnd();
+    if (consumed_ == input_.size()) {
+        input_.truncate(head); // The usual case: no bytes move
+        consumed_ = head;
+    } else if (consumed_ - head >= input_.size() - consumed_) {
+        input_.erase(head, consumed_ - head);
+        consumed_ = head;
+    }
+}
+
 void RequestParser::setRequestReady() {
     state_ = REQUEST_READY;
-    if (request_.body_ && request_.body_->isOpen()) {
-        if (lseek(request_.body_->fd(), 0, SEEK_SET) == (off_t)-1) {
-            LOG_ERROR("RequestParser::setRequestReady(): lseek failed on TempFile. State=ERROR");
-            setError(INTERNAL_SERVER_ERROR);
-        }
+    if (request_.body_ && !request_.body_->rewind()) {
+        LOG_ERROR("RequestParser::setRequestReady(): lseek failed on the body file. State=ERROR");
+        setError(INTERNAL_SERVER_ERROR);
     }
 }
 
@@ -1,10 +1,54 @@
 #include "http/Response.hpp"
 #include "common/string.hpp"
+#include "http/FastCgi.hpp"
 #include "http/ResponseBody.hpp"
+#include <ctime>
 #include <string>
 
 namespace http {
 
+char const SERVER_SOFTWARE[] = "ServerX/1.0";
+
+namespace {
+
+/**
+ * @brief The "Server" and "Date" fields, in that order.
+ * Date has a one second resolution, so the block is only formatted again when the
+ * second changes.
+ */
+class GeneralFields {
+public:
+    GeneralFields() : formattedAt_(-1) {}
+
+    std::string const &get() {
+        time_t now = std::time(NULL);
+        if (now != formattedAt_) {
+            char date[64];
+            std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", std::gmtime(&now));
+            fields_ = std::string("Server: ") + SERVER_SOFTWARE + "\r\n";
+            dateOffset_ = fields_.size();
+            fields_ += std::string("Date: ") + date + "\r\n";
+            formattedAt_ = now;
+        }
+        return fields_;
+    }
+
+    /** @brief Offset of the Date field in get(). */
+    size_t dateOffset() const { return dateOffset_; }
+
+private:
+    time_t formattedAt_;
+    std::string fields_;
+    size_t dateOffset_;
+};
+
+GeneralFields &generalFields() {
+    static GeneralFields instance;
+    return instance;
+}
+
+} // namespace
+
 ResponseStartLine::ResponseStartLine() : protocol("HTTP/1.1"), statusCode(OK), reasonPhrase("OK") {}
 
 Response::Response() : body_(NULL) {}
@@ -15,8 +59,8 @@ Response &Response::setNoBody(bool removeContentHeaders) {
     delete body_;
     body_ = NULL;
     if (removeContentHeaders) {
-        headers_.erase("Content-Length");
-        headers_.erase("Content-Type");
+        headers_.erase(header::CONTENT_LENGTH);
+        headers_.erase(header::CONTENT_TYPE);
     }
     return *this;
 }
@@ -24,33 +68,62 @@ Response &Response::setNoBody(bool removeContentHeaders) {
 Response &Response::setBodyInMemory(std::string const &data, std::string const &contentType) {
     delete body_;
     body_ = new BodyInMemory(data);
-    headers_.add("Content-Length", utils::toString(body_->size()));
-    headers_.add("Content-Type", contentType);
+    headers_.add(header::CONTENT_LENGTH, utils::toString(body_->size()));
+    headers_.add(header::CONTENT_TYPE, contentType);
     return *this;
 }
 
 Response &Response::setBodyFromFile(std::string const &fpath, std::string const &contentType) {
     delete body_;
     body_ = new FileBody(fpath);
-    headers_.add("Content-Length", utils::toString(body_->size()));
-    headers_.add("Content-Type", contentType);
+    headers_.add(header::CONTENT_LENGTH, utils::toString(body_->size()));
+    headers_.add(header::CONTENT_TYPE, contentType);
     return *this;
 }
 
-Response &Response::setBodyFromCgi(int pipeFd, bool hasHeaderParsing) {
+Response &Response::setBodyFromFile(OpenFileCache::Entry *file, std::string const &contentType) {
     delete body_;
-    body_ = new BodyFromCgi(pipeFd, hasHeaderParsing);
+    body_ = NULL;
+    try {
+        body_ = new FileBody(file);
+    } catch (...) {
+        OpenFileCache::getInstance().release(file); // The body never took the pin
+        throw;
+    }
+    headers_.add(header::CONTENT_LENGTH, utils::toString(body_->size()));
+    headers_.add(header::CONTENT_TYPE, contentType);
+    return *this;
+}
+
+Response &Response::setBodyFromCgi(int pipeFd, pid_t pid, bool hasHeaderParsing) {
+    delete body_;
+    body_ = new BodyFromCgi(pipeFd, pid, hasHeaderParsing);
+    return *this;
+}
+
+Response &Response::setBodyFromFastCgi(std::string const &backend, int fd,
+                                       std::vector<std::string> const &envp, int stdinFd,
+                                       bool hasHeaderParsing) {
+    delete body_;
+    body_ = new FastCgiBody(backend, fd, envp, stdinFd, hasHeaderParsing);
     return *this;
 }
 
 void Response::buildHeaders(std::vector<char> &buffer, bool addBodyLine) const {
     buffer.clear();
-    std::string startLine = startLine_.protocol + " " + utils::toString(startLine_.statusCode) +
-                            " " + startLine_.reasonPhrase + "\r\n";
-    buffer.insert(buffer.end(), startLine.begin(), startLine.end());
+    std::string const &statusLine = getStatusLine(startLine_.statusCode);
+    buffer.insert(buffer.end(), statusLine.begin(), statusLine.end());
+
+    // A CGI script may have set either field itself
+    GeneralFields &fields = generalFields();
+    std::string const &general = fields.get();
+    std::string::const_iterator dateStart = general.begin() + fields.dateOffset();
+    if (!headers_.has(header::SERVER))
+        buffer.insert(buffer.end(), general.begin(), dateStart);
+    if (!headers_.has(header::DATE))
+        buffer.insert(buffer.end(), dateStart, general.end());
 
-    std::string headerLines = headers_.toString();
-    buffer.insert(buffer.end(), headerLines.begin(), headerLines.end());
+    headers_.appendTo(buffer);
 
     if (addBodyLine) {
         buffer.push_back('\r');
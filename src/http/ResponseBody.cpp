@@ -14,37 +14,53 @@ namespace http {
 
 bool IResponseBody::hasHeaderParsing() const { return false; }
 int IResponseBody::getEventSourceFd() const { return -1; }
+pid_t IResponseBody::processId() const { return -1; }
+IResponseBody::RequestStatus IResponseBody::sendRequest() { return REQUEST_SENT; }
+bool IResponseBody::fileRegion(int &, off_t &, size_t &) const { return false; }
+bool IResponseBody::memoryRegion(char const *&, size_t &) const { return false; }
+void IResponseBody::consume(size_t) {}
 
 //==================== FileBody ====================
 
-FileBody::FileBody(std::string const &fpath) : fd_(-1), size_(0), sent_(0) {
-    struct stat statbuf;
-    if (stat(fpath.c_str(), &statbuf) != 0)
-        throw std::runtime_error("stat(" + fpath + ")::" + strerror(errno));
-    size_ = statbuf.st_size;
-    fd_ = open(fpath.c_str(), O_RDONLY);
-    if (fd_ < 0)
+FileBody::FileBody(std::string const &fpath) : file_(NULL), size_(0), sent_(0) {
+    file_ = OpenFileCache::getInstance().acquire(fpath);
+    if (!file_)
         throw std::runtime_error("open(" + fpath + ", O_RDONLY)::" + strerror(errno));
+    if (file_->fd == -1) {
+        OpenFileCache::getInstance().release(file_);
+        throw std::runtime_error("open(" + fpath + "): not a regular file");
+    }
+    size_ = file_->st.st_size;
     LOG_TRACE("FileBody::FileBody(" << fpath << "): opened for reading and about to send " << size_
                                     << " bytes");
 }
 
-FileBody::~FileBody() {
-    if (fd_ != -1)
-        close(fd_);
+FileBody::FileBody(OpenFileCache::Entry *file) : file_(file), size_(file->st.st_size), sent_(0) {
+    LOG_TRACE("FileBody::FileBody(" << file_->path << "): about to send " << size_ << " bytes");
 }
 
+FileBody::~FileBody() { OpenFileCache::getInstance().release(file_); }
+
 ssize_t FileBody::read(char *buffer, size_t size) {
-    if (fd_ == -1)
-        return 0;
-    ssize_t read = ::read(fd_, buffer, size);
-    sent_ += read;
+    // The descriptor may be shared, so sent_ is the only notion of position
+    ssize_t read = ::pread(file_->fd, buffer, std::min(size, size_ - sent_), sent_);
+    if (read > 0)
+        sent_ += read;
     return read;
 }
 
 size_t FileBody::size() const { return size_; }
 bool FileBody::isDone() const { return sent_ == size_; };
 
+bool FileBody::fileRegion(int &fd, off_t &offset, size_t &length) const {
+    fd = file_->fd;
+    offset = static_cast<off_t>(sent_);
+    length = size_ - sent_;
+    return true;
+}
+
+void FileBody::consume(size_t bytes) { sent_ = std::min(size_, sent_ + bytes); }
+
 //==================== FileBody ====================
 
 //==================== BodyInMemory ====================
@@ -61,11 +77,21 @@ ssize_t BodyInMemory::read(char *buffer, size_t size) {
     return bytesToRead;
 }
 
+bool BodyInMemory::memoryRegion(char const *&data, size_t &length) const {
+    data = body_.data() + bytesRead_;
+    length = body_.length() - bytesRead_;
+    return true;
+}
+
+void BodyInMemory::consume(size_t bytes) {
+    bytesRead_ = std::min(body_.length(), bytesRead_ + bytes);
+}
+
 //==================== BodyInMemory ====================
 
 //==================== BodyFromCgi ====================
-BodyFromCgi::BodyFromCgi(int pipeFd, bool hasHeaderParsing)
-    : fd_(pipeFd), isDone_(false), hasHeaderParsing_(hasHeaderParsing) {
+BodyFromCgi::BodyFromCgi(int pipeFd, pid_t pid, bool hasHeaderParsing)
+    : fd_(pipeFd), pid_(pid), isDone_(false), hasHeaderParsing_(hasHeaderParsing) {
     if (fd_ < 0) {
         isDone_ = true;
         return;
@@ -89,7 +115,9 @@ ssize_t BodyFromCgi::read(char *buffer, size_t size) {
         isDone_ = true;
         return 0;
     }
-    // bytesRead < 0: EAGAIN or error - return -1 and let caller/epoll handle it
+    // bytesRead < 0: EAGAIN just means the pipe is empty for now (edge-triggered readers)
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return -1;
     LOG_ERROR("BodyFromCgi::read: " << strerror(errno));
     isDone_ = true;
     return -1;
@@ -98,6 +126,7 @@ size_t BodyFromCgi::size() const { return 0; }
 bool BodyFromCgi::isDone() const { return isDone_; };
 int BodyFromCgi::getEventSourceFd() const { return fd_; }
 bool BodyFromCgi::hasHeaderParsing() const { return hasHeaderParsing_; }
+pid_t BodyFromCgi::processId() const { return pid_; }
 
 //==================== BodyFromCgi ====================
 
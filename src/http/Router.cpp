@@ -18,6 +18,8 @@ Router::Router(config::ServerConfig const &cfg, MimeTypes const &mime)
     LOG_TRACE("Router::Router(): router created");
 }
 
+config::ServerConfig const &Router::config() const { return config_; }
+
 void Router::matchServerAndLocation(int port, Request &request) const {
     std::string ctx = "(" + utils::toString(port) + ", " + request.path() + "): ";
     (void)ctx;
@@ -30,9 +32,20 @@ void Router::matchServerAndLocation(int port, Request &request) const {
     request.location(request.server()->matchLocation(request));
     if (!request.location()) {
         LOG_STRACE(ctx << "No matching location found");
-    } else {
-        LOG_STRACE(ctx << "Matched location=" << request.location()->path());
+        return;
+    }
+    LOG_STRACE(ctx << "Matched location=" << request.location()->path());
+
+    // Spool an upload's body next to its destination (see executeHandler()), so that
+    // storing it is a rename rather than a copy
+    config::LocationBlock const *loc = request.location();
+    if (request.method() == RequestStartLine::POST && !loc->hasCgiPass() &&
+        !loc->hasFastCgiPass() && !loc->has("return") && isMethodAllowed(request)) {
+        request.uploadDirectory(FileUploadHandler::targetDirectory(request));
     }
+    // Or hand it to the script as it arrives (see network::ClientHandler)
+    request.pipesBody(loc->hasCgiPass() && !loc->cgiRequestBuffering() &&
+                      isMethodAllowed(request));
 }
 
 void Router::dispatch(int port, Request const &request, Response &response) const {
@@ -98,7 +111,7 @@ void Router::executeHandler(Request const &request, Response &response) const {
 
     const config::LocationBlock *loc = request.location();
 
-    if (loc->hasCgiPass()) {
+    if (loc->hasCgiPass() || loc->hasFastCgiPass()) {
         LOG_STRACE(ctx << "Dispatched to CGIHandler");
         CGIHandler::handle(request, response, mimeTypes_);
     } else if (loc->has("return")) {
@@ -1,9 +1,10 @@
 #include "http/handlers/CGIHandler.hpp"
-#include "common/error.hpp"
 #include "common/filesystem.hpp"
 #include "common/string.hpp"
 #include "config/LocationBlock.hpp"
 #include "core/Server.hpp"
+#include "http/BodyPipe.hpp"
+#include "http/FastCgi.hpp"
 #include "http/Handler.hpp"
 #include "http/HttpStatus.hpp"
 #include "http/handlers/DirectoryListingHandler.hpp"
@@ -12,8 +13,10 @@
 #include <climits>
 #include <cstdlib>
 #include <cstring>
+#include <csignal>
 #include <fcntl.h>
-#include <sys/wait.h>
+#include <spawn.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 namespace http {
@@ -31,6 +34,23 @@ bool isNPH(const std::string &path) {
 
 bool isNPH(Request const &req) { return req.location()->has("cgi_nph") || isNPH(req.path()); }
 
+/**
+ * @brief Sets a limit given to the `cgi_limits` exec wrapper ("0": none) on its process,
+ * the hard limit @p slack above the soft one.
+ *
+ * Templated on the resource: glibc declares it as an enum in C++, not as an int.
+ */
+template <typename Resource>
+bool setLimit(Resource resource, char const *value, rlim_t slack) {
+    rlim_t limit = std::strtoul(value, NULL, 10);
+    if (limit == 0)
+        return true;
+    struct rlimit rl;
+    rl.rlim_cur = limit;
+    rl.rlim_max = limit + slack;
+    return setrlimit(resource, &rl) == 0;
+}
+
 bool isValidCgiHeaderName(std::string const &headerName) {
     if (headerName.empty()) {
         return false;
@@ -47,11 +67,26 @@ bool isValidCgiHeaderName(std::string const &headerName) {
 
 } // namespace
 
-CGIHandler::CGIHandler(Request const &req, Response &res) : req_(req), res_(res), pid_(-1) {
+char const *const CGIHandler::LIMITS_WRAPPER = "--cgi-limits";
+
+int CGIHandler::execWithLimits(int argc, char **argv) {
+    if (argc < 6)
+        return 127;
+    // SIGXCPU at the CPU limit, SIGKILL a second later
+    if (!setLimit(RLIMIT_CPU, argv[2], 1) || !setLimit(RLIMIT_AS, argv[3], 0) ||
+        !setLimit(RLIMIT_NOFILE, argv[4], 0)) {
+        LOG_ERROR("cgi_limits: setrlimit() for " << argv[5] << ": " << strerror(errno));
+        return 127;
+    }
+    execv(argv[5], argv + 5);
+    LOG_ERROR("cgi_limits: execv(" << argv[5] << "): " << strerror(errno));
+    return 127;
+}
+
+CGIHandler::CGIHandler(Request const &req, Response &res)
+    : req_(req), res_(res), stdinFd_(-1), pid_(-1) {
     pipeFd_[0] = -1;
     pipeFd_[1] = -1;
-    errorFd_[0] = -1;
-    errorFd_[1] = -1;
     argv_.reserve(3);
     envp_.reserve(30);
 }
@@ -59,6 +94,12 @@ CGIHandler::CGIHandler(Request const &req, Response &res) : req_(req), res_(res)
 void CGIHandler::handle(Request const &req, Response &res, MimeTypes const &mime) {
     CHECK_FOR_SERVER_AND_LOCATION(req, res);
 
+    if (req.location()->hasFastCgiPass()) {
+        // The script lives on the backend's side, which reports a missing one itself
+        CGIHandler handler(req, res);
+        return handler.passToFastCgi();
+    }
+
     std::string path = req.resolvePath();
     LOG_DEBUG("CGIHandler::handle: path=" << path);
     struct stat st;
@@ -107,87 +148,56 @@ void CGIHandler::handle() {
         res_.status(INTERNAL_SERVER_ERROR);
         return;
     }
-    this->fork();
-    switch (pid_) {
-    case -1:
-        return;
-    case 0:
-        return runChildProcess();
-    default:
-        return runParentProcess();
-    }
-}
-
-void CGIHandler::runChildProcess() {
     buildArgv();
     buildEnvp();
-
-    close(errorFd_[0]);
-    close(pipeFd_[0]);
-
-    if (dup2(pipeFd_[1], STDOUT_FILENO) == -1) {
-        print_errno_to_fd(errorFd_[1], errno);
-        _exit(1);
-    }
-    close(pipeFd_[1]);
-
-    if (req_.body()) {
-        if (dup2(req_.body()->fd(), STDIN_FILENO) == -1) {
-            print_errno_to_fd(errorFd_[1], errno);
-            _exit(1);
-        }
-    } else {
-        if (dup2(core::Server::getNullFd(), STDIN_FILENO) == -1) {
-            print_errno_to_fd(errorFd_[1], errno);
-            _exit(1);
-        }
-    }
-
-    execve();
-    print_errno_to_fd(errorFd_[1], errno);
-    close(errorFd_[1]);
-    _exit(127);
+    spawn();
 }
 
-void CGIHandler::runParentProcess() {
-    close(pipeFd_[1]);
-    close(errorFd_[1]);
-    char buf[257];
-    ssize_t bytesRead = read(errorFd_[0], buf, sizeof(buf) - 1);
-    if (bytesRead > 0) {
-        LOG_SERROR("execve: " << std::string(buf, bytesRead));
+void CGIHandler::passToFastCgi() {
+    std::string backend = req_.location()->getRawValues("fastcgi_pass")[0];
+    int fd = fastcgi::ConnectionPool::getInstance().acquire(backend);
+    if (fd == -1) {
+        LOG_SERROR("fastcgi_pass " << backend << ": " << strerror(errno));
+        res_.status(BAD_GATEWAY);
+        return;
+    }
+    if (req_.body() && (stdinFd_ = req_.body()->openReader()) == -1) {
+        LOG_SERROR("Cannot pass the request body to the FastCGI backend: " << strerror(errno));
+        close(fd);
         res_.status(INTERNAL_SERVER_ERROR);
-    } else {
-        res_.setBodyFromCgi(pipeFd_[0], !isNPH(req_));
+        return;
     }
-    close(errorFd_[0]);
+    buildEnvp();
+    res_.setBodyFromFastCgi(backend, fd, envp_, stdinFd_, !isNPH(req_));
+    stdinFd_ = -1; // Owned by the body now
 }
 
 bool CGIHandler::initPipes() {
-    if (pipe(pipeFd_)) {
+    // Both ends close on exec: the child only keeps the copy dup2()ed onto its stdout
+    if (pipe2(pipeFd_, O_CLOEXEC)) {
         LOG_SERROR(strerror(errno));
         return false;
     }
-    if (pipe2(errorFd_, O_CLOEXEC)) {
+    // A body still being received goes through a pipe the connection fills as it arrives
+    BodyPipe *bodyPipe = req_.body() ? req_.body()->pipe() : NULL;
+    if (bodyPipe)
+        stdinFd_ = bodyPipe->open();
+    else if (req_.body())
+        stdinFd_ = req_.body()->openReader();
+    if (req_.body() && stdinFd_ == -1) {
+        LOG_SERROR("Cannot pass the request body to the CGI: " << strerror(errno));
         close(pipeFd_[0]);
         close(pipeFd_[1]);
-        LOG_SERROR(strerror(errno));
         return false;
     }
     return true;
 }
 
-void CGIHandler::fork() {
-    pid_ = ::fork();
-    if (pid_ != -1)
-        return;
-
-    close(pipeFd_[0]);
-    close(pipeFd_[1]);
-    close(errorFd_[0]);
-    close(errorFd_[1]);
-    LOG_SERROR(strerror(errno));
-    res_.status(INTERNAL_SERVER_ERROR);
+void CGIHandler::closeStdin() {
+    if (stdinFd_ != -1) {
+        close(stdinFd_);
+        stdinFd_ = -1;
+    }
 }
 
 void CGIHandler::buildArgv() {
@@ -252,7 +262,7 @@ void CGIHandler::buildEnvp() {
     }
 
     envp_.push_back("GATEWAY_INTERFACE=CGI/1.1");
-    envp_.push_back("SERVER_SOFTWARE=ServerX/1.0");
+    envp_.push_back(std::string("SERVER_SOFTWARE=") + SERVER_SOFTWARE);
     envp_.push_back("SERVER_PROTOCOL=" + req_.version());
     envp_.push_back("REQUEST_METHOD=" +
                     std::string(RequestStartLine::methodToString(req_.method())));
@@ -277,23 +287,21 @@ void CGIHandler::buildEnvp() {
     envp_.push_back("REQUEST_URI=" + req_.uri());
     envp_.push_back("REDIRECT_STATUS=200");
 
-    std::string contentType = req_.headers().get("Content-Type");
+    std::string contentType = req_.headers().get(header::CONTENT_TYPE);
     if (!contentType.empty()) {
         envp_.push_back("CONTENT_TYPE=" + contentType);
     }
-    std::string contentLength = req_.headers().get("Content-Length");
+    std::string contentLength = req_.headers().get(header::CONTENT_LENGTH);
     if (!contentLength.empty()) {
         envp_.push_back("CONTENT_LENGTH=" + contentLength);
     }
 
-    for (Headers::HeaderMap::const_iterator it = req_.headers().begin(); it != req_.headers().end();
-         ++it) {
-        std::string headerName = it->first;
-        if (!isValidCgiHeaderName(headerName))
+    for (Headers::const_iterator it = req_.headers().begin(); it != req_.headers().end(); ++it) {
+        if (it->id == header::CONTENT_TYPE || it->id == header::CONTENT_LENGTH)
             continue;
-        if (headerName == "content-type" || headerName == "content-length")
+        if (!isValidCgiHeaderName(it->name))
             continue;
-        envp_.push_back(formatHeaderName(headerName) + "=" + it->second);
+        envp_.push_back(formatHeaderName(it->name) + "=" + it->value);
     }
 }
 
@@ -320,10 +328,56 @@ static std::vector<char *> toCStringVector(std::vector<std::string> const &v) {
     return res;
 }
 
-int CGIHandler::execve() {
-    std::vector<char *> const &argv_ptrs = toCStringVector(argv_);
-    std::vector<char *> const &envp_ptrs = toCStringVector(envp_);
-    return ::execve(argv_ptrs[0], &argv_ptrs[0], &envp_ptrs[0]);
+void CGIHandler::spawn() {
+    std::string path = argv_[0];
+    size_t cpu, addressSpace, openFiles;
+    req_.location()->cgiLimits(cpu, addressSpace, openFiles);
+    if (cpu || addressSpace || openFiles) {
+        std::string wrapper[] = {argv_[0], LIMITS_WRAPPER, utils::toString(cpu),
+                                 utils::toString(addressSpace), utils::toString(openFiles)};
+        argv_.insert(argv_.begin(), wrapper, wrapper + 5);
+        path = "/proc/self/exe"; // In the child, still the server binary
+    }
+    std::vector<char *> argv = toCStringVector(argv_);
+    std::vector<char *> envp = toCStringVector(envp_);
+    int stdinFd = stdinFd_ != -1 ? stdinFd_ : core::Server::getNullFd();
+
+    // The worker blocks SIGCHLD (see network::ChildReaper) and ignores SIGPIPE; the script
+    // starts with neither, in a process group of its own that a timeout can stop as a whole
+    sigset_t noSignals, defaults;
+    sigemptyset(&noSignals);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_t attr;
+    int error = posix_spawnattr_init(&attr);
+    if (error == 0) {
+        posix_spawnattr_setsigmask(&attr, &noSignals);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setpgroup(&attr, 0);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF |
+                                            POSIX_SPAWN_SETPGROUP);
+        posix_spawn_file_actions_t actions;
+        error = posix_spawn_file_actions_init(&actions);
+        if (error == 0) {
+            error = posix_spawn_file_actions_adddup2(&actions, pipeFd_[1], STDOUT_FILENO);
+            if (error == 0)
+                error = posix_spawn_file_actions_adddup2(&actions, stdinFd, STDIN_FILENO);
+            if (error == 0)
+                error = posix_spawn(&pid_, path.c_str(), &actions, &attr, &argv[0],
+                                    &envp[0]);
+            posix_spawn_file_actions_destroy(&actions);
+        }
+        posix_spawnattr_destroy(&attr);
+    }
+    close(pipeFd_[1]);
+    closeStdin();
+    if (error != 0) {
+        LOG_SERROR("posix_spawn(" << argv_[0] << "): " << strerror(error));
+        close(pipeFd_[0]);
+        res_.status(INTERNAL_SERVER_ERROR);
+        return;
+    }
+    res_.setBodyFromCgi(pipeFd_[0], pid_, !isNPH(req_));
 }
 
 } // namespace http
@@ -5,6 +5,7 @@
 #include "config/ServerBlock.hpp"
 #include "http/FileUploadValidator.hpp"
 #include "http/MimeTypes.hpp"
+#include "http/MultipartUpload.hpp"
 #include "http/Request.hpp"
 #include "http/Response.hpp"
 #include "utils/Logger.hpp"
@@ -14,6 +15,7 @@
 #include <string>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <vector>
 
 namespace http {
 
@@ -25,8 +27,76 @@ std::string getUploadPath(Request const &req) {
     return "";
 }
 
+/** @brief The URL a file stored by an upload to @p req's location is served at. */
+std::string uploadUrl(Request const &req, std::string const &filename) {
+    std::string lp = req.location()->path(); // e.g. "/img/"
+    std::string up = getUploadPath(req);     // e.g. "upload" or "/upload"
+
+    // Normalize: remove leading/trailing slashes for a robust prefix compare
+    std::string toFind = lp.empty() ? lp : (lp[0] == '/' ? lp.substr(1) : lp);
+    if (!toFind.empty() && toFind[toFind.size() - 1] == '/')
+        toFind.resize(toFind.size() - 1);
+
+    std::string upNorm = up.empty() ? up : (up[0] == '/' ? up.substr(1) : up);
+
+    // TODO(root):
+    // This logic exists because root & location path are merged too early.
+    // Remove after root/url separation is implemented.
+    if (!toFind.empty() && upNorm.compare(0, toFind.size(), toFind) == 0 &&
+        (req.location()->root() == req.server()->root())) {
+        upNorm.erase(0, toFind.size());
+        // remove an accidental leading slash if present after erase
+        if (!upNorm.empty() && upNorm[0] == '/')
+            upNorm.erase(0, 1);
+    }
+
+    return utils::joinPaths(lp, utils::joinPaths(upNorm, filename));
+}
+
+/**
+ * Stores the files of a multipart/form-data upload, already written next to their
+ * destination by MultipartUpload while the body was read. Nothing is stored unless
+ * every name is free.
+ */
+void storeMultipart(Request const &req, Response &res, MultipartUpload const &form,
+                    std::string const &dir) {
+    if (!form.complete())
+        return (void)res.status(form.errorStatus(), form.errorMessage());
+    std::vector<MultipartUpload::File> const &files = form.files();
+    if (files.empty())
+        return (void)res.status(BAD_REQUEST, "No file in the multipart/form-data body");
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::string path = utils::joinPaths(dir, files[i].filename);
+        if (access(path.c_str(), F_OK) == 0)
+            return (void)res.status(CONFLICT, "File already exists");
+        for (size_t j = 0; j < i; ++j) {
+            if (files[j].filename == files[i].filename)
+                return (void)res.status(CONFLICT, "File sent twice");
+        }
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::string path = utils::joinPaths(dir, files[i].filename);
+        utils::TempFile::MoveStatus moveRes = files[i].file->moveTo(path);
+        if (moveRes != utils::TempFile::MOVE_SUCCESS) {
+            LOG_SERROR("moveTo(" << path << ") reported error status: " << moveRes);
+            return (void)res.status(INTERNAL_SERVER_ERROR,
+                                    "Failed to write uploaded file to disk");
+        }
+    }
+    res.status(CREATED);
+    res.headers().add("Location", uploadUrl(req, files[0].filename));
+}
+
 } // namespace
 
+std::string FileUploadHandler::targetDirectory(Request const &req) {
+    if (!req.location() || getUploadPath(req).empty())
+        return "";
+    std::string path = utils::joinPaths(req.location()->root(), getUploadPath(req));
+    return upload::validateUploadPath(path).result ? path : "";
+}
+
 void FileUploadHandler::handle(Request const &req, Response &res, MimeTypes const &mime) {
     CHECK_FOR_SERVER_AND_LOCATION(req, res);
     std::string uploadPath = getUploadPath(req);
@@ -49,17 +119,15 @@ void FileUploadHandler::handle(Request const &req, Response &res, MimeTypes cons
         return (void)res.status(BAD_REQUEST, "No body provided for upload");
     }
 
-    if (!req.headers().has("Content-Length")) {
+    // A chunked body is already decoded into the temp file, so its length is known too
+    if (!req.headers().has("Content-Length") && !req.headers().isContentChunked()) {
         return (void)res.status(LENGTH_REQUIRED, "Content-Length header is required for uploads");
     }
 
-    // todo: Handle multipart/form-data
-    if (req.headers().has("Content-Type")) {
-        std::string contentType = req.headers().get("Content-Type");
-        if (contentType.find("multipart/form-data") != std::string::npos) {
-            return (void)res.status(NOT_IMPLEMENTED);
-        }
-    }
+    if (MultipartUpload const *form = req.body()->multipart())
+        return storeMultipart(req, res, *form, path);
+    if (req.headers().get("Content-Type").find("multipart/form-data") != std::string::npos)
+        return (void)res.status(BAD_REQUEST, "Invalid multipart/form-data boundary");
 
     upload::UploadValidationResult pf = upload::parseFilename(req, mime);
     if (!pf.result) {
@@ -83,31 +151,6 @@ void FileUploadHandler::handle(Request const &req, Response &res, MimeTypes cons
     }
 
     res.status(CREATED);
-
-    // Build correct Location URL
-    std::string lp = req.location()->path(); // e.g. "/img/"
-    std::string up = getUploadPath(req);     // e.g. "upload" or "/upload"
-
-    // Normalize: remove leading/trailing slashes for a robust prefix compare
-    std::string toFind = lp.empty() ? lp : (lp[0] == '/' ? lp.substr(1) : lp);
-    if (!toFind.empty() && toFind[toFind.size() - 1] == '/')
-        toFind.resize(toFind.size() - 1);
-
-    std::string upNorm = up.empty() ? up : (up[0] == '/' ? up.substr(1) : up);
-
-    // TODO(root):
-    // This logic exists because root & location path are merged too early.
-    // Remove after root/url separation is implemented.
-    if (!toFind.empty() && upNorm.compare(0, toFind.size(), toFind) == 0 &&
-        (lRoot == req.server()->root())) {
-        upNorm.erase(0, toFind.size());
-        // remove an accidental leading slash if present after erase
-        if (!upNorm.empty() && upNorm[0] == '/')
-            upNorm.erase(0, 1);
-    }
-
-    std::string url = utils::joinPaths(lp, utils::joinPaths(upNorm, pf.filename));
-
-    res.headers().add("Location", url);
+    res.headers().add("Location", uploadUrl(req, pf.filename));
 }
 } // namespace http
\ No newline at end of file
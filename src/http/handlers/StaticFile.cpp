@@ -2,6 +2,7 @@
 #include "config/ServerBlock.hpp"
 #include "http/Handler.hpp"
 #include "http/MimeTypes.hpp"
+#include "http/OpenFileCache.hpp"
 #include "http/Request.hpp"
 #include "http/Response.hpp"
 #include <cerrno>
@@ -12,6 +13,38 @@
 
 namespace http {
 
+namespace {
+
+/**
+ * @brief Same lookup as LocationBlock::resolveIndexFile(), but probing through the
+ * OpenFileCache so hot index files cost no access() call.
+ * @return The pinned entry of the first existing index file, or NULL with errno set
+ * (EACCES if a candidate exists but cannot be opened).
+ */
+OpenFileCache::Entry *acquireIndexFile(OpenFileCache &cache, config::LocationBlock const &loc,
+                                       std::string const &dirPath) {
+    errno = ENOENT;
+    if (!loc.has("index"))
+        return NULL;
+    std::vector<std::string> const &indexes = loc.indexFiles();
+    std::string base = dirPath + (dirPath.empty() || dirPath[dirPath.size() - 1] != '/' ? "/" : "");
+
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        OpenFileCache::Entry *file = cache.acquire(base + indexes[i]);
+        if (file && file->fd != -1)
+            return file;
+        if (file) {
+            cache.release(file);
+        } else if (errno == EACCES) {
+            return NULL;
+        }
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+} // namespace
+
 void StaticFileHandler::handle(Request const &req, Response &res, MimeTypes const &mime) {
     if (!req.server() || !req.location()) {
         res.status(INTERNAL_SERVER_ERROR);
@@ -19,18 +52,16 @@ void StaticFileHandler::handle(Request const &req, Response &res, MimeTypes cons
     }
 
     std::string path = req.resolvePath();
-    struct stat st;
+    OpenFileCache &cache = OpenFileCache::getInstance();
+    OpenFileCache::Entry *file = cache.acquire(path);
 
-    if (!utils::getFileStatus(path, st)) {
-        if (errno == EACCES) {
-            res.status(FORBIDDEN);
-        } else {
-            res.status(NOT_FOUND);
-        }
+    if (!file) {
+        res.status(errno == EACCES ? FORBIDDEN : NOT_FOUND);
         return;
     }
 
-    if (S_ISDIR(st.st_mode)) {
+    if (S_ISDIR(file->st.st_mode)) {
+        cache.release(file);
         if (req.path().empty() || req.path()[req.path().size() - 1] != '/') {
             std::string redirect = req.path() + "/";
             if (!req.queryString().empty())
@@ -40,24 +71,21 @@ void StaticFileHandler::handle(Request const &req, Response &res, MimeTypes cons
             return;
         }
 
-        std::string indexPath = req.location()->resolveIndexFile(path);
-
-        if (indexPath.empty()) {
-            res.status(NOT_FOUND);
+        file = acquireIndexFile(cache, *req.location(), path);
+        if (!file) {
+            res.status(errno == EACCES ? FORBIDDEN : NOT_FOUND);
             return;
         }
-        path = indexPath;
-    }
-
-    if (access(path.c_str(), R_OK) != 0) {
+    } else if (file->fd == -1) {
+        cache.release(file);
         res.status(FORBIDDEN);
         return;
     }
 
+    std::string contentType = mime.getMimeType(utils::getFileExtension(file->path));
     res.status(OK);
     try {
-        std::string ext = utils::getFileExtension(path);
-        res.setBodyFromFile(path, mime.getMimeType(ext));
+        res.setBodyFromFile(file, contentType);
     } catch (...) {
         res.status(INTERNAL_SERVER_ERROR);
     }
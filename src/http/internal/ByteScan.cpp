@@ -0,0 +1,186 @@
+#include "http/internal/ByteScan.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_X86_KERNELS 1
+#endif
+
+namespace http {
+namespace scan {
+
+namespace {
+
+typedef size_t (*ScanFunction)(char const *, size_t);
+
+struct Kernels {
+    ScanFunction findControl;
+    ScanFunction findNonToken;
+};
+
+struct CharTables {
+    bool control[256];
+    bool nonToken[256];
+
+    CharTables() {
+        for (int c = 0; c < 256; ++c) {
+            control[c] = (c < 0x20 && c != '\t') || c == 0x7f;
+            nonToken[c] = c <= 0x20 || c >= 0x7f || std::strchr("\"(),/:;<=>?@[\\]{}", c);
+        }
+    }
+};
+
+CharTables const tables;
+
+size_t scalarFind(bool const *table, char const *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (table[static_cast<unsigned char>(data[i])])
+            return i;
+    }
+    return size;
+}
+
+size_t scalarFindControl(char const *data, size_t size) {
+    return scalarFind(tables.control, data, size);
+}
+
+size_t scalarFindNonToken(char const *data, size_t size) {
+    return scalarFind(tables.nonToken, data, size);
+}
+
+#ifdef HAS_X86_KERNELS
+
+// Unsigned range tests through min/max: SSE2 and AVX2 only compare signed bytes
+
+__attribute__((target("sse2"))) inline __m128i inRange128(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(lo)), v),
+                         _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(hi)), v));
+}
+
+__attribute__((target("sse2"))) size_t sse2FindControl(char const *data, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + i));
+        __m128i ctl = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')),
+                                       inRange128(v, 0x00, 0x1f));
+        ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+        int mask = _mm_movemask_epi8(ctl);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + scalarFindControl(data + i, size - i);
+}
+
+__attribute__((target("sse2"))) size_t sse2FindNonToken(char const *data, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + i));
+        __m128i sep = _mm_or_si128(inRange128(v, 0x28, 0x29), inRange128(v, 0x3a, 0x40));
+        sep = _mm_or_si128(sep, inRange128(v, 0x5b, 0x5d));
+        sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+        sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+        sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, _mm_set1_epi8('{')));
+        sep = _mm_or_si128(sep, _mm_cmpeq_epi8(v, _mm_set1_epi8('}')));
+        __m128i token = _mm_andnot_si128(sep, inRange128(v, 0x21, 0x7e));
+        int mask = ~_mm_movemask_epi8(token) & 0xffff;
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + scalarFindNonToken(data + i, size - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i inRange256(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(lo)), v),
+                            _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(hi)), v));
+}
+
+__attribute__((target("avx2"))) size_t avx2FindControl(char const *data, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + i));
+        __m256i ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')),
+                                          inRange256(v, 0x00, 0x1f));
+        ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(ctl));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + sse2FindControl(data + i, size - i);
+}
+
+__attribute__((target("avx2"))) size_t avx2FindNonToken(char const *data, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + i));
+        __m256i sep = _mm256_or_si256(inRange256(v, 0x28, 0x29), inRange256(v, 0x3a, 0x40));
+        sep = _mm256_or_si256(sep, inRange256(v, 0x5b, 0x5d));
+        sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+        sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+        sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')));
+        sep = _mm256_or_si256(sep, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}')));
+        __m256i token = _mm256_andnot_si256(sep, inRange256(v, 0x21, 0x7e));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(token));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + sse2FindNonToken(data + i, size - i);
+}
+
+Kernels const kernels[] = {{scalarFindControl, scalarFindNonToken},
+                           {sse2FindControl, sse2FindNonToken},
+                           {avx2FindControl, avx2FindNonToken}};
+
+Level detect() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SSE2;
+    return SCALAR;
+}
+
+#else
+
+Kernels const kernels[] = {{scalarFindControl, scalarFindNonToken},
+                           {scalarFindControl, scalarFindNonToken},
+                           {scalarFindControl, scalarFindNonToken}};
+
+Level detect() { return SCALAR; }
+
+#endif
+
+Level active = detect();
+
+} // namespace
+
+size_t findControl(char const *data, size_t size) {
+    return kernels[active].findControl(data, size);
+}
+
+size_t findNonToken(char const *data, size_t size) {
+    return kernels[active].findNonToken(data, size);
+}
+
+Level level() { return active; }
+
+Level setLevel(Level requested) {
+    Level best = detect();
+    active = requested > best ? best : requested;
+    return active;
+}
+
+char const *levelName(Level level) {
+    switch (level) {
+    case AVX2:
+        return "avx2";
+    case SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+} // namespace scan
+} // namespace http
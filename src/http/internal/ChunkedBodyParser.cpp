@@ -1,6 +1,8 @@
 #include "http/internal/ChunkedBodyParser.hpp"
+#include "http/internal/ByteScan.hpp"
 #include <algorithm>
 #include <climits>
+#include <cstring>
 
 namespace http {
 
@@ -19,7 +21,8 @@ int hexDigitValue(char c) {
 }
 
 size_t findCRLF(const char* input, size_t size) {
-    for (size_t i = 0; i + 1 < size; ++i) {
+    for (size_t i = scan::findControl(input, size); i + 1 < size;
+         i += 1 + scan::findControl(input + i + 1, size - i - 1)) {
         if (input[i] == '\r' && input[i + 1] == '\n')
             return i;
     }
@@ -82,12 +85,12 @@ ChunkedBodyParser::ParseResult ChunkedBodyParser::setError(HttpStatus status) {
     return ParseResult::error();
 }
 
-bool ChunkedBodyParser::parseHex(const std::string& hex, size_t& result) const {
-    if (hex.empty())
+bool ChunkedBodyParser::parseHex(const char* hex, size_t length, size_t& result) const {
+    if (length == 0)
         return false;
 
     result = 0;
-    for (size_t i = 0; i < hex.size(); ++i) {
+    for (size_t i = 0; i < length; ++i) {
         int digit = hexDigitValue(hex[i]);
         if (digit < 0)
             return false;
@@ -103,28 +106,37 @@ ChunkedBodyParser::ParseResult ChunkedBodyParser::readSize(
     std::string* outputPtr = &output;
     (void)outputPtr;
 
+    // The size line usually arrives whole: parse it in place, buffer only a partial one
+    if (sizeBuffer_.empty()) {
+        size_t crlfPos = findCRLF(input, size);
+        if (crlfPos != NPOS)
+            return onSizeLine(input, crlfPos, crlfPos + 2);
+    }
+
+    // Never buffer past the first LF: the line cannot extend beyond it
+    const void* lf = std::memchr(input, '\n', size);
+    size_t take = lf ? static_cast<const char*>(lf) - input + 1 : size;
     size_t prevBufferLen = sizeBuffer_.size();
-    sizeBuffer_.append(input, size);
+    sizeBuffer_.append(input, take);
 
     size_t crlfPos = findCRLF(sizeBuffer_.c_str(), sizeBuffer_.size());
     if (crlfPos == NPOS)
-        return ParseResult::success(size);
-
-    std::string hex = sizeBuffer_.substr(0, crlfPos);
-    size_t lineEndInBuffer = crlfPos + 2;
-    size_t consumedFromInput = 0;
-    if (lineEndInBuffer > prevBufferLen)
-        consumedFromInput = lineEndInBuffer - prevBufferLen;
+        return ParseResult::success(take);
 
+    std::string line = sizeBuffer_.substr(0, crlfPos);
     sizeBuffer_.clear();
+    return onSizeLine(line.c_str(), line.size(), crlfPos + 2 - prevBufferLen);
+}
 
+ChunkedBodyParser::ParseResult ChunkedBodyParser::onSizeLine(
+    const char* line, size_t length, size_t consumed) {
     size_t chunkSize = 0;
-    if (!parseHex(hex, chunkSize))
+    if (!parseHex(line, length, chunkSize))
         return setError(BAD_REQUEST);
 
     if (chunkSize == 0) {
         state_ = READING_FINAL_CRLF;
-        return ParseResult::success(consumedFromInput);
+        return ParseResult::success(consumed);
     }
 
     if (maxBodySize_ > 0 && totalBytesWritten_ + chunkSize > maxBodySize_)
@@ -132,7 +144,7 @@ ChunkedBodyParser::ParseResult ChunkedBodyParser::readSize(
 
     bytesRemainingInChunk_ = chunkSize;
     state_ = READING_DATA;
-    return ParseResult::success(consumedFromInput);
+    return ParseResult::success(consumed);
 }
 
 ChunkedBodyParser::ParseResult ChunkedBodyParser::readData(
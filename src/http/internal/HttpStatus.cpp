@@ -1,4 +1,5 @@
 #include "http/HttpStatus.hpp"
+#include "common/string.hpp"
 #include <cstdlib>
 #include <string>
 
@@ -27,6 +28,7 @@ HttpStatus toHttpStatus(int code) {
         case 403: return FORBIDDEN;
         case 404: return NOT_FOUND;
         case 405: return METHOD_NOT_ALLOWED;
+        case 408: return REQUEST_TIMEOUT;
         case 409: return CONFLICT;
         case 411: return LENGTH_REQUIRED;
         case 413: return PAYLOAD_TOO_LARGE;
@@ -36,6 +38,7 @@ HttpStatus toHttpStatus(int code) {
         case 500: return INTERNAL_SERVER_ERROR;
         case 501: return NOT_IMPLEMENTED;
         case 502: return BAD_GATEWAY;
+        case 504: return GATEWAY_TIMEOUT;
 
         default: return UNKNOWN_STATUS;
         // clang-format on
@@ -70,6 +73,7 @@ const char *getReasonPhrase(HttpStatus status) {
         case FORBIDDEN: return "Forbidden";
         case NOT_FOUND: return "Not Found";
         case METHOD_NOT_ALLOWED: return "Method Not Allowed";
+        case REQUEST_TIMEOUT: return "Request Timeout";
         case CONFLICT: return "Conflict";
         case LENGTH_REQUIRED: return "Length Required";
         case PAYLOAD_TOO_LARGE: return "Payload Too Large";
@@ -79,10 +83,40 @@ const char *getReasonPhrase(HttpStatus status) {
         case INTERNAL_SERVER_ERROR: return "Internal Server Error";
         case NOT_IMPLEMENTED: return "Not Implemented";
         case BAD_GATEWAY: return "Bad Gateway";
+        case GATEWAY_TIMEOUT: return "Gateway Timeout";
 
         default: return "Unknown Status";
         // clang-format on
     }
 }
 
+namespace {
+
+const int MAX_STATUS = 600;
+
+/** Status lines indexed by code; codes without an HttpStatus share UNKNOWN_STATUS's. */
+struct StatusLines {
+    std::string lines[MAX_STATUS];
+
+    StatusLines() {
+        for (int code = 0; code < MAX_STATUS; ++code) {
+            HttpStatus status = toHttpStatus(code);
+            if (code != 0 && status == UNKNOWN_STATUS)
+                continue;
+            lines[code] = "HTTP/1.1 " + utils::toString(code) + " " + getReasonPhrase(status) +
+                          "\r\n";
+        }
+    }
+};
+
+} // namespace
+
+std::string const &getStatusLine(HttpStatus status) {
+    static StatusLines const table;
+    int code = static_cast<int>(status);
+    if (code < 0 || code >= MAX_STATUS || table.lines[code].empty())
+        code = UNKNOWN_STATUS;
+    return table.lines[code];
+}
+
 } // namespace http
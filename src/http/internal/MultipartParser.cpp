@@ -0,0 +1,283 @@
+#include "http/internal/MultipartParser.hpp"
+#include "common/string.hpp"
+#include "utils/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace http {
+
+namespace {
+
+/** RFC 2046: a boundary is 1 to 70 characters. */
+const size_t MAX_BOUNDARY_SIZE = 70;
+
+/**
+ * @brief Reads the next `key=value` parameter of a header value from @p pos, where the
+ * value may be a quoted string with backslash escapes. Keys are lowercased.
+ * @return false once there are no parameters left.
+ */
+bool nextParam(std::string const &str, size_t &pos, std::string &key, std::string &value) {
+    while (pos < str.size() && (str[pos] == ';' || str[pos] == ' ' || str[pos] == '\t'))
+        ++pos;
+    if (pos >= str.size())
+        return false;
+    size_t keyEnd = str.find_first_of("=;", pos);
+    key = utils::trim(str.substr(pos, keyEnd - pos));
+    utils::toLower(key);
+    value.clear();
+    pos = keyEnd;
+    if (pos == std::string::npos || str[pos] == ';') {
+        pos = std::min(pos, str.size());
+        return true;
+    }
+    ++pos; // '='
+    while (pos < str.size() && (str[pos] == ' ' || str[pos] == '\t'))
+        ++pos;
+    if (pos < str.size() && str[pos] == '"') {
+        for (++pos; pos < str.size() && str[pos] != '"'; ++pos) {
+            if (str[pos] == '\\' && pos + 1 < str.size())
+                ++pos;
+            value += str[pos];
+        }
+        pos = std::min(pos + 1, str.size());
+    } else {
+        size_t end = std::min(str.find(';', pos), str.size());
+        value = utils::trim(str.substr(pos, end - pos));
+        pos = end;
+    }
+    return true;
+}
+
+/** @brief The lowercased media type of a header value, without its parameters. */
+std::string mediaType(std::string const &value, size_t &paramsStart) {
+    paramsStart = std::min(value.find(';'), value.size());
+    std::string type = utils::trim(value.substr(0, paramsStart));
+    utils::toLower(type);
+    return type;
+}
+
+} // namespace
+
+MultipartPart::MultipartPart() : hasFilename(false) {}
+
+MultipartParser::MultipartParser(std::string const &boundary, IMultipartHandler &handler)
+    : delimiter_("\r\n--" + boundary), handler_(handler), state_(PREAMBLE),
+      held_("\r\n"), // The first delimiter may open the body, without a CRLF of its own
+      errorStatus_(OK) {
+    size_t last = delimiter_.size() - 1;
+    std::fill(skip_, skip_ + 256, delimiter_.size());
+    for (size_t i = 0; i < last; ++i)
+        skip_[static_cast<unsigned char>(delimiter_[i])] = last - i;
+}
+
+MultipartParser::Status MultipartParser::feed(char const *data, size_t size) {
+    while (size > 0 && state_ != DONE && state_ != ERROR) {
+        size_t consumed;
+        if (state_ == PREAMBLE || state_ == PART_DATA)
+            consumed = scanContent(data, size);
+        else if (state_ == AFTER_BOUNDARY)
+            consumed = readBoundaryEnd(data, size);
+        else
+            consumed = readPartHeaders(data, size);
+        data += consumed;
+        size -= consumed;
+    }
+    return status();
+}
+
+MultipartParser::Status MultipartParser::status() const {
+    if (state_ == DONE)
+        return PARSE_DONE;
+    return state_ == ERROR ? PARSE_ERROR : PARSE_CONTINUE;
+}
+
+HttpStatus MultipartParser::errorStatus() const { return errorStatus_; }
+
+bool MultipartParser::boundaryOf(std::string const &contentType, std::string &boundary) {
+    size_t pos;
+    if (mediaType(contentType, pos) != "multipart/form-data")
+        return false;
+    std::string key, value;
+    while (nextParam(contentType, pos, key, value)) {
+        if (key != "boundary")
+            continue;
+        if (value.empty() || value.size() > MAX_BOUNDARY_SIZE ||
+            value.find_first_of("\r\n") != std::string::npos)
+            return false;
+        boundary = value;
+        return true;
+    }
+    return false;
+}
+
+size_t MultipartParser::scanContent(char const *data, size_t size) {
+    size_t length = delimiter_.size();
+    if (!held_.empty()) {
+        // The seam: a delimiter may start in the held bytes and end in this piece
+        size_t heldSize = held_.size();
+        std::string seam(held_);
+        seam.append(data, std::min(size, length - 1));
+        held_.clear();
+        size_t pos = findDelimiter(seam.data(), seam.size());
+        if (pos < seam.size()) {
+            if (!emit(seam.data(), pos) || !onDelimiter())
+                return size;
+            return pos + length - heldSize;
+        }
+        if (size < length - 1) { // Too short to tell: hold on to what may still match
+            size_t keep = partialDelimiter(seam.data(), seam.size());
+            if (!emit(seam.data(), seam.size() - keep))
+                return size;
+            held_.assign(seam, seam.size() - keep, keep);
+            return size;
+        }
+        // No delimiter starts in the held bytes; this piece is searched on its own
+        emit(seam.data(), heldSize);
+        return 0;
+    }
+    size_t pos = findDelimiter(data, size);
+    if (pos < size) {
+        if (!emit(data, pos) || !onDelimiter())
+            return size;
+        return pos + length;
+    }
+    size_t keep = partialDelimiter(data, size);
+    if (!emit(data, size - keep))
+        return size;
+    held_.assign(data + size - keep, keep);
+    return size;
+}
+
+size_t MultipartParser::readBoundaryEnd(char const *data, size_t size) {
+    size_t i = 0;
+    for (; i < size && buffer_.size() < 2; ++i) {
+        if (buffer_.empty() && (data[i] == ' ' || data[i] == '\t'))
+            continue; // Transport padding
+        buffer_ += data[i];
+    }
+    if (buffer_.size() < 2)
+        return i;
+    if (buffer_ == "--") {
+        state_ = DONE;
+    } else if (buffer_ == "\r\n") {
+        state_ = PART_HEADERS;
+    } else {
+        LOG_SDEBUG("garbage after a multipart boundary");
+        setError(BAD_REQUEST);
+        return size;
+    }
+    buffer_ = "\r\n"; // An empty header block is then found as CRLF CRLF too
+    return i;
+}
+
+size_t MultipartParser::readPartHeaders(char const *data, size_t size) {
+    // The terminator may have begun in the last piece, or be the CRLF readBoundaryEnd() left
+    size_t from = buffer_.size() < 3 ? 0 : buffer_.size() - 3;
+    size_t take = std::min(size, MAX_PART_HEADER_SIZE + 2 - buffer_.size());
+    buffer_.append(data, take);
+    size_t end = buffer_.find("\r\n\r\n", from);
+    if (end == std::string::npos) {
+        if (buffer_.size() < MAX_PART_HEADER_SIZE + 2)
+            return take;
+        LOG_SDEBUG("multipart part headers over " << MAX_PART_HEADER_SIZE << " bytes");
+        setError(BAD_REQUEST);
+        return size;
+    }
+    size_t consumed = take - (buffer_.size() - end - 4);
+    MultipartPart part;
+    if (!parsePartHeaders(end > 2 ? buffer_.substr(2, end - 2) : "", part)) {
+        setError(BAD_REQUEST);
+        return size;
+    }
+    buffer_.clear();
+    state_ = PART_DATA;
+    if (!handler_.onPartBegin(part))
+        setError(BAD_REQUEST);
+    return consumed;
+}
+
+bool MultipartParser::parsePartHeaders(std::string const &block, MultipartPart &part) const {
+    bool hasDisposition = false;
+    size_t lineStart = 0;
+    while (lineStart < block.size()) {
+        size_t lineEnd = std::min(block.find("\r\n", lineStart), block.size());
+        std::string line = block.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0)
+            return false;
+        std::string name = line.substr(0, colon);
+        utils::toLower(name);
+        std::string value = utils::trim(line.substr(colon + 1));
+        if (name == "content-type") {
+            part.contentType = value;
+        } else if (name == "content-disposition") {
+            size_t pos;
+            if (mediaType(value, pos) != "form-data")
+                return false;
+            hasDisposition = true;
+            std::string key, param;
+            while (nextParam(value, pos, key, param)) {
+                if (key == "name") {
+                    part.name = param;
+                } else if (key == "filename") {
+                    part.filename = param;
+                    part.hasFilename = true;
+                }
+            }
+        }
+    }
+    return hasDisposition; // RFC 7578 4.2: required in every part
+}
+
+size_t MultipartParser::findDelimiter(char const *data, size_t size) const {
+    size_t length = delimiter_.size();
+    size_t last = length - 1;
+    char const *delimiter = delimiter_.data();
+    for (size_t i = 0; i + length <= size;) {
+        unsigned char c = data[i + last];
+        if (c == static_cast<unsigned char>(delimiter[last]) &&
+            std::memcmp(data + i, delimiter, last) == 0)
+            return i;
+        i += skip_[c];
+    }
+    return size;
+}
+
+size_t MultipartParser::partialDelimiter(char const *data, size_t size) const {
+    for (size_t length = std::min(size, delimiter_.size() - 1); length > 0; --length) {
+        char const *start = data + size - length;
+        if (*start == '\r' && std::memcmp(start, delimiter_.data(), length) == 0)
+            return length;
+    }
+    return 0;
+}
+
+bool MultipartParser::emit(char const *data, size_t size) {
+    if (state_ != PART_DATA || size == 0)
+        return true;
+    if (!handler_.onPartData(data, size)) {
+        setError(BAD_REQUEST);
+        return false;
+    }
+    return true;
+}
+
+bool MultipartParser::onDelimiter() {
+    if (state_ == PART_DATA && !handler_.onPartEnd()) {
+        setError(BAD_REQUEST);
+        return false;
+    }
+    state_ = AFTER_BOUNDARY;
+    buffer_.clear();
+    return true;
+}
+
+MultipartParser::Status MultipartParser::setError(HttpStatus status) {
+    state_ = ERROR;
+    errorStatus_ = status;
+    return PARSE_ERROR;
+}
+
+} // namespace http
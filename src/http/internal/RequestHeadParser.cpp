@@ -0,0 +1,115 @@
+#include "http/internal/RequestHeadParser.hpp"
+#include "http/internal/ByteScan.hpp"
+
+namespace http {
+
+namespace {
+
+bool isWhitespace(char c) { return c == ' ' || c == '\t'; }
+
+} // namespace
+
+RequestHeadParser::RequestHeadParser() { reset(); }
+
+void RequestHeadParser::reset(size_t offset) {
+    scanned_ = offset;
+    lineStart_ = offset;
+    headEnd_ = 0;
+    hasRequestLine_ = false;
+    method_.offset = method_.length = 0;
+    target_.offset = target_.length = 0;
+    version_.offset = version_.length = 0;
+    fields_.clear();
+}
+
+RequestHeadParser::Status RequestHeadParser::parse(char const *data, size_t size) {
+    if (headEnd_)
+        return HEAD_COMPLETE;
+    while (scanned_ < size) {
+        // One pass finds the line end and rejects control characters inside the line
+        size_t pos = scanned_ + scan::findControl(data + scanned_, size - scanned_);
+        if (pos == size) {
+            scanned_ = size;
+            return HEAD_INCOMPLETE;
+        }
+        size_t end = pos;
+        if (data[pos] == '\r') {
+            if (pos + 1 == size) { // Resume at the CR once its LF arrives
+                scanned_ = pos;
+                return HEAD_INCOMPLETE;
+            }
+            if (data[++pos] != '\n')
+                return HEAD_ERROR;
+        } else if (data[pos] != '\n') {
+            return HEAD_ERROR;
+        }
+        size_t begin = lineStart_;
+        scanned_ = lineStart_ = pos + 1;
+
+        if (!hasRequestLine_) {
+            if (begin == end) // RFC 9112 2.2: ignore empty lines before the request line
+                continue;
+            if (!parseRequestLine(data, begin, end))
+                return HEAD_ERROR;
+            hasRequestLine_ = true;
+        } else if (begin == end) {
+            headEnd_ = scanned_;
+            return HEAD_COMPLETE;
+        } else if (!parseField(data, begin, end)) {
+            return HEAD_ERROR;
+        }
+    }
+    return HEAD_INCOMPLETE;
+}
+
+bool RequestHeadParser::parseRequestLine(char const *data, size_t begin, size_t end) {
+    Span *parts[] = {&method_, &target_, &version_};
+    size_t count = 0;
+    size_t i = begin;
+    while (i < end) {
+        if (isWhitespace(data[i])) {
+            i++;
+            continue;
+        }
+        if (count == 3)
+            return false;
+        size_t start = i;
+        while (i < end && !isWhitespace(data[i]))
+            i++;
+        parts[count]->offset = start;
+        parts[count]->length = i - start;
+        count++;
+    }
+    return count == 3;
+}
+
+bool RequestHeadParser::parseField(char const *data, size_t begin, size_t end) {
+    size_t colon = begin + scan::findNonToken(data + begin, end - begin);
+    if (colon == begin || colon == end || data[colon] != ':')
+        return false;
+
+    size_t valueBegin = colon + 1;
+    while (valueBegin < end && isWhitespace(data[valueBegin]))
+        valueBegin++;
+    size_t valueEnd = end;
+    while (valueEnd > valueBegin && isWhitespace(data[valueEnd - 1]))
+        valueEnd--;
+
+    Headers::RawField field;
+    field.nameOffset = begin;
+    field.nameLength = colon - begin;
+    field.valueOffset = valueBegin;
+    field.valueLength = valueEnd - valueBegin;
+    fields_.push_back(field);
+    return true;
+}
+
+// clang-format off
+RequestHeadParser::Span RequestHeadParser::method() const { return method_; }
+RequestHeadParser::Span RequestHeadParser::target() const { return target_; }
+RequestHeadParser::Span RequestHeadParser::version() const { return version_; }
+Headers::RawFields &RequestHeadParser::fields() { return fields_; }
+size_t RequestHeadParser::headEnd() const { return headEnd_; }
+// clang-format on
+
+} // namespace http
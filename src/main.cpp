@@ -1,9 +1,14 @@
 #include "config/ServerConfig.hpp"
 #include "config/internal/ConfigException.hpp"
 #include "core/Server.hpp"
+#include "http/handlers/CGIHandler.hpp"
 #include "utils/Logger.hpp"
+#include <cstring>
 
 int main(int argc, char **argv) {
+    // Started by a worker between posix_spawn() and a CGI script (see http::CGIHandler)
+    if (argc > 1 && std::strcmp(argv[1], http::CGIHandler::LIMITS_WRAPPER) == 0)
+        return http::CGIHandler::execWithLimits(argc, argv);
     if (argc < 2) {
         LOG_ERROR("Config file should be provided");
         return 1;
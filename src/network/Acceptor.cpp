@@ -5,11 +5,10 @@
 #include "network/ClientHandler.hpp"
 #include "network/EventDispatcher.hpp"
 #include "network/Socket.hpp"
+#include "utils/Logger.hpp"
 #include <arpa/inet.h>
 #include <cerrno>
 #include <cstring>
-#include <fcntl.h>
-#include <iostream>
 #include <sys/socket.h>
 
 namespace {
@@ -29,16 +28,18 @@ std::string socketAddrToString(struct sockaddr_in const &addr) {
 
 namespace network {
 
-Acceptor::Acceptor(int port, http::Router const &router)
-    : socket_(port), port_(port), router_(router) {
-    if (listen(socket_.getFd(), 10) < 0) {
+Acceptor::Acceptor(int port, config::ListenOptions const &options, http::Router const &router,
+                   EventDispatcher &dispatcher, bool reusePort)
+    : socket_(port, reusePort, options), port_(port), router_(router), dispatcher_(dispatcher) {
+    if (listen(socket_.getFd(), options.backlog) < 0) {
         throw std::runtime_error("Failed to listen on socket: " + std::string(strerror(errno)));
     }
 }
 
-Acceptor::Acceptor(config::ServerBlock const &s, http::Router const &router)
-    : socket_(s), router_(router) {
-    if (listen(socket_.getFd(), 10) < 0) {
+Acceptor::Acceptor(config::ServerBlock const &s, http::Router const &router,
+                   EventDispatcher &dispatcher, bool reusePort)
+    : socket_(s, reusePort), router_(router), dispatcher_(dispatcher) {
+    if (listen(socket_.getFd(), s.listenOptions().backlog) < 0) {
         throw std::runtime_error("Failed to listen on socket: " + std::string(strerror(errno)));
     }
     port_ = s.port();
@@ -48,32 +49,33 @@ Acceptor::~Acceptor() {}
 
 void Acceptor::handleEvent(uint32_t events) {
     if (events & EPOLLIN) {
-        acceptNewConnection();
+        acceptNewConnections();
     }
 }
 
 int Acceptor::getFd() const { return socket_.getFd(); }
 
-void Acceptor::acceptNewConnection() {
-    struct sockaddr_in clientaddr;
-    socklen_t len = sizeof(clientaddr);
-
-    int clientFd = accept(socket_.getFd(), reinterpret_cast<sockaddr *>(&clientaddr), &len);
-    if (clientFd < 0) {
-        std::cerr << "Accept error: " << strerror(errno) << std::endl;
-        return;
+void Acceptor::acceptNewConnections() {
+    for (;;) {
+        struct sockaddr_in clientaddr;
+        socklen_t len = sizeof(clientaddr);
+
+        // Non-blocking and close-on-exec from the start: no fcntl() calls, no leak into CGI
+        int clientFd = accept4(socket_.getFd(), reinterpret_cast<sockaddr *>(&clientaddr), &len,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                LOG_ERROR("Acceptor(" << port_ << "): accept4: " << strerror(errno));
+            return;
+        }
+
+        // Pass client address to ClientHandler
+        ClientHandler *clientHandler = new ClientHandler(
+            clientFd, port_, socketAddrToString(clientaddr), router_, dispatcher_);
+        dispatcher_.registerHandler(clientHandler);
     }
-
-    // Convert client address to string
-    std::string clientAddrStr = socketAddrToString(clientaddr);
-
-    // Set non-blocking
-    int flags = fcntl(clientFd, F_GETFL, 0);
-    fcntl(clientFd, F_SETFL, flags | O_NONBLOCK);
-
-    // Pass client address to ClientHandler
-    ClientHandler *clientHandler = new ClientHandler(clientFd, port_, clientAddrStr, router_);
-    EventDispatcher::getInstance().registerHandler(clientHandler);
 }
 
 } // namespace network
@@ -0,0 +1,128 @@
+#include "network/ChildReaper.hpp"
+#include "network/EventDispatcher.hpp"
+#include "network/TimerWheel.hpp"
+#include "utils/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace network {
+
+const uint64_t ChildReaper::KILL_DELAY_MS;
+const uint64_t ChildReaper::KILLED;
+ChildReaper *ChildReaper::instance_ = NULL;
+
+namespace {
+
+/** Signals the script's process group (see http::CGIHandler::spawn()), or the script. */
+void signalChild(pid_t pid, int sig) {
+    if (kill(-pid, sig) == -1)
+        kill(pid, sig);
+}
+
+} // namespace
+
+ChildReaper::ChildReaper(EventDispatcher &dispatcher) : dispatcher_(dispatcher), fd_(-1) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &mask, &previousMask_) == -1)
+        throw std::runtime_error("Failed to block SIGCHLD: " + std::string(strerror(errno)));
+    fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd_ == -1) {
+        int error = errno;
+        sigprocmask(SIG_SETMASK, &previousMask_, NULL);
+        throw std::runtime_error("Failed to create the SIGCHLD signalfd: " +
+                                 std::string(strerror(error)));
+    }
+    // Children that exited before the mask was set sent their SIGCHLD already
+    reap();
+    instance_ = this;
+}
+
+ChildReaper::~ChildReaper() {
+    if (instance_ == this)
+        instance_ = NULL;
+    close(fd_);
+    sigprocmask(SIG_SETMASK, &previousMask_, NULL);
+}
+
+void ChildReaper::handleEvent(uint32_t) {
+    // Pending SIGCHLDs merge into one: the records only say that some child exited
+    struct signalfd_siginfo info[8];
+    while (read(fd_, info, sizeof(info)) > 0)
+        ;
+    reap();
+}
+
+void ChildReaper::handleTimeout() {
+    uint64_t now = TimerWheel::now();
+    for (ChildMap::iterator it = children_.begin(); it != children_.end(); ++it) {
+        if (it->second == 0 || it->second == KILLED || it->second > now)
+            continue;
+        LOG_WARN("CGI process " << it->first << " ignored SIGTERM, sending SIGKILL");
+        signalChild(it->first, SIGKILL);
+        it->second = KILLED;
+    }
+    armKillTimer();
+}
+
+int ChildReaper::getFd() const { return fd_; }
+
+bool ChildReaper::supportsEdgeTriggered() const { return true; }
+
+size_t ChildReaper::reap() {
+    size_t count = 0;
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        ++count;
+        children_.erase(pid);
+        if (WIFEXITED(status)) {
+            LOG_DEBUG("CGI process " << pid << " exited with status " << WEXITSTATUS(status));
+        } else if (WTERMSIG(status) == SIGPIPE) {
+            // How a script learns that nobody reads its output any more
+            LOG_DEBUG("CGI process " << pid << " stopped by SIGPIPE");
+        } else {
+            LOG_WARN("CGI process " << pid << " killed by signal " << WTERMSIG(status));
+        }
+    }
+    return count;
+}
+
+void ChildReaper::watch(pid_t pid) {
+    if (instance_ && pid > 0)
+        instance_->children_[pid] = 0;
+}
+
+void ChildReaper::terminate(pid_t pid) {
+    if (!instance_)
+        return;
+    ChildMap::iterator it = instance_->children_.find(pid);
+    if (it == instance_->children_.end() || it->second != 0)
+        return;
+    LOG_DEBUG("Terminating CGI process " << pid);
+    signalChild(pid, SIGTERM);
+    it->second = TimerWheel::now() + KILL_DELAY_MS;
+    instance_->armKillTimer();
+}
+
+void ChildReaper::armKillTimer() {
+    uint64_t next = KILLED;
+    for (ChildMap::const_iterator it = children_.begin(); it != children_.end(); ++it) {
+        if (it->second != 0 && it->second < next)
+            next = it->second;
+    }
+    if (next == KILLED) {
+        dispatcher_.cancelTimeout(this);
+        return;
+    }
+    uint64_t now = TimerWheel::now();
+    dispatcher_.setTimeout(this, next > now ? next - now : 0);
+}
+
+} // namespace network
@@ -1,17 +1,23 @@
 #include "network/ClientHandler.hpp"
 #include "common/string.hpp"
+#include "http/BodyPipe.hpp"
 #include "http/HttpStatus.hpp"
 #include "http/ResponseBody.hpp"
 #include "http/Router.hpp"
 #include "network/CGIHandler.hpp"
+#include "network/CgiInputHandler.hpp"
 #include "network/EventDispatcher.hpp"
+#include "utils/BufferPool.hpp"
 #include "utils/Logger.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
-#include <ctime>
+#include <fcntl.h>
 #include <string>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace network {
@@ -21,7 +27,11 @@ namespace network {
 // =============================================================================
 
 ClientHandler::SendBuffer::SendBuffer(size_t initialCapacity) : sent(0) {
-    buffer.reserve(initialCapacity);
+    utils::BufferPool<std::vector<char> >::getInstance().acquire(buffer, initialCapacity);
+}
+
+ClientHandler::SendBuffer::~SendBuffer() {
+    utils::BufferPool<std::vector<char> >::getInstance().release(buffer);
 }
 
 void ClientHandler::SendBuffer::reset() {
@@ -33,61 +43,125 @@ bool ClientHandler::SendBuffer::isFullySent() const {
     return buffer.empty() || sent >= buffer.size();
 }
 
-ClientHandler::SendBuffer::SendStatus ClientHandler::SendBuffer::send(int clientFd) {
-    if (isFullySent())
-        return SEND_DONE;
-
-    size_t bytes_to_send = buffer.size() - sent;
-    ssize_t bytes_sent = ::send(clientFd, buffer.data() + sent, bytes_to_send, 0);
-
-    if (bytes_sent < 0) {
-        LOG_SERROR(strerror(errno));
-        return SEND_AGAIN;
+ClientHandler::SendBuffer::SendStatus ClientHandler::SendBuffer::send(int clientFd,
+                                                                      http::IResponseBody *body) {
+    char const *data = NULL;
+    size_t dataLen = 0;
+    int fileFd = -1;
+    off_t offset = 0;
+    size_t fileLen = 0;
+    if (body && !body->isDone()) {
+        if (!body->memoryRegion(data, dataLen))
+            dataLen = 0;
+        if (!body->fileRegion(fileFd, offset, fileLen))
+            fileLen = 0;
     }
 
-
-    sent += bytes_sent;
-
-    if (sent == buffer.size()) {
+    size_t pending = buffer.size() - sent;
+    if (pending + dataLen > 0) {
+        struct iovec iov[2];
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        if (pending) {
+            iov[msg.msg_iovlen].iov_base = &buffer[sent];
+            iov[msg.msg_iovlen++].iov_len = pending;
+        }
+        if (dataLen) {
+            iov[msg.msg_iovlen].iov_base = const_cast<char *>(data);
+            iov[msg.msg_iovlen++].iov_len = dataLen;
+        }
+        ssize_t bytesSent = ::sendmsg(clientFd, &msg, fileLen ? MSG_MORE : 0);
+        if (bytesSent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return SEND_AGAIN;
+            LOG_SERROR(strerror(errno));
+            return SEND_ERROR;
+        }
+        size_t fromBuffer = std::min(static_cast<size_t>(bytesSent), pending);
+        sent += fromBuffer;
+        if (static_cast<size_t>(bytesSent) > fromBuffer)
+            body->consume(bytesSent - fromBuffer);
+        if (sent < buffer.size() || static_cast<size_t>(bytesSent) - fromBuffer < dataLen)
+            return SEND_AGAIN;
         reset();
-        return SEND_DONE;
     }
-    return SEND_AGAIN;
+
+    if (fileLen) {
+        size_t chunk = fileLen < SENDFILE_CHUNK_SIZE ? fileLen : SENDFILE_CHUNK_SIZE;
+        ssize_t bytesSent = ::sendfile(clientFd, fileFd, &offset, chunk);
+        if (bytesSent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return SEND_AGAIN;
+            LOG_SERROR("sendfile: " << strerror(errno));
+            return SEND_ERROR;
+        }
+        if (bytesSent == 0) {
+            LOG_SWARN("File shrank while being sent.");
+            return SEND_ERROR;
+        }
+        body->consume(static_cast<size_t>(bytesSent));
+        if (!body->isDone())
+            return static_cast<size_t>(bytesSent) < chunk ? SEND_AGAIN : SEND_PARTIAL;
+    }
+    return SEND_DONE;
 }
 
-ClientHandler::CgiState::CgiState() : handler(NULL), isDone(false) {}
+ClientHandler::CgiState::CgiState() : handler(NULL), input(NULL), pipe(NULL), isDone(false) {}
 
 void ClientHandler::CgiState::clear() {
     handler = NULL;
+    input = NULL;
+    pipe = NULL;
     isDone = false;
 }
-void ClientHandler::CgiState::remove() {
+void ClientHandler::CgiState::remove(EventDispatcher &dispatcher) {
     LOG_SDEBUG("starting removal. Handler: " << (handler ? "present" : "NULL"));
+    removeInput(dispatcher);
     if (!handler)
         return;
-    EventDispatcher::getInstance().removeHandler(handler);
+    dispatcher.removeHandler(handler);
     LOG_SDEBUG("CGI handler removed from dispatcher.");
     clear();
 }
 
+void ClientHandler::CgiState::removeInput(EventDispatcher &dispatcher) {
+    if (!input)
+        return;
+    dispatcher.removeHandler(input); // Out of epoll before its fd closes
+    pipe->close();
+    input = NULL;
+    pipe = NULL;
+}
+
 // =============================================================================
 // ClientHandler Implementation
 // =============================================================================
 
 ClientHandler::ClientHandler(int clientFd, int port, std::string const &clientAddr,
-                             http::Router const &router)
+                             http::Router const &router, EventDispatcher &dispatcher)
     : clientFd_(clientFd),
       port_(port),
       clientAddr_(clientAddr),
       headersSent_(false),
       router_(router),
+      dispatcher_(dispatcher),
       reqParser_(request_, IO_BUFFER_SIZE),
       isKeepAlive_(false),
       isDraining_(false),
-      drainStartTime_(0),
-      rspBuffer_(IO_BUFFER_SIZE) {
-
+      isClosed_(false),
+      isInputDeferred_(false),
+      isDispatching_(false),
+      isFinalizePending_(false),
+      timerPhase_(NO_TIMER),
+      timeouts_(router.config().timeouts()),
+      rspBuffer_(IO_BUFFER_SIZE),
+      bodyPipe_(NULL),
+      spliceFailed_(false) {
+    splicePipe_[0] = -1;
+    splicePipe_[1] = -1;
     resetForNewRequest();
+    armTimer(HEADER_TIMER);
     LOG_DEBUG("ClientHandler(" << clientFd_ << "): connected from " << clientAddr_);
 }
 
@@ -97,11 +171,45 @@ ClientHandler::~ClientHandler() {
         ::close(clientFd_);
         clientFd_ = -1;
     }
-    cgiState_.remove();
+    closeSplicePipe();
+    cgiState_.remove(dispatcher_);
+    delete bodyPipe_;
+}
+
+utils::SlabAllocator &ClientHandler::slab() {
+    static utils::SlabAllocator allocator(sizeof(ClientHandler));
+    return allocator;
+}
+
+void *ClientHandler::operator new(size_t size) {
+    if (size != sizeof(ClientHandler)) // A derived class: not our block size
+        return ::operator new(size);
+    return slab().allocate();
+}
+
+void ClientHandler::operator delete(void *ptr, size_t size) {
+    if (size != sizeof(ClientHandler))
+        return ::operator delete(ptr);
+    slab().deallocate(ptr);
 }
 
 int ClientHandler::getFd() const { return clientFd_; }
 
+EventDispatcher &ClientHandler::dispatcher() const { return dispatcher_; }
+
+bool ClientHandler::supportsEdgeTriggered() const { return true; }
+
+void ClientHandler::handleTimeout() {
+    LOG_SDEBUG("Timer " << timerPhase_ << " expired.");
+    bool midRequest = timerPhase_ == BODY_TIMER ||
+                      (timerPhase_ == HEADER_TIMER && reqParser_.hasLeftoverData());
+    if (midRequest && !headersSent_) {
+        handleError(http::REQUEST_TIMEOUT);
+        return;
+    }
+    closeConnection();
+}
+
 void ClientHandler::handleEvent(uint32_t events) {
     if (events & (EPOLLHUP | EPOLLERR)) {
         LOG_STRACE("EPOLLHUP or EPOLLERR received. Closing.");
@@ -114,7 +222,7 @@ void ClientHandler::handleEvent(uint32_t events) {
         else
             handleRead();
     }
-    if (events & EPOLLOUT) {
+    if ((events & EPOLLOUT) && !isClosed_) {
         if (cgiState_.handler)
             handleCgiResponseWrite();
         else
@@ -127,61 +235,212 @@ void ClientHandler::handleEvent(uint32_t events) {
 // =============================================================================
 
 void ClientHandler::handleRead() {
-    char buffer[IO_BUFFER_SIZE];
-    ssize_t count = ::recv(clientFd_, buffer, IO_BUFFER_SIZE, 0);
-
-    if (count <= 0) {
-        LOG_ERROR("ClientHandler::read(" << clientFd_ << "): error " << strerror(errno));
-        closeConnection();  // EOF - client closed connection
-        return;  // EAGAIN or error - epoll will re-trigger or raise EPOLLERR/EPOLLHUP
+    bool edgeTriggered = dispatcher_.isEdgeTriggered();
+    if (!wantsInput()) {
+        // The next request would pile up in the parser's buffer; leave it in the socket
+        // until finalizeConnection()
+        if (edgeTriggered)
+            isInputDeferred_ = true;
+        else
+            dispatcher_.disableRead(this);
+        return;
     }
-    if (reqParser_.state() == http::RequestParser::ERROR) {
+
+    size_t budget = READ_BUDGET;
+    do {
+        size_t space;
+        ssize_t count;
+        // A body going to a file skips user space: socket -> pipe -> file
+        int bodyFd = reqParser_.spliceTarget(space);
+        if (bodyFd != -1 && openSplicePipe()) {
+            size_t chunk = std::min(space, static_cast<size_t>(SPLICE_CHUNK_SIZE));
+            count = ::splice(clientFd_, NULL, splicePipe_[1], NULL, chunk,
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        } else {
+            bodyFd = -1;
+            char *buffer = reqParser_.inputSpace(IO_BUFFER_SIZE, space);
+            count = ::recv(clientFd_, buffer, space, 0);
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (count < 0 && bodyFd != -1 && errno == EINVAL) {
+            LOG_SDEBUG("splice() unsupported, reading the body with recv()");
+            spliceFailed_ = true;
+            closeSplicePipe();
+            continue;
+        }
+        if (count == 0) {
+            LOG_SDEBUG("client closed the connection");
+            closeConnection();
+            return;
+        }
+        if (count < 0) {
+            LOG_ERROR("ClientHandler::read(" << clientFd_ << "): error " << strerror(errno));
+            closeConnection();
+            return;
+        }
+        if (timerPhase_ == KEEPALIVE_TIMER)
+            armTimer(HEADER_TIMER);
+        if (bodyFd == -1)
+            dispatchRequest(reqParser_.commitInput(static_cast<size_t>(count)));
+        else if (flushSplicePipe(bodyFd, static_cast<size_t>(count)))
+            dispatchRequest(reqParser_.commitSpliced(static_cast<size_t>(count)));
+        else
+            dispatchRequest(reqParser_.fail(http::INTERNAL_SERVER_ERROR));
+        if (reqParser_.state() == http::RequestParser::READING_BODY)
+            armTimer(BODY_TIMER);
+        budget -= std::min(budget, static_cast<size_t>(count));
+    } while (edgeTriggered && budget > 0 && wantsInput());
+
+    updateCgiInput();
+    if (!edgeTriggered || isClosed_)
         return;
+    if (!wantsInput())
+        isInputDeferred_ = true;
+    else
+        dispatcher_.rearm(this); // Budget exhausted, let the other connections run
+}
+
+bool ClientHandler::openSplicePipe() {
+    if (splicePipe_[0] != -1)
+        return true;
+    if (spliceFailed_)
+        return false;
+    if (pipe2(splicePipe_, O_CLOEXEC | O_NONBLOCK) == -1) {
+        LOG_SWARN("pipe2 failed, reading the body with recv(): " << strerror(errno));
+        splicePipe_[0] = -1;
+        splicePipe_[1] = -1;
+        return false;
     }
-    handleRequestParsingState(reqParser_.feed(buffer, static_cast<size_t>(count)));
+    return true;
 }
 
-void ClientHandler::handleDraining() {
-    if (std::time(NULL) - drainStartTime_ > 5) {
-        LOG_SDEBUG("Draining timed out.");
-        closeConnection();
-        return;
+bool ClientHandler::flushSplicePipe(int fileFd, size_t size) {
+    while (size > 0) {
+        ssize_t moved = ::splice(splicePipe_[0], NULL, fileFd, NULL, size, SPLICE_F_MOVE);
+        if (moved < 0 && errno == EINTR)
+            continue;
+        if (moved <= 0) {
+            LOG_SERROR("Failed to write the request body: " << strerror(errno));
+            closeSplicePipe(); // Drops what is left in it
+            return false;
+        }
+        size -= moved;
     }
+    return true;
+}
+
+void ClientHandler::closeSplicePipe() {
+    if (splicePipe_[0] == -1)
+        return;
+    ::close(splicePipe_[0]);
+    ::close(splicePipe_[1]);
+    splicePipe_[0] = -1;
+    splicePipe_[1] = -1;
+}
 
+void ClientHandler::handleDraining() {
     char buffer[IO_BUFFER_SIZE];
-    ssize_t count = ::recv(clientFd_, buffer, IO_BUFFER_SIZE, 0);
+    size_t budget = READ_BUDGET;
+    ssize_t count;
+    do {
+        count = ::recv(clientFd_, buffer, IO_BUFFER_SIZE, 0);
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (count <= 0) {
+            closeConnection();
+            return;
+        }
+        budget -= std::min(budget, static_cast<size_t>(count));
+    } while (dispatcher_.isEdgeTriggered() && budget > 0);
 
-    if (count <= 0) {
-        closeConnection();
+    dispatcher_.rearm(this);
+}
+
+bool ClientHandler::wantsInput() const {
+    http::RequestParser::State state = reqParser_.state();
+    if (isClosed_ || isDraining_)
+        return false;
+    if (state == http::RequestParser::READING_BODY) // The script may already be reading it
+        return !cgiState_.pipe || !cgiState_.pipe->isFull();
+    return state == http::RequestParser::READING_HEADERS && !cgiState_.handler;
+}
+
+void ClientHandler::updateCgiInput() {
+    if (!cgiState_.input)
+        return;
+    http::BodyPipe::Status status = cgiState_.pipe->flush();
+    if (cgiState_.handler)
+        cgiState_.handler->restartTimer(); // The script is still taking its body
+    if (status == http::BodyPipe::DONE) {
+        LOG_SDEBUG("CGI stdin done.");
+        cgiState_.removeInput(dispatcher_);
+    } else if (status == http::BodyPipe::PENDING) {
+        dispatcher_.enableWrite(cgiState_.input);
+    } else {
+        dispatcher_.disableWrite(cgiState_.input);
+    }
+    if (isClosed_ || reqParser_.state() != http::RequestParser::READING_BODY)
         return;
+    if (!wantsInput()) {
+        // The script reads slower than the client sends: the body waits in the socket
+        if (timerPhase_ == BODY_TIMER)
+            armTimer(NO_TIMER);
+        return;
+    }
+    if (timerPhase_ == NO_TIMER)
+        armTimer(BODY_TIMER);
+    dispatcher_.enableRead(this);
+    if (isInputDeferred_) {
+        isInputDeferred_ = false;
+        dispatcher_.rearm(this);
     }
 }
 
+void ClientHandler::onCgiInputWritable() { updateCgiInput(); }
+
+void ClientHandler::dispatchRequest(http::RequestParser::State state) {
+    isDispatching_ = true;
+    handleRequestParsingState(state);
+    isDispatching_ = false;
+    if (isFinalizePending_)
+        finalizeConnection();
+}
+
 void ClientHandler::handleRequestParsingState(http::RequestParser::State state) {
     switch (state) {
     case http::RequestParser::ERROR:
         LOG_SWARN("Request parsing failed with status: " << reqParser_.errorStatus());
+        cgiState_.removeInput(dispatcher_); // A script already reading the body gets EOF
         handleError(reqParser_.errorStatus());
         break;
 
     case http::RequestParser::HEADERS_READY:
         router_.matchServerAndLocation(port_, request_);
-        handleRequestParsingState(reqParser_.proceedReadingBody());
+        state = reqParser_.proceedReadingBody();
+        if (state == http::RequestParser::READING_BODY && request_.body()->pipe()) {
+            // `cgi_request_buffering off`: the script starts now and reads the body as
+            // it arrives, see setupCgiHandler()
+            updateKeepAlive();
+            generateResponse();
+            if (!cgiState_.input)
+                request_.body()->pipe()->close(); // No script reads it: drop the rest
+        }
+        handleRequestParsingState(state);
         break;
 
     case http::RequestParser::REQUEST_READY:
-        router_.matchServerAndLocation(port_, request_);
-        {
-            std::string connectionHeader = request_.headers().get("Connection");
-            utils::toLower(connectionHeader);
-            if (connectionHeader == "keep-alive") {
-                isKeepAlive_ = true;
-            } else if (connectionHeader == "close") {
-                isKeepAlive_ = false;
-            } else {
-                isKeepAlive_ = (request_.version() == "HTTP/1.1");
-            }
+        if (cgiState_.input) {
+            cgiState_.pipe->finish();
+            updateCgiInput();
+            if (timerPhase_ == BODY_TIMER)
+                armTimer(NO_TIMER); // Now waiting on the script only
+            break;
         }
+        if (headersSent_ || cgiState_.handler)
+            break; // Answered while the body was streaming in
+        router_.matchServerAndLocation(port_, request_);
+        updateKeepAlive();
         generateResponse();
         break;
 
@@ -190,6 +449,20 @@ void ClientHandler::handleRequestParsingState(http::RequestParser::State state)
     }
 }
 
+void ClientHandler::updateKeepAlive() {
+    std::string connectionHeader = request_.headers().get(http::header::CONNECTION);
+    utils::toLower(connectionHeader);
+    if (connectionHeader == "keep-alive") {
+        isKeepAlive_ = true;
+    } else if (connectionHeader == "close") {
+        isKeepAlive_ = false;
+    } else {
+        isKeepAlive_ = (request_.version() == "HTTP/1.1");
+    }
+    if (timeouts_.keepalive == 0)
+        isKeepAlive_ = false;
+}
+
 // =============================================================================
 // Response Generation
 // =============================================================================
@@ -221,16 +494,38 @@ bool ClientHandler::setupCgiHandler(http::IResponseBody *body) {
     LOG_SDEBUG("starting CGI handler");
 
     cgiState_.handler = NULL;
+    CGIHandler *handler = NULL;
     try {
-        cgiState_.handler = new CGIHandler(*body, *this, body->hasHeaderParsing());
-        EventDispatcher::getInstance().registerHandler(cgiState_.handler);
-        EventDispatcher::getInstance().disableRead(this);
-        LOG_STRACE("CGI handler registered.");
+        handler = new CGIHandler(*body, *this, body->hasHeaderParsing(), timeouts_);
+        dispatcher_.registerHandler(handler);
+    } catch (std::exception const &e) {
+        LOG_SERROR("Failed to setup CGI: " << e.what());
+        delete handler; // Not registered: still ours
+        return false;
+    }
+    LOG_STRACE("CGI handler registered.");
+    cgiState_.handler = handler;
+    try {
+        http::BodyPipe *pipe = request_.body() ? request_.body()->pipe() : NULL;
+        if (pipe && pipe->fd() != -1) {
+            // The script's stdin is the body pipe: the socket keeps being read into it
+            cgiState_.input = new CgiInputHandler(pipe->fd(), *this);
+            cgiState_.pipe = bodyPipe_ = request_.body()->releasePipe();
+            dispatcher_.registerHandler(cgiState_.input);
+            if (reqParser_.state() != http::RequestParser::READING_BODY)
+                pipe->finish();
+            updateCgiInput();
+        }
+        if (reqParser_.state() != http::RequestParser::READING_BODY) {
+            dispatcher_.disableRead(this);
+            armTimer(NO_TIMER);
+        }
+        handler->start();
         return true;
     } catch (std::exception const &e) {
         LOG_SERROR("Failed to setup CGI: " << e.what());
-        delete cgiState_.handler;
-        cgiState_.handler = NULL;
+        // Registered: the dispatcher deletes them, once nothing can reach them any more
+        cgiState_.remove(dispatcher_);
         return false;
     }
 }
@@ -238,20 +533,23 @@ bool ClientHandler::setupCgiHandler(http::IResponseBody *body) {
 void ClientHandler::setupStaticResponse() {
     LOG_STRACE("preparing static response");
     cgiState_.handler = NULL;
+    if (reqParser_.state() != http::RequestParser::REQUEST_READY)
+        isKeepAlive_ = false; // Answered before the end of the body, see finalizeConnection()
 
-    response_.headers().add("Connection", isKeepAlive_ ? "keep-alive" : "close");
+    response_.headers().add(http::header::CONNECTION, isKeepAlive_ ? "keep-alive" : "close");
 
-    if (!response_.body() && !response_.headers().has("Content-Length")) {
+    if (!response_.body() && !response_.headers().has(http::header::CONTENT_LENGTH)) {
         http::HttpStatus s = response_.status();
         if (s != http::NO_CONTENT && s != http::NOT_MODIFIED && s >= 200) {
-            response_.headers().add("Content-Length", "0");
+            response_.headers().add(http::header::CONTENT_LENGTH, "0");
         }
     }
 
     response_.buildHeaders(rspBuffer_.buffer);
     headersSent_ = true;
 
-    EventDispatcher::getInstance().enableWrite(this);
+    // Most responses fit in the socket buffer: write now instead of waiting for EPOLLOUT
+    handleStaticResponseWrite();
 }
 
 // =============================================================================
@@ -259,17 +557,25 @@ void ClientHandler::setupStaticResponse() {
 // =============================================================================
 
 void ClientHandler::handleStaticResponseWrite() {
-    SendBuffer::SendStatus status = rspBuffer_.send(clientFd_);
+    http::IResponseBody *body = response_.body();
+    SendBuffer::SendStatus status = rspBuffer_.send(clientFd_, body);
     if (status == SendBuffer::SEND_ERROR)
         return closeConnection();
-    if (status == SendBuffer::SEND_AGAIN)
-        return;
+    if (status == SendBuffer::SEND_AGAIN) {
+        armTimer(SEND_TIMER);
+        return dispatcher_.enableWrite(this);
+    }
+    if (status == SendBuffer::SEND_PARTIAL) {
+        armTimer(SEND_TIMER);
+        dispatcher_.enableWrite(this);
+        return dispatcher_.rearm(this);
+    }
 
-    http::IResponseBody *body = response_.body();
     if (!body || body->isDone()) {
         return finalizeConnection();
     }
 
+    // Bodies without a zero-copy region are streamed through the buffer
     rspBuffer_.buffer.resize(rspBuffer_.buffer.capacity());
     ssize_t bytesRead = body->read(rspBuffer_.buffer.data(), rspBuffer_.buffer.capacity());
 
@@ -282,6 +588,10 @@ void ClientHandler::handleStaticResponseWrite() {
     status = rspBuffer_.send(clientFd_);
     if (status == SendBuffer::SEND_ERROR)
         return closeConnection();
+    armTimer(SEND_TIMER);
+    dispatcher_.enableWrite(this);
+    if (status != SendBuffer::SEND_AGAIN)
+        dispatcher_.rearm(this);
 }
 
 // =============================================================================
@@ -293,10 +603,11 @@ void ClientHandler::pushToSendBuffer(const char *data, size_t length) {
     rspBuffer_.buffer.insert(rspBuffer_.buffer.end(), data, data + length);
 
     if (wasEmpty) {
-        EventDispatcher::getInstance().enableWrite(this);
+        armTimer(SEND_TIMER);
+        dispatcher_.enableWrite(this);
     }
-    if (isSendBufferFull())
-        EventDispatcher::getInstance().disableRead(cgiState_.handler);
+    if (isSendBufferFull() && cgiState_.handler)
+        cgiState_.handler->pause();
 }
 
 bool ClientHandler::isSendBufferFull() const { return rspBuffer_.buffer.size() > (1024 * 1024); }
@@ -306,38 +617,40 @@ void ClientHandler::onCgiComplete() {
     cgiState_.isDone = true;
 
     if (cgiState_.handler) {
-        cgiState_.remove();
+        cgiState_.remove(dispatcher_);
     }
 
     if (rspBuffer_.isFullySent()) {
         finalizeConnection();
     } else {
-        EventDispatcher::getInstance().enableWrite(this);
+        dispatcher_.enableWrite(this);
     }
 }
 
 void ClientHandler::onCgiHeadersParsed(http::Headers const &headers) {
     response_.headers() = headers;
 
-    http::Headers::const_iterator it = headers.find("Status");
-    if (it != headers.end()) {
-        http::HttpStatus st = http::toHttpStatus(it->second);
+    std::string status;
+    if (headers.get(http::header::STATUS, status)) {
+        http::HttpStatus st = http::toHttpStatus(status);
         if (st != http::UNKNOWN_STATUS)
             response_.status(st);
-        response_.headers().erase("Status");
+        response_.headers().erase(http::header::STATUS);
     }
 
-    if (!headers.has("Content-Length") && !headers.has("Transfer-Encoding")) {
+    if (!headers.has(http::header::CONTENT_LENGTH) &&
+        !headers.has(http::header::TRANSFER_ENCODING)) {
         LOG_DEBUG("CGI response has no Content-Length, forcing Connection: close");
         isKeepAlive_ = false;
     }
 
-    response_.headers().add("Connection", isKeepAlive_ ? "keep-alive" : "close");
+    response_.headers().add(http::header::CONNECTION, isKeepAlive_ ? "keep-alive" : "close");
     response_.buildHeaders(rspBuffer_.buffer, true);
     headersSent_ = true;
     LOG_SDEBUG("Headers built, activating send.");
 
-    EventDispatcher::getInstance().enableWrite(this);
+    armTimer(SEND_TIMER);
+    dispatcher_.enableWrite(this);
 }
 
 void ClientHandler::handleCgiResponseWrite() {
@@ -351,11 +664,18 @@ void ClientHandler::handleCgiResponseWrite() {
     if (rspBuffer_.isFullySent()) {
         if (cgiState_.isDone || !cgiState_.handler) {
             finalizeConnection();
+        } else if (response_.body()->isDone()) {
+            // Paused after the source saw its end (a FastCGI END_REQUEST): no event will come
+            onCgiComplete();
         } else {
             LOG_SDEBUG("Send buffer empty. Pausing ClientHandler.");
-            EventDispatcher::getInstance().disableWrite(this);
-            EventDispatcher::getInstance().enableRead(cgiState_.handler);
+            bool readingBody = reqParser_.state() == http::RequestParser::READING_BODY;
+            armTimer(readingBody && wantsInput() ? BODY_TIMER : NO_TIMER);
+            dispatcher_.disableWrite(this);
+            cgiState_.handler->resume();
         }
+    } else {
+        armTimer(SEND_TIMER);
     }
 }
 
@@ -363,6 +683,14 @@ void ClientHandler::handleCgiResponseWrite() {
 // Error & Lifecycle Management
 // =============================================================================
 
+void ClientHandler::onCgiTimeout() {
+    if (!headersSent_)
+        return handleError(http::GATEWAY_TIMEOUT);
+    // Part of the script's response is out: the client can only tell from the close
+    cgiState_.remove(dispatcher_);
+    closeConnection();
+}
+
 void ClientHandler::handleError(http::HttpStatus status) {
     LOG_SWARN("Handling error: " << status);
     if (headersSent_) {
@@ -372,9 +700,7 @@ void ClientHandler::handleError(http::HttpStatus status) {
         return;
     }
 
-    if (cgiState_.handler) {
-        cgiState_.remove();
-    }
+    cgiState_.remove(dispatcher_);
 
     isKeepAlive_ = false;
     rspBuffer_.reset();
@@ -383,27 +709,46 @@ void ClientHandler::handleError(http::HttpStatus status) {
 
     router_.handleError(request_, response_);
 
-    response_.headers().add("Connection", "close");
+    response_.headers().add(http::header::CONNECTION, "close");
     response_.buildHeaders(rspBuffer_.buffer);
     headersSent_ = true;
 
-    EventDispatcher::getInstance().enableWrite(this);
+    armTimer(SEND_TIMER);
+    dispatcher_.enableWrite(this);
 }
 
 void ClientHandler::finalizeConnection() {
-    if (isKeepAlive_) {
+    if (isDispatching_) {
+        isFinalizePending_ = true; // See dispatchRequest()
+        return;
+    }
+    do {
+        isFinalizePending_ = false;
+        if (isClosed_)
+            return;
+        if (reqParser_.state() != http::RequestParser::REQUEST_READY)
+            isKeepAlive_ = false; // The rest of the body is still in the socket
+        if (!isKeepAlive_)
+            return initiateDraining();
         LOG_SDEBUG("Keep-Alive. Resetting.");
         resetForNewRequest();
-        EventDispatcher::getInstance().enableRead(this);
-        EventDispatcher::getInstance().disableWrite(this);
+        armTimer(reqParser_.hasLeftoverData() ? HEADER_TIMER : KEEPALIVE_TIMER);
+        dispatcher_.enableRead(this);
+        dispatcher_.disableWrite(this);
 
-        if (reqParser_.hasLeftoverData()) {
-            LOG_DEBUG("Leftover data in buffer, processing next pipelined request");
-            handleRequestParsingState(reqParser_.feed(NULL, 0));
+        if (isInputDeferred_) {
+            isInputDeferred_ = false;
+            dispatcher_.rearm(this);
         }
-    } else {
-        initiateDraining();
-    }
+        if (!reqParser_.hasLeftoverData())
+            return;
+        LOG_DEBUG("Leftover data in buffer, processing next pipelined request");
+        isDispatching_ = true;
+        handleRequestParsingState(reqParser_.feed(NULL, 0));
+        isDispatching_ = false;
+        if (reqParser_.state() == http::RequestParser::READING_BODY)
+            armTimer(BODY_TIMER);
+    } while (isFinalizePending_); // That one was answered at once as well
 }
 
 void ClientHandler::initiateDraining() {
@@ -411,28 +756,58 @@ void ClientHandler::initiateDraining() {
         return;
     LOG_SDEBUG("Slowing down for draining.");
     isDraining_ = true;
-    drainStartTime_ = std::time(NULL);
+    armTimer(DRAIN_TIMER);
     ::shutdown(clientFd_, SHUT_WR);
-    EventDispatcher::getInstance().disableWrite(this);
-    EventDispatcher::getInstance().enableRead(this);
+    dispatcher_.disableWrite(this);
+    dispatcher_.enableRead(this);
+    dispatcher_.rearm(this);
 }
 
 void ClientHandler::closeConnection() {
     LOG_SDEBUG("Initiating connection closure.");
-    cgiState_.remove();
-    EventDispatcher::getInstance().removeHandler(this);
+    isClosed_ = true;
+    cgiState_.remove(dispatcher_);
+    dispatcher_.removeHandler(this);
 }
 
 void ClientHandler::resetForNewRequest() {
     LOG_SDEBUG("Resetting all state.");
-    cgiState_.remove();
+    cgiState_.remove(dispatcher_);
     rspBuffer_.reset();
     reqParser_.reset();
     response_.clear();
     request_.clear();
+    delete bodyPipe_;
+    bodyPipe_ = NULL;
     headersSent_ = false;
     isDraining_ = false;
-    drainStartTime_ = 0;
+}
+
+void ClientHandler::armTimer(TimerPhase phase) {
+    uint64_t seconds = 0;
+    switch (phase) {
+    case HEADER_TIMER:
+        seconds = timeouts_.clientHeader;
+        break;
+    case BODY_TIMER:
+        seconds = timeouts_.clientBody;
+        break;
+    case KEEPALIVE_TIMER:
+        seconds = timeouts_.keepalive;
+        break;
+    case SEND_TIMER:
+        seconds = timeouts_.send;
+        break;
+    default:
+        break;
+    }
+    timerPhase_ = phase;
+    if (phase == DRAIN_TIMER)
+        dispatcher_.setTimeout(this, DRAIN_TIMEOUT_MS);
+    else if (seconds)
+        dispatcher_.setTimeout(this, seconds * 1000);
+    else
+        dispatcher_.cancelTimeout(this);
 }
 
 std::string ClientHandler::getLogSignature() const {
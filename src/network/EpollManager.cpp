@@ -23,23 +23,23 @@ EpollManager::~EpollManager() {
     }
 }
 
-void EpollManager::addHandler(IEventHandler *handler, uint32_t events) {
+void EpollManager::addHandler(IEventHandler *handler, uint32_t events, uint64_t token) {
     if (!handler)
         return;
     struct epoll_event eventStruct;
     eventStruct.events = events;
-    eventStruct.data.ptr = handler;
+    eventStruct.data.u64 = token;
     if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, handler->getFd(), &eventStruct) < 0) {
         throw std::runtime_error("Failed to add fd to epoll: " + std::string(strerror(errno)));
     }
 }
 
-void EpollManager::modifyHandler(IEventHandler *handler, uint32_t events) {
+void EpollManager::modifyHandler(IEventHandler *handler, uint32_t events, uint64_t token) {
     if (!handler)
         return;
     struct epoll_event eventStruct;
     eventStruct.events = events;
-    eventStruct.data.ptr = handler;
+    eventStruct.data.u64 = token;
     if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, handler->getFd(), &eventStruct) < 0) {
         throw std::runtime_error("Failed to add fd to epoll: " + std::string(strerror(errno)));
     }
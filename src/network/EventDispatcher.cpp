@@ -2,10 +2,10 @@
 
 #include "network/IEventHandler.hpp"
 #include "utils/Logger.hpp"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <exception>
-#include <sys/wait.h>
 
 #define MAX_EVENTS 1024
 
@@ -29,60 +29,115 @@ inline bool deleteHandlerSafely(IEventHandler *handler) {
 
 } // namespace
 
-EventDispatcher::EventDispatcher() {}
+EventDispatcher::Slot::Slot() : handler(NULL), generation(0) {}
+
+EventDispatcher::EventDispatcher(bool edgeTriggered)
+    : edgeTriggered_(edgeTriggered),
+      timers_(TimerWheel::now()),
+      pendingRemovals_(NULL),
+      isTearingDown_(false) {}
 
 EventDispatcher::~EventDispatcher() {
-    for (std::map<int, IEventHandler *>::iterator it = handlers_.begin(); it != handlers_.end();
-         ++it) {
-        deleteHandlerSafely(it->second);
+    // Handlers remove the ones they own from their destructors (a client its CGI), which
+    // may already be freed here: every handler is deleted exactly once by the walks below
+    isTearingDown_ = true;
+    for (size_t fd = 0; fd < slots_.size(); ++fd) {
+        IEventHandler *handler = slots_[fd].handler;
+        if (!handler)
+            continue;
+        slots_[fd].handler = NULL;
+        handler->isActive_ = false;
+        timers_.cancel(handler->timer_);
+        deleteHandlerSafely(handler);
     }
-    handlers_.clear();
     cleanUpGarbage();
 }
 
-EventDispatcher &EventDispatcher::getInstance() {
-    static EventDispatcher instance;
-    return instance;
-}
-
 void EventDispatcher::registerHandler(IEventHandler *handler) {
     if (!checkHandler(handler))
         return;
-    activeHandlers_.insert(handler);
-    handlers_[handler->getFd()] = handler;
+    size_t fd = static_cast<size_t>(handler->getFd());
+    if (fd >= slots_.size())
+        slots_.resize(std::max(fd + 1, slots_.size() * 2));
+    Slot &slot = slots_[fd];
+    uint64_t token = (static_cast<uint64_t>(slot.generation) << 32) | fd;
+    // Throws: the handler is then not registered, and stays the caller's to delete
+    epollManager_.addHandler(handler, epollMask(handler, EPOLLIN), token);
+    slot.handler = handler;
+    handler->token_ = token;
+    handler->isActive_ = true;
     handler->registeredEvents_ = EPOLLIN;
-    epollManager_.addHandler(handler, EPOLLIN);
 }
 
 void EventDispatcher::removeHandler(IEventHandler *handler) {
-    if (!handler)
+    if (!handler || isTearingDown_ || handler->isPendingRemoval_)
         return;
-    activeHandlers_.erase(handler);
-    if (handler->getFd() >= 0) {
-        epollManager_.modifyHandler(handler, 0);
-        handlers_.erase(handler->getFd());
+    if (handler->isActive_) {
+        handler->isActive_ = false;
+        Slot &slot = slots_[static_cast<uint32_t>(handler->token_)];
+        slot.handler = NULL;
+        slot.generation++; // Invalidates events already queued for this handler
+        // Deleted rather than silenced: the fd may outlive its handler (a pooled
+        // FastCGI connection) and be registered again by the next one
+        if (handler->getFd() >= 0)
+            epollManager_.removeHandler(handler);
     }
-    pendingRemovals_.insert(handler);
+    timers_.cancel(handler->timer_);
+    handler->isPendingRemoval_ = true;
+    handler->nextRemoval_ = pendingRemovals_;
+    pendingRemovals_ = handler;
 }
 
 void EventDispatcher::cleanUpGarbage() {
-    for (std::set<IEventHandler *>::iterator it = pendingRemovals_.begin();
-         it != pendingRemovals_.end(); ++it) {
-        deleteHandlerSafely(*it);
+    // Destructors may remove further handlers (e.g. a client its CGI): they are
+    // pushed to the head of the list and picked up by the same loop
+    while (pendingRemovals_) {
+        IEventHandler *handler = pendingRemovals_;
+        pendingRemovals_ = handler->nextRemoval_;
+        deleteHandlerSafely(handler);
     }
-    pendingRemovals_.clear();
+}
+
+IEventHandler *EventDispatcher::lookup(uint64_t token) const {
+    uint32_t fd = static_cast<uint32_t>(token);
+    if (fd >= slots_.size())
+        return NULL;
+    Slot const &slot = slots_[fd];
+    if (slot.generation != static_cast<uint32_t>(token >> 32))
+        return NULL;
+    return slot.handler;
 }
 
 void EventDispatcher::requestShutdown() { epollManager_.requestShutdown(); }
 
+bool EventDispatcher::isEdgeTriggered() const { return edgeTriggered_; }
+
+uint32_t EventDispatcher::epollMask(IEventHandler const *handler, uint32_t events) const {
+    if (edgeTriggered_ && handler->supportsEdgeTriggered())
+        return events | EPOLLET;
+    return events;
+}
+
 void EventDispatcher::updateEventMask(IEventHandler *handler, uint32_t newMask) {
     if (handler->registeredEvents_ == newMask) {
         return;
     }
-    epollManager_.modifyHandler(handler, newMask);
+    if (!handler->isActive_)
+        return;
+    epollManager_.modifyHandler(handler, epollMask(handler, newMask), handler->token_);
     handler->registeredEvents_ = newMask;
 }
 
+void EventDispatcher::rearm(IEventHandler *handler) {
+    if (!handler || !edgeTriggered_ || !handler->supportsEdgeTriggered())
+        return;
+    if (!handler->isActive_)
+        return;
+    // EPOLL_CTL_MOD re-evaluates readiness and queues a new event if the fd is still ready
+    epollManager_.modifyHandler(handler, epollMask(handler, handler->registeredEvents_),
+                                handler->token_);
+}
+
 void EventDispatcher::enableRead(IEventHandler *handler) {
     if (!handler)
         return;
@@ -104,25 +159,62 @@ void EventDispatcher::disableWrite(IEventHandler *handler) {
     updateEventMask(handler, handler->registeredEvents_ & ~EPOLLOUT);
 }
 
+void EventDispatcher::setTimeout(IEventHandler *handler, uint64_t delayMs) {
+    if (!handler)
+        return;
+    timers_.schedule(handler->timer_, TimerWheel::now(), delayMs);
+}
+
+void EventDispatcher::cancelTimeout(IEventHandler *handler) {
+    if (!handler)
+        return;
+    timers_.cancel(handler->timer_);
+}
+
+int EventDispatcher::nextTimeout() {
+    // Wake up at least once a second: a shutdown requested just before epoll_wait() would
+    // otherwise wait for the next event
+    int timeout = timers_.nextTimeout(TimerWheel::now());
+    return (timeout < 0 || timeout > 1000) ? 1000 : timeout;
+}
+
+void EventDispatcher::expireTimers() {
+    timers_.advance(TimerWheel::now());
+    while (TimerWheel::Timer *timer = timers_.popExpired()) {
+        IEventHandler *handler = timer->handler;
+        if (!handler->isActive_)
+            continue;
+        try {
+            handler->handleTimeout();
+        } catch (std::exception const &e) {
+            LOG_ERROR("EventDispatcher::expireTimers::handler("
+                      << handler->getFd() << ")->handleTimeout: " << e.what());
+            removeHandler(handler);
+        } catch (...) {
+            LOG_ERROR("EventDispatcher::expireTimers::handler("
+                      << handler->getFd() << ")->handleTimeout: unknown error");
+            removeHandler(handler);
+        }
+    }
+}
+
 // TODO will need to implement shutdown inside else if nready == 0
 void EventDispatcher::handleEvents() {
     static bool was_printed = false;
     while (!epollManager_.getisShuttingDown()) {
         struct epoll_event events[MAX_EVENTS];
-        int nready = epollManager_.waitForEvents(events, MAX_EVENTS, 1000);
+        int nready = epollManager_.waitForEvents(events, MAX_EVENTS, nextTimeout());
         if (nready < 0) {
-            while (waitpid(-1, NULL, WNOHANG) > 0)
-                ;
+            int error = errno;
             cleanUpGarbage();
-            if (errno == EINTR) {
+            if (error == EINTR) {
                 LOG_DEBUG("epoll_wait interrupted by a signal, continuing...");
                 continue;
             }
-            LOG_ERROR("epoll_wait failed: " << strerror(errno));
+            LOG_ERROR("epoll_wait failed: " << strerror(error));
             break;
         } else if (nready == 0) {
-            while (waitpid(-1, NULL, WNOHANG) > 0)
-                ;
+            expireTimers();
             cleanUpGarbage();
             if (was_printed)
                 continue;
@@ -132,9 +224,9 @@ void EventDispatcher::handleEvents() {
         }
         was_printed = false;
         for (int i = 0; i < nready; ++i) {
-            IEventHandler *handler = static_cast<IEventHandler *>(events[i].data.ptr);
-            // SAFETY CHECK: remove handler was called from previos handler for this handler
-            if (activeHandlers_.find(handler) == activeHandlers_.end())
+            // NULL if a previous handler of this batch removed it
+            IEventHandler *handler = lookup(events[i].data.u64);
+            if (!handler)
                 continue;
             try {
                 handler->handleEvent(events[i].events);
@@ -148,8 +240,7 @@ void EventDispatcher::handleEvents() {
                 removeHandler(handler);
             }
         }
-        while (waitpid(-1, NULL, WNOHANG) > 0)
-            ;
+        expireTimers();
         cleanUpGarbage();
     }
 }
@@ -0,0 +1,12 @@
+#include "network/FileCacheWatcher.hpp"
+
+namespace network {
+
+FileCacheWatcher::FileCacheWatcher(http::OpenFileCache &cache)
+    : cache_(cache), fd_(cache.watchFd()) {}
+
+void FileCacheWatcher::handleEvent(uint32_t) { cache_.processEvents(); }
+
+int FileCacheWatcher::getFd() const { return fd_; }
+
+} // namespace network
@@ -2,8 +2,16 @@
 
 namespace network {
 
-IEventHandler::IEventHandler() : registeredEvents_(0) {}
+IEventHandler::IEventHandler()
+    : registeredEvents_(0), token_(0), isActive_(false), isPendingRemoval_(false),
+      nextRemoval_(NULL) {
+    timer_.handler = this;
+}
 
 IEventHandler::~IEventHandler() {}
 
+bool IEventHandler::supportsEdgeTriggered() const { return false; }
+
+void IEventHandler::handleTimeout() {}
+
 } // namespace network
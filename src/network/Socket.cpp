@@ -1,8 +1,11 @@
 #include "network/Socket.hpp"
 
+#include "utils/Logger.hpp"
 #include <arpa/inet.h>
 #include <cerrno>
 #include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdexcept>
 #include <unistd.h>
 
@@ -10,15 +13,21 @@ namespace network {
 
 Socket::Socket(void) : fd_(-1) { std::memset(&addr_, 0, sizeof(addr_)); }
 
-Socket::Socket(int port) : fd_(-1) { createAndBind("0.0.0.0", port); }
+Socket::Socket(int port, bool reusePort, config::ListenOptions const &options) : fd_(-1) {
+    createAndBind("0.0.0.0", port, reusePort, options);
+}
 
-Socket::Socket(std::string const &address, int port) : fd_(-1) { createAndBind(address, port); }
+Socket::Socket(std::string const &address, int port, bool reusePort,
+               config::ListenOptions const &options)
+    : fd_(-1) {
+    createAndBind(address, port, reusePort, options);
+}
 
-Socket::Socket(config::ServerBlock const &s) : fd_(-1) {
+Socket::Socket(config::ServerBlock const &s, bool reusePort) : fd_(-1) {
     if (s.address().empty()) {
-        createAndBind("0.0.0.0", s.port());
+        createAndBind("0.0.0.0", s.port(), reusePort, s.listenOptions());
     } else
-        createAndBind(s.address(), s.port());
+        createAndBind(s.address(), s.port(), reusePort, s.listenOptions());
 }
 
 Socket::~Socket(void) {
@@ -36,14 +45,16 @@ void Socket::bindTo(std::string const &address, int port) {
     if (fd_ >= 0) {
         throw std::runtime_error("Socket is already bound");
     }
-    createAndBind(address, port);
+    createAndBind(address, port, false, config::ListenOptions());
 }
 
-void Socket::createAndBind(std::string const &ipAddress, int port) {
+void Socket::createAndBind(std::string const &ipAddress, int port, bool reusePort,
+                           config::ListenOptions const &options) {
     if (port < 0 || port > 65535) {
         throw std::runtime_error("Invalid port number. Port must be between 1024 and 65535");
     }
-    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    // Non-blocking so the accept loop can drain the queue until EAGAIN
+    fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (fd_ < 0)
         throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
     int opt = 1;
@@ -52,6 +63,22 @@ void Socket::createAndBind(std::string const &ipAddress, int port) {
         fd_ = -1;
         throw std::runtime_error("Failed to set socket options: " + std::string(strerror(errno)));
     }
+    if (reusePort && setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("Failed to set SO_REUSEPORT: " + std::string(strerror(errno)));
+    }
+    if (options.deferred) {
+        // Seconds to wait for the first data segment before accepting anyway
+        int timeout = 1;
+        if (setsockopt(fd_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &timeout, sizeof(timeout)) < 0)
+            LOG_WARN("Failed to set TCP_DEFER_ACCEPT: " << strerror(errno));
+    }
+    if (options.fastOpen > 0) {
+        int qlen = options.fastOpen;
+        if (setsockopt(fd_, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) < 0)
+            LOG_WARN("Failed to set TCP_FASTOPEN: " << strerror(errno));
+    }
     std::memset(&addr_, 0, sizeof(addr_));
     addr_.sin_port = htons(port);
     addr_.sin_family = AF_INET;
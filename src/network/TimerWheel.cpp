@@ -0,0 +1,124 @@
+#include "network/TimerWheel.hpp"
+#include <ctime>
+
+namespace network {
+
+TimerWheel::Timer::Timer() : prev(NULL), next(NULL), expires(0), handler(NULL) {}
+
+bool TimerWheel::Timer::isPending() const { return next != NULL; }
+
+TimerWheel::TimerWheel(uint64_t nowMs) : current_(nowMs / TICK_MS), count_(0) {
+    for (int level = 0; level < LEVELS; ++level) {
+        for (uint64_t slot = 0; slot < SLOTS; ++slot)
+            slots_[level][slot].prev = slots_[level][slot].next = &slots_[level][slot];
+    }
+    expired_.prev = expired_.next = &expired_;
+}
+
+void TimerWheel::schedule(Timer &timer, uint64_t nowMs, uint64_t delayMs) {
+    cancel(timer);
+    timer.expires = (nowMs + delayMs + TICK_MS - 1) / TICK_MS;
+    link(timer);
+    count_++;
+}
+
+void TimerWheel::cancel(Timer &timer) {
+    if (!timer.isPending())
+        return;
+    unlink(timer);
+    count_--;
+}
+
+void TimerWheel::advance(uint64_t nowMs) {
+    uint64_t target = nowMs / TICK_MS;
+    while (current_ < target) {
+        current_++;
+        // Cascade top-down: coarser slots refill finer ones before those are processed
+        int top = 0;
+        while (top + 1 < LEVELS && (current_ & (levelSpan(top + 1) - 1)) == 0)
+            top++;
+        for (int level = top; level > 0; --level) {
+            Timer &head = slots_[level][(current_ >> (SLOT_BITS * level)) & SLOT_MASK];
+            while (!isEmpty(head)) {
+                Timer &timer = *head.next;
+                unlink(timer);
+                if (timer.expires <= current_)
+                    pushBack(expired_, timer);
+                else
+                    link(timer);
+            }
+        }
+        Timer &head = slots_[0][current_ & SLOT_MASK];
+        while (!isEmpty(head)) {
+            Timer &timer = *head.next;
+            unlink(timer);
+            pushBack(expired_, timer);
+        }
+    }
+}
+
+TimerWheel::Timer *TimerWheel::popExpired() {
+    if (isEmpty(expired_))
+        return NULL;
+    Timer *timer = expired_.next;
+    unlink(*timer);
+    count_--;
+    return timer;
+}
+
+int TimerWheel::nextTimeout(uint64_t nowMs) const {
+    if (count_ == 0)
+        return -1;
+    if (!isEmpty(expired_))
+        return 0;
+    // First non-empty level-0 slot, or the next wrap (cascade) if that comes sooner
+    uint64_t tick = current_ + 1;
+    while ((tick & SLOT_MASK) != 0 && isEmpty(slots_[0][tick & SLOT_MASK]))
+        tick++;
+    uint64_t due = tick * TICK_MS;
+    return due > nowMs ? static_cast<int>(due - nowMs) : 0;
+}
+
+size_t TimerWheel::size() const { return count_; }
+
+uint64_t TimerWheel::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void TimerWheel::link(Timer &timer) {
+    if (timer.expires <= current_)
+        timer.expires = current_ + 1;
+    uint64_t delta = timer.expires - current_;
+    uint64_t maxDelta = levelSpan(LEVELS) - 1;
+    if (delta > maxDelta) {
+        timer.expires = current_ + maxDelta;
+        delta = maxDelta;
+    }
+    int level = 0;
+    while (level + 1 < LEVELS && delta >= levelSpan(level + 1))
+        level++;
+    pushBack(slots_[level][(timer.expires >> (SLOT_BITS * level)) & SLOT_MASK], timer);
+}
+
+void TimerWheel::unlink(Timer &timer) {
+    timer.prev->next = timer.next;
+    timer.next->prev = timer.prev;
+    timer.prev = timer.next = NULL;
+}
+
+void TimerWheel::pushBack(Timer &head, Timer &timer) {
+    timer.prev = head.prev;
+    timer.next = &head;
+    head.prev->next = &timer;
+    head.prev = &timer;
+}
+
+bool TimerWheel::isEmpty(Timer const &head) { return head.next == &head; }
+
+uint64_t TimerWheel::levelSpan(int level) {
+    return static_cast<uint64_t>(1) << (SLOT_BITS * level);
+}
+
+} // namespace network
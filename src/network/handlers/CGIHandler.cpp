@@ -1,8 +1,11 @@
 #include "network/CGIHandler.hpp"
 #include "http/HttpStatus.hpp"
 #include "http/ResponseBody.hpp"
+#include "network/ChildReaper.hpp"
 #include "network/EventDispatcher.hpp"
 #include "utils/Logger.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <sys/epoll.h>
 
@@ -10,71 +13,179 @@ namespace network {
 
 static const size_t MAX_CGI_HEADER_SIZE = 8192;
 
-CGIHandler::CGIHandler(http::IResponseBody &body, ClientHandler &client, bool hasHeaderParsing)
-    : body_(body), client_(client), fd_(body_.getEventSourceFd()) {
+CGIHandler::CGIHandler(http::IResponseBody &body, ClientHandler &client, bool hasHeaderParsing,
+                       config::Timeouts const &timeouts)
+    : body_(body),
+      client_(client),
+      fd_(body_.getEventSourceFd()),
+      pid_(body_.processId()),
+      timeouts_(timeouts),
+      deadline_(0),
+      isSendingRequest_(false),
+      isPaused_(false) {
     state_ = hasHeaderParsing ? READING_HEADERS : STREAMING_BODY;
+    ChildReaper::watch(pid_);
+}
+
+CGIHandler::~CGIHandler() {
+    // The client went away (or got an error) before the script was done
+    if (state_ != COMPLETE)
+        ChildReaper::terminate(pid_);
+}
+
+void CGIHandler::start() {
+    if (timeouts_.cgi > 0)
+        deadline_ = TimerWheel::now() + timeouts_.cgi * 1000;
+    armTimer();
+    isSendingRequest_ = true;
+    handleWrite();
+}
+
+void CGIHandler::pause() {
+    isPaused_ = true;
+    client_.dispatcher().disableRead(this);
+    armTimer();
+}
+
+void CGIHandler::resume() {
+    isPaused_ = false;
+    client_.dispatcher().enableRead(this);
+    armTimer();
+}
+
+void CGIHandler::restartTimer() { armTimer(); }
+
+void CGIHandler::armTimer() {
+    EventDispatcher &dispatcher = client_.dispatcher();
+    uint64_t delay = isPaused_ ? 0 : timeouts_.cgiRead * 1000;
+    if (deadline_ > 0) {
+        uint64_t now = TimerWheel::now();
+        uint64_t left = deadline_ > now ? deadline_ - now : 1;
+        if (delay == 0 || left < delay)
+            delay = left;
+    }
+    if (delay > 0)
+        dispatcher.setTimeout(this, delay);
+    else
+        dispatcher.cancelTimeout(this);
+}
+
+void CGIHandler::handleTimeout() {
+    bool isOverall = deadline_ > 0 && TimerWheel::now() >= deadline_;
+    LOG_WARN("CGIHandler(" << client_.getFd() << "): "
+                           << (isOverall ? "cgi_timeout" : "cgi_read_timeout")
+                           << " expired. Sending 504 Gateway Timeout.");
+    ChildReaper::terminate(pid_);
+    state_ = COMPLETE;
+    client_.onCgiTimeout();
+}
+
+void CGIHandler::abort(http::HttpStatus status) {
+    ChildReaper::terminate(pid_);
+    state_ = COMPLETE;
+    client_.handleError(status);
 }
 
 int CGIHandler::getFd() const { return fd_; }
 
+bool CGIHandler::supportsEdgeTriggered() const { return true; }
+
 void CGIHandler::handleEvent(uint32_t events) {
-    if (events & EPOLLIN)
+    if (isSendingRequest_ && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && !handleWrite())
+        return;
+    // A hang-up is read as the end of the output: before the headers, it is an error
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
         handleRead();
-    else {
-        LOG_TRACE("CGIHandler::handleEvent(" << client_.getFd() << "): " << events);
-        client_.onCgiComplete();
-    }
 }
 
 void CGIHandler::handleRead() {
     LOG_TRACE("CGIHandler::handleRead(" << client_.getFd() << ")");
+    EventDispatcher &dispatcher = client_.dispatcher();
+    size_t budget = READ_BUDGET;
+    size_t bytesRead = 0;
+    bool more;
+    do {
+        more = readChunk(bytesRead);
+        budget -= std::min(budget, bytesRead);
+        // A body that has seen its end (a FastCGI END_REQUEST) gets no further event
+    } while (more && (body_.isDone() || (dispatcher.isEdgeTriggered() && budget > 0)));
+
+    if (budget < READ_BUDGET && state_ != COMPLETE)
+        armTimer();
+
+    if (more)
+        dispatcher.rearm(this); // Budget exhausted, let the other connections run
+}
+
+bool CGIHandler::handleWrite() {
+    EventDispatcher &dispatcher = client_.dispatcher();
+    http::IResponseBody::RequestStatus status = body_.sendRequest();
+    if (status == http::IResponseBody::REQUEST_PENDING) {
+        dispatcher.enableWrite(this);
+        return true;
+    }
+    isSendingRequest_ = false;
+    dispatcher.disableWrite(this);
+    if (status == http::IResponseBody::REQUEST_SENT)
+        return true;
+    LOG_WARN("CGIHandler::handleWrite: cannot send the request. Sending 502 Bad Gateway.");
+    client_.handleError(http::BAD_GATEWAY);
+    return false;
+}
+
+bool CGIHandler::readChunk(size_t &bytesRead) {
+    bytesRead = 0;
     if (state_ == STREAMING_BODY && client_.isSendBufferFull()) {
         LOG_DEBUG("Client send buffer is full. Disabling CGI read handler temporarily.");
-        EventDispatcher::getInstance().disableRead(this);
-        return;
+        pause();
+        return false;
     }
 
     char buffer[8192];
     ssize_t bytes_read = body_.read(buffer, sizeof(buffer));
     LOG_TRACE("CGIHandler::handleRead: Read " << bytes_read << " bytes from CGI body pipe.");
+    if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return false;
     if (bytes_read <= 0) {
         if (state_ == READING_HEADERS) {
             LOG_WARN("CGIHandler::handleRead: CGI process ended or failed before sending valid "
                      "headers. Sending 502 Bad "
                      "Gateway.");
-            // TODO: Kill CGI process
-            client_.handleError(http::BAD_GATEWAY);
+            abort(http::BAD_GATEWAY);
         } else {
             LOG_DEBUG("CGIHandler::handleRead: CGI body stream finished. Completing request.");
+            state_ = COMPLETE;
             client_.onCgiComplete();
-            return;
         }
+        return false;
     }
+    bytesRead = static_cast<size_t>(bytes_read);
     if (state_ == STREAMING_BODY) {
         LOG_TRACE("CGIHandler::handleRead: State is STREAMING_BODY. Pushing "
                   << bytes_read << " bytes to client buffer.");
-        return client_.pushToSendBuffer(buffer, bytes_read);
+        client_.pushToSendBuffer(buffer, bytes_read);
+        return true;
     }
     if (headerBuffer_.length() + bytes_read > MAX_CGI_HEADER_SIZE) {
         LOG_ERROR("CGIHandler::handleRead: CGI headers exceeded maximum allowed size ("
                   << MAX_CGI_HEADER_SIZE << "). Sending 502.");
-        // TODO: Kill CGI process
-        return client_.handleError(http::BAD_GATEWAY);
+        abort(http::BAD_GATEWAY);
+        return false;
     }
     headerBuffer_.append(buffer, bytes_read);
 
     size_t offset = 0;
     size_t headerEnd = http::Headers::findHeaderEnd(headerBuffer_, offset);
     if (headerEnd == std::string::npos) {
-        return;
+        return true;
     }
     LOG_DEBUG("CGIHandler::handleRead: Found end of CGI headers. Parsing headers...");
     http::Headers headers;
     if (!http::Headers::parse(headerBuffer_, headers, false)) {
         LOG_ERROR("CGIHandler::handleRead: Failed to parse CGI headers. Malformed response. "
                   "Sending 502.");
-        // TODO: Kill CGI process
-        return client_.handleError(http::BAD_GATEWAY);
+        abort(http::BAD_GATEWAY);
+        return false;
     }
     LOG_DEBUG("CGIHandler::handleRead: CGI headers parsed successfully. Forwarding to client.");
     client_.onCgiHeadersParsed(headers);
@@ -87,6 +198,7 @@ void CGIHandler::handleRead() {
         client_.pushToSendBuffer(headerBuffer_.data() + bodyStart,
                                  headerBuffer_.length() - bodyStart);
     }
+    return true;
 }
 
 } // namespace network
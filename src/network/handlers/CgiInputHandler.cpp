@@ -0,0 +1,20 @@
+#include "network/CgiInputHandler.hpp"
+#include "network/ClientHandler.hpp"
+#include "utils/Logger.hpp"
+
+namespace network {
+
+CgiInputHandler::CgiInputHandler(int fd, ClientHandler &client) : fd_(fd), client_(client) {}
+
+void CgiInputHandler::handleEvent(uint32_t events) {
+    LOG_TRACE("CgiInputHandler::handleEvent(" << client_.getFd() << "): " << events);
+    // EPOLLERR too: the script closed its stdin, which the next write reports
+    client_.onCgiInputWritable();
+}
+
+int CgiInputHandler::getFd() const { return fd_; }
+
+// Each event writes until the pipe is full or the buffer empty, when EPOLLOUT goes away
+bool CgiInputHandler::supportsEdgeTriggered() const { return true; }
+
+} // namespace network
@@ -0,0 +1,54 @@
+#include "utils/InputBuffer.hpp"
+#include "utils/BufferPool.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace utils {
+
+InputBuffer::InputBuffer(size_t initialCapacity) : size_(0) {
+    BufferPool<std::vector<char> >::getInstance().acquire(storage_, initialCapacity);
+    storage_.resize(std::max(storage_.capacity(), initialCapacity));
+}
+
+InputBuffer::~InputBuffer() { BufferPool<std::vector<char> >::getInstance().release(storage_); }
+
+char const *InputBuffer::data() const { return storage_.empty() ? NULL : &storage_[0]; }
+
+size_t InputBuffer::size() const { return size_; }
+
+bool InputBuffer::empty() const { return size_ == 0; }
+
+size_t InputBuffer::capacity() const { return storage_.size(); }
+
+char *InputBuffer::prepare(size_t minSize, size_t &space) {
+    if (storage_.size() - size_ < minSize) {
+        // resize() keeps the contents, and the new bytes are zero-filled once per growth
+        storage_.resize(std::max(storage_.size() * 2, size_ + minSize));
+    }
+    space = storage_.size() - size_;
+    return &storage_[0] + size_;
+}
+
+void InputBuffer::commit(size_t size) { size_ += std::min(size, storage_.size() - size_); }
+
+void InputBuffer::append(char const *bytes, size_t size) {
+    if (!size)
+        return;
+    size_t space;
+    std::memcpy(prepare(size, space), bytes, size);
+    size_ += size;
+}
+
+void InputBuffer::truncate(size_t offset) { size_ = std::min(size_, offset); }
+
+void InputBuffer::erase(size_t offset, size_t length) {
+    if (offset >= size_)
+        return;
+    length = std::min(length, size_ - offset);
+    std::memmove(&storage_[0] + offset, &storage_[0] + offset + length, size_ - offset - length);
+    size_ -= length;
+}
+
+void InputBuffer::clear() { size_ = 0; }
+
+} // namespace utils
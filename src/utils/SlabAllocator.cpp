@@ -0,0 +1,58 @@
+#include "utils/SlabAllocator.hpp"
+#include <new>
+
+namespace utils {
+
+namespace {
+// Strictest fundamental alignment, so any object can live in a block
+const size_t BLOCK_ALIGNMENT = 16;
+} // namespace
+
+SlabAllocator::SlabAllocator(size_t blockSize, size_t blocksPerSlab)
+    : blockSize_((blockSize + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT),
+      blocksPerSlab_(blocksPerSlab ? blocksPerSlab : 1),
+      free_(NULL),
+      inUse_(0) {
+    if (blockSize_ < sizeof(FreeBlock))
+        blockSize_ = BLOCK_ALIGNMENT;
+}
+
+SlabAllocator::~SlabAllocator() {
+    for (size_t i = 0; i < slabs_.size(); ++i)
+        ::operator delete(slabs_[i]);
+}
+
+void *SlabAllocator::allocate() {
+    if (!free_)
+        grow();
+    FreeBlock *block = free_;
+    free_ = block->next;
+    inUse_++;
+    return block;
+}
+
+void SlabAllocator::deallocate(void *block) {
+    if (!block)
+        return;
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    freed->next = free_;
+    free_ = freed;
+    inUse_--;
+}
+
+size_t SlabAllocator::blockSize() const { return blockSize_; }
+size_t SlabAllocator::inUse() const { return inUse_; }
+size_t SlabAllocator::capacity() const { return slabs_.size() * blocksPerSlab_; }
+
+void SlabAllocator::grow() {
+    char *slab = static_cast<char *>(::operator new(blockSize_ * blocksPerSlab_));
+    slabs_.push_back(slab);
+    // Thread the new blocks so the lowest address is handed out first
+    for (size_t i = blocksPerSlab_; i-- > 0;) {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(slab + i * blockSize_);
+        block->next = free_;
+        free_ = block;
+    }
+}
+
+} // namespace utils
@@ -0,0 +1,55 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include "http/Request.hpp"
+#include <string>
+
+static void limitsOf(std::string const &location, size_t &cpu, size_t &as, size_t &nofile) {
+    config::ServerConfig sc("server { listen 8080; location / { " + location + " } }", false);
+    http::Request req;
+    req.uri("/");
+    config::ServerBlock const *server = sc.getServer(8080, req);
+    REQUIRE(server != NULL);
+    config::LocationBlock const *loc = server->matchLocation(req);
+    REQUIRE(loc != NULL);
+    loc->cgiLimits(cpu, as, nofile);
+}
+
+TEST_CASE("CgiLimitsDirective") {
+    size_t cpu = 1, as = 1, nofile = 1;
+
+    SUBCASE("Should set no limit by default") {
+        limitsOf("cgi_pass;", cpu, as, nofile);
+        CHECK(cpu == 0);
+        CHECK(as == 0);
+        CHECK(nofile == 0);
+    }
+
+    SUBCASE("Should read durations, sizes and counts in any order") {
+        limitsOf("cgi_pass; cgi_limits nofile=64 cpu=2m as=256m;", cpu, as, nofile);
+        CHECK(cpu == 120);
+        CHECK(as == 256 * 1024 * 1024);
+        CHECK(nofile == 64);
+    }
+
+    SUBCASE("Should leave out the limits that are not given") {
+        limitsOf("cgi_pass; cgi_limits cpu=10;", cpu, as, nofile);
+        CHECK(cpu == 10);
+        CHECK(as == 0);
+        CHECK(nofile == 0);
+    }
+
+    SUBCASE("Should reject invalid limits, duplicates and contexts") {
+        char const *invalid[] = {"cgi_limits;",         "cgi_limits cpu=0;",
+                                 "cgi_limits as=lots;", "cgi_limits nofile=-1;",
+                                 "cgi_limits cpu;",     "cgi_limits nproc=5;",
+                                 "cgi_limits cpu=1 cpu=2;"};
+        for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+            std::string conf = "server { listen 8080; location / { " + std::string(invalid[i]) +
+                               " } }";
+            CHECK_THROWS_AS((config::ServerConfig(conf, false)), const config::ConfigError &);
+        }
+        std::string const inServer = "server { listen 8080; cgi_limits cpu=1; }";
+        CHECK_THROWS_AS((config::ServerConfig(inServer, false)), const config::ConfigError &);
+    }
+}
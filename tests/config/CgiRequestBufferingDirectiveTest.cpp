@@ -0,0 +1,36 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include "http/Request.hpp"
+#include <string>
+
+static bool bufferingOf(std::string const &location) {
+    config::ServerConfig sc("server { listen 8080; location / { " + location + " } }", false);
+    http::Request req;
+    req.uri("/");
+    config::ServerBlock const *server = sc.getServer(8080, req);
+    REQUIRE(server != NULL);
+    config::LocationBlock const *loc = server->matchLocation(req);
+    REQUIRE(loc != NULL);
+    return loc->cgiRequestBuffering();
+}
+
+TEST_CASE("CgiRequestBufferingDirective") {
+    SUBCASE("Should be on by default") { CHECK(bufferingOf("cgi_pass;")); }
+
+    SUBCASE("Should read on and off") {
+        CHECK(bufferingOf("cgi_pass; cgi_request_buffering on;"));
+        CHECK_FALSE(bufferingOf("cgi_pass; cgi_request_buffering off;"));
+    }
+
+    SUBCASE("Should reject invalid values, duplicates and contexts") {
+        std::string const word =
+            "server { listen 8080; location / { cgi_request_buffering no-way; } }";
+        std::string const twice = "server { listen 8080; location / { "
+                                  "cgi_request_buffering on; cgi_request_buffering off; } }";
+        std::string const inServer = "server { listen 8080; cgi_request_buffering off; }";
+        CHECK_THROWS_AS((config::ServerConfig(word, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(twice, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(inServer, false)), const config::ConfigError &);
+    }
+}
@@ -0,0 +1,50 @@
+#include "../TestableRequest.hpp"
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("ClientBody directives") {
+    SUBCASE("Locations override the server, which overrides the defaults") {
+        const std::string configStr = R"(
+server {
+    listen 8080;
+    client_body_buffer_size 8k;
+    client_body_temp_path /var/tmp;
+    location /api/ {
+        client_body_buffer_size 1M;
+    }
+    location / {
+    }
+}
+server {
+    listen 8081;
+}
+        )";
+        config::ServerConfig sc(configStr, false);
+        TestableRequest req;
+        req.uri("/api/x");
+        req.server(sc.getServer(8080, req));
+        req.location(req.server()->matchLocation(req));
+        CHECK(req.getBodyBufferSize() == 1024 * 1024);
+        CHECK(req.getBodyTempPath() == "/var/tmp");
+
+        req.uri("/other");
+        req.location(req.server()->matchLocation(req));
+        CHECK(req.getBodyBufferSize() == 8 * 1024);
+
+        req.server(sc.getServer(8081, req));
+        req.location(req.server()->matchLocation(req));
+        CHECK(req.getBodyBufferSize() == 16 * 1024);
+        CHECK(req.getBodyTempPath() == "/tmp");
+    }
+
+    SUBCASE("Should reject invalid values and contexts") {
+        const std::string word = "server { listen 8080; client_body_buffer_size big; }";
+        const std::string noArg = "server { listen 8080; client_body_temp_path; }";
+        const std::string inMain = "client_body_buffer_size 1k; server { listen 8080; }";
+        CHECK_THROWS_AS((config::ServerConfig(word, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(noArg, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(inMain, false)), const config::ConfigError &);
+    }
+}
@@ -0,0 +1,25 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("EdgeTriggeredDirective") {
+    SUBCASE("Should be off by default") {
+        config::ServerConfig sc(std::string("server { listen 8080; }"), false);
+        CHECK_FALSE(sc.edgeTriggered());
+    }
+
+    SUBCASE("Should read on and off") {
+        const std::string on = "edge_triggered on; server { listen 8080; }";
+        const std::string off = "edge_triggered off; server { listen 8080; }";
+        CHECK(config::ServerConfig(on, false).edgeTriggered());
+        CHECK_FALSE(config::ServerConfig(off, false).edgeTriggered());
+    }
+
+    SUBCASE("Should reject invalid values and contexts") {
+        const std::string word = "edge_triggered sometimes; server { listen 8080; }";
+        const std::string inServer = "server { listen 8080; edge_triggered on; }";
+        CHECK_THROWS_AS((config::ServerConfig(word, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(inServer, false)), const config::ConfigError &);
+    }
+}
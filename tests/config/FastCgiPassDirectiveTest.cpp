@@ -0,0 +1,59 @@
+#include "../TestableRequest.hpp"
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+namespace {
+
+config::LocationBlock const *appLocation(config::ServerConfig const &sc) {
+    TestableRequest req;
+    req.uri("/app/index.php");
+    req.server(sc.getServer(8080, req));
+    return req.server()->matchLocation(req);
+}
+
+std::string inLocation(std::string const &directives) {
+    return "server { listen 8080; location /app/ { " + directives + " } }";
+}
+
+} // namespace
+
+TEST_CASE("FastCgiPassDirective") {
+    SUBCASE("Should store a unix socket path as written") {
+        config::ServerConfig sc(inLocation("fastcgi_pass unix:/run/app.sock;"), false);
+        config::LocationBlock const *loc = appLocation(sc);
+        REQUIRE(loc);
+        CHECK(loc->hasFastCgiPass());
+        CHECK_FALSE(loc->hasCgiPass());
+        CHECK(loc->getRawValues("fastcgi_pass")[0] == "unix:/run/app.sock");
+    }
+
+    SUBCASE("Should store a TCP address as ip:port") {
+        config::ServerConfig sc(inLocation("fastcgi_pass localhost:9000;"), false);
+        CHECK(appLocation(sc)->getRawValues("fastcgi_pass")[0] == "127.0.0.1:9000");
+    }
+
+    SUBCASE("Should reject invalid addresses") {
+        const std::string noPort = inLocation("fastcgi_pass 127.0.0.1;");
+        const std::string badPort = inLocation("fastcgi_pass 127.0.0.1:70000;");
+        const std::string emptyPath = inLocation("fastcgi_pass unix:;");
+        const std::string longPath =
+            inLocation("fastcgi_pass unix:/" + std::string(200, 'a') + ";");
+        const std::string twoArgs = inLocation("fastcgi_pass unix:/a unix:/b;");
+        CHECK_THROWS_AS((config::ServerConfig(noPort, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(badPort, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(emptyPath, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(longPath, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(twoArgs, false)), const config::ConfigError &);
+    }
+
+    SUBCASE("Should reject other contexts and a mix with cgi_pass") {
+        const std::string inServer = "server { listen 8080; fastcgi_pass unix:/a; }";
+        const std::string after = inLocation("cgi_pass; fastcgi_pass unix:/a;");
+        const std::string before = inLocation("fastcgi_pass unix:/a; cgi_pass;");
+        CHECK_THROWS_AS((config::ServerConfig(inServer, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(after, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(before, false)), const config::ConfigError &);
+    }
+}
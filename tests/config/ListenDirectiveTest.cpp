@@ -0,0 +1,53 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+static config::ListenOptions const &optionsFor(config::ServerConfig const &sc, int port) {
+    return sc.getServersMap().at(port)[0].listenOptions();
+}
+
+TEST_CASE("ListenDirective - socket parameters") {
+    SUBCASE("Should use the defaults without parameters") {
+        config::ServerConfig sc(std::string("server { listen 8080; }"), false);
+        config::ListenOptions const &options = optionsFor(sc, 8080);
+        CHECK(options.backlog == 511);
+        CHECK_FALSE(options.deferred);
+        CHECK(options.fastOpen == 0);
+    }
+
+    SUBCASE("Should read backlog, deferred and fastopen") {
+        const std::string conf =
+            "server { listen 127.0.0.1:8080 backlog=4096 deferred fastopen=256; }";
+        config::ServerConfig sc(conf, false);
+        config::ListenOptions const &options = optionsFor(sc, 8080);
+        CHECK(sc.getServersMap().at(8080)[0].address() == "127.0.0.1");
+        CHECK(options.backlog == 4096);
+        CHECK(options.deferred);
+        CHECK(options.fastOpen == 256);
+    }
+
+    SUBCASE("Should reject invalid parameters") {
+        const char *bad[] = {"server { listen 8080 backlog=; }",
+                             "server { listen 8080 backlog=0; }",
+                             "server { listen 8080 backlog=99999999; }",
+                             "server { listen 8080 fastopen=abc; }",
+                             "server { listen 8080 ssl; }"};
+        for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+            CHECK_THROWS_AS((config::ServerConfig(std::string(bad[i]), false)),
+                            const config::ConfigError &);
+        }
+    }
+
+    SUBCASE("Should merge the options of servers sharing a port") {
+        config::ListenOptions a;
+        config::ListenOptions b;
+        b.backlog = 1024;
+        b.deferred = true;
+        a.fastOpen = 16;
+        a.merge(b);
+        CHECK(a.backlog == 1024);
+        CHECK(a.deferred);
+        CHECK(a.fastOpen == 16);
+    }
+}
@@ -0,0 +1,54 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("OpenFileCacheDirective") {
+    size_t maxEntries = 1;
+    size_t validity = 1;
+
+    SUBCASE("Should be off by default") {
+        config::ServerConfig sc(std::string("server { listen 8080; }"), false);
+        sc.openFileCache(maxEntries, validity);
+        CHECK(maxEntries == 0);
+    }
+
+    SUBCASE("Should read max and valid") {
+        const std::string str = "open_file_cache max=500 valid=2m; server { listen 8080; }";
+        config::ServerConfig sc(str, false);
+        sc.openFileCache(maxEntries, validity);
+        CHECK(maxEntries == 500);
+        CHECK(validity == 120);
+    }
+
+    SUBCASE("Should default valid to 60 seconds") {
+        const std::string str = "open_file_cache max=10; server { listen 8080; }";
+        config::ServerConfig sc(str, false);
+        sc.openFileCache(maxEntries, validity);
+        CHECK(maxEntries == 10);
+        CHECK(validity == 60);
+    }
+
+    SUBCASE("Should accept off") {
+        const std::string str = "open_file_cache off; server { listen 8080; }";
+        config::ServerConfig sc(str, false);
+        sc.openFileCache(maxEntries, validity);
+        CHECK(maxEntries == 0);
+    }
+
+    SUBCASE("Should reject invalid values") {
+        const std::string noMax = "open_file_cache valid=10s; server { listen 8080; }";
+        const std::string zero = "open_file_cache max=0; server { listen 8080; }";
+        const std::string badTime = "open_file_cache max=10 valid=soon; server { listen 8080; }";
+        const std::string unknown = "open_file_cache max=10 inactive=5s; server { listen 8080; }";
+        CHECK_THROWS_AS((config::ServerConfig(noMax, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(zero, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(badTime, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(unknown, false)), const config::ConfigError &);
+    }
+
+    SUBCASE("Should reject open_file_cache inside a server block") {
+        const std::string str = "server { listen 8080; open_file_cache max=10; }";
+        CHECK_THROWS_AS((config::ServerConfig(str, false)), const config::ConfigError &);
+    }
+}
@@ -43,6 +43,16 @@ TEST_CASE("Parser") {
         CHECK(nodes[1].directives.at("listen")[0].literal == "443");
     }
 
+    SUBCASE("Should collect top-level directives into a main node") {
+        const std::string WITH_MAIN = "worker_processes 2; server { listen 80; }";
+        config::TokenArray tokens = config::Lexer::tokenize(WITH_MAIN);
+        config::ConfigNodeVec nodes = config::Parser::parse(tokens);
+        REQUIRE(nodes.size() == 2);
+        CHECK(nodes[0].name == "main");
+        CHECK(nodes[0].directives.at("worker_processes")[0].literal == "2");
+        CHECK(nodes[1].name == "server");
+    }
+
     SUBCASE("Should throw on missing semicolon") {
         const std::string MISSING_SEMICOLON = "server { listen 8080 }";
         config::TokenArray tokens = config::Lexer::tokenize(MISSING_SEMICOLON);
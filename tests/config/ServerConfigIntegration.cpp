@@ -84,33 +84,52 @@ TEST_CASE("ServerConfig Integration") {
     }
 }
 
-TEST_CASE("Virtual Server Matching (Future Feature)") {
+TEST_CASE("Virtual Server Matching") {
     SUBCASE("Should select server based on server_name") {
         config::ServerBlock f;
         f.port(8080).root("/var/www/first/");
-        f.add("server_name", "first.com");
-        f.add("server_name", "www.first.com");
+        std::vector<std::string> firstNames;
+        firstNames.push_back("first.com");
+        firstNames.push_back("www.first.com");
+        f.add("server_name", firstNames);
         config::ServerBlock second;
         second.port(8080).root("/var/www/second/");
-        f.add("server_name", "second.com");
+        second.add("server_name", "second.com");
         config::ServerConfig sc;
         sc.addServer(f);
         sc.addServer(second);
 
         const config::ServerBlock *sb_second = testGS(sc, 8080, "second.com");
-        const config::ServerBlock *sb_first = testGS(sc, 8080, "www.first.com");
+        const config::ServerBlock *sb_first = testGS(sc, 8080, "www.first.com:8080");
         const config::ServerBlock *sb_default = testGS(sc, 8080, "notfound.com");
-        (void)sb_second;
-        (void)sb_first;
-        (void)sb_default;
-
-        MESSAGE("This test is expected to fail until virtual server matching is implemented in "
-                "ServerConfig::getServer.");
-#if 0
-        CHECK(sb_second->getRoot() == "/var/www/second/");
-        CHECK(sb_first->getRoot() == "/var/www/first/");
+        REQUIRE(sb_second);
+        REQUIRE(sb_first);
+        REQUIRE(sb_default);
+        CHECK(sb_second->root() == "/var/www/second/");
+        CHECK(sb_first->root() == "/var/www/first/");
         // The default server should be the first one defined for that port
-        CHECK(sb_default->getRoot() == "/var/www/first/");
-#endif
+        CHECK(sb_default->root() == "/var/www/first/");
+        CHECK(testGS(sc, 8081, "second.com") == NULL);
+    }
+
+    SUBCASE("Should select server based on a wildcard server_name") {
+        const std::string str = "server {\n"
+                                "    listen 8080;\n"
+                                "    root /var/www/default/;\n"
+                                "}\n"
+                                "server {\n"
+                                "    listen 8080;\n"
+                                "    server_name *.example.com;\n"
+                                "    root /var/www/sub/;\n"
+                                "}\n"
+                                "server {\n"
+                                "    listen 8080;\n"
+                                "    server_name example.com;\n"
+                                "    root /var/www/main/;\n"
+                                "}\n";
+        config::ServerConfig sc(str, false);
+        CHECK(testGS(sc, 8080, "Example.COM")->root() == "/var/www/main/");
+        CHECK(testGS(sc, 8080, "api.example.com")->root() == "/var/www/sub/");
+        CHECK(testGS(sc, 8080, "other.org")->root() == "/var/www/default/");
     }
 }
@@ -0,0 +1,39 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("TimeoutDirective") {
+    SUBCASE("Should use the defaults when unset") {
+        config::ServerConfig sc(std::string("server { listen 8080; }"), false);
+        CHECK(sc.timeouts().clientHeader == 60);
+        CHECK(sc.timeouts().clientBody == 60);
+        CHECK(sc.timeouts().keepalive == 75);
+        CHECK(sc.timeouts().send == 60);
+        CHECK(sc.timeouts().cgi == 0);
+        CHECK(sc.timeouts().cgiRead == 60);
+    }
+
+    SUBCASE("Should read durations with units") {
+        const std::string conf = "client_header_timeout 10s; client_body_timeout 2m;"
+                                 "keepalive_timeout 0; send_timeout 30;"
+                                 "cgi_timeout 5m; cgi_read_timeout 15s;"
+                                 "server { listen 8080; }";
+        config::ServerConfig sc(conf, false);
+        CHECK(sc.timeouts().clientHeader == 10);
+        CHECK(sc.timeouts().clientBody == 120);
+        CHECK(sc.timeouts().keepalive == 0);
+        CHECK(sc.timeouts().send == 30);
+        CHECK(sc.timeouts().cgi == 300);
+        CHECK(sc.timeouts().cgiRead == 15);
+    }
+
+    SUBCASE("Should reject invalid values, duplicates and contexts") {
+        const std::string word = "send_timeout soon; server { listen 8080; }";
+        const std::string dup = "send_timeout 1; send_timeout 2; server { listen 8080; }";
+        const std::string inServer = "server { listen 8080; keepalive_timeout 5; }";
+        CHECK_THROWS_AS((config::ServerConfig(word, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(dup, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(inServer, false)), const config::ConfigError &);
+    }
+}
@@ -0,0 +1,42 @@
+#include "config/ServerConfig.hpp"
+#include "config/internal/ConfigException.hpp"
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("WorkerProcessesDirective") {
+    SUBCASE("Should default to a single worker") {
+        config::ServerConfig sc(std::string("server { listen 8080; }"), false);
+        CHECK(sc.workerProcesses() == 1);
+    }
+
+    SUBCASE("Should read the worker count from the main context") {
+        const std::string configStr = R"(
+worker_processes 4;
+server {
+    listen 8080;
+}
+        )";
+
+        config::ServerConfig sc(configStr, false);
+        CHECK(sc.workerProcesses() == 4);
+        CHECK(sc.getServersMap().size() == 1);
+    }
+
+    SUBCASE("Should accept auto") {
+        const std::string configStr = "worker_processes auto; server { listen 8080; }";
+        config::ServerConfig sc(configStr, false);
+        CHECK(sc.workerProcesses() >= 1);
+    }
+
+    SUBCASE("Should reject invalid values") {
+        const std::string zero = "worker_processes 0; server { listen 8080; }";
+        const std::string word = "worker_processes many; server { listen 8080; }";
+        CHECK_THROWS_AS((config::ServerConfig(zero, false)), const config::ConfigError &);
+        CHECK_THROWS_AS((config::ServerConfig(word, false)), const config::ConfigError &);
+    }
+
+    SUBCASE("Should reject worker_processes inside a server block") {
+        const std::string str = "server { listen 8080; worker_processes 2; }";
+        CHECK_THROWS_AS((config::ServerConfig(str, false)), const config::ConfigError &);
+    }
+}
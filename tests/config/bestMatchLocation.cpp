@@ -1,16 +1,21 @@
 #include "config/LocationBlock.hpp"
+#include "config/LocationIndex.hpp"
 #include "config/ServerBlock.hpp"
 #include "doctest.h"
 #include "http/Request.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
 
 using namespace config;
 
 // --- Test Fixture Setup ---
-// This struct creates a pre-configured map of locations for our tests.
+// This struct creates a pre-configured map of locations for our tests, and their index.
 struct LocationTestFixture {
     std::map<std::string, LocationBlock> locations;
+    LocationIndex index;
 
     LocationTestFixture() {
         LocationBlock root;
@@ -27,33 +32,37 @@ struct LocationTestFixture {
         imagesJpg.path("/images/jpg/");
         imagesJpg.add("root", "/var/www/data/images/jpg");
         locations[imagesJpg.path()] = imagesJpg;
+
+        for (std::map<std::string, LocationBlock>::const_iterator it = locations.begin();
+             it != locations.end(); ++it)
+            index.add(it->second);
     }
 };
 
 TEST_CASE("LocationMatcher: Basic Matches") {
     LocationTestFixture fixture;
-    const std::map<std::string, LocationBlock> &locs = fixture.locations;
+    const LocationIndex &locs = fixture.index;
 
     SUBCASE("Should find an exact match for a directory") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "/images/");
+        const LocationBlock *result = locs.matchPrefix("/images/");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/images/");
     }
 
     SUBCASE("Should find a prefix match for a file inside a directory") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "/images/logo.png");
+        const LocationBlock *result = locs.matchPrefix("/images/logo.png");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/images/");
     }
 
     SUBCASE("Should fall back to the root location '/' for unmatched paths") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "/some/other/path.html");
+        const LocationBlock *result = locs.matchPrefix("/some/other/path.html");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/");
     }
 
     SUBCASE("Should match the root location '/' exactly") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "/");
+        const LocationBlock *result = locs.matchPrefix("/");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/");
     }
@@ -61,19 +70,19 @@ TEST_CASE("LocationMatcher: Basic Matches") {
 
 TEST_CASE("LocationMatcher: Longest Prefix Matching") {
     LocationTestFixture fixture;
-    const std::map<std::string, LocationBlock> &locs = fixture.locations;
+    const LocationIndex &locs = fixture.index;
 
     SUBCASE("Should select the most specific (longest) matching prefix") {
         // This request matches "/", "/images/", and "/images/jpg/"
         // The longest match, "/images/jpg/", must be chosen.
-        const LocationBlock *result = details::bestMatchLocation(locs, "/images/jpg/summer.jpeg");
+        const LocationBlock *result = locs.matchPrefix("/images/jpg/summer.jpeg");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/images/jpg/");
         CHECK(result->root() == "/var/www/data/images/jpg");
     }
 
     SUBCASE("Should select '/images/' over '/'") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "/images/png/winter.png");
+        const LocationBlock *result = locs.matchPrefix("/images/png/winter.png");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/images/");
     }
@@ -81,24 +90,26 @@ TEST_CASE("LocationMatcher: Longest Prefix Matching") {
 
 TEST_CASE("LocationMatcher: Edge Cases") {
     LocationTestFixture fixture;
-    const std::map<std::string, LocationBlock> &locs = fixture.locations;
+    const LocationIndex &locs = fixture.index;
 
     SUBCASE("Should return NULL if no locations are configured") {
-        std::map<std::string, LocationBlock> emptyLocs;
-        const LocationBlock *result = details::bestMatchLocation(emptyLocs, "/any/path");
+        LocationIndex emptyLocs;
+        const LocationBlock *result = emptyLocs.matchPrefix("/any/path");
         CHECK(result == NULL);
     }
 
     SUBCASE("Should return NULL if no root '/' fallback exists for an unmatched path") {
-        std::map<std::string, LocationBlock> noRootLocs;
-        noRootLocs["/data/"] = LocationBlock(); // A map with no "/" location
+        LocationBlock data;
+        data.path("/data/");
+        LocationIndex noRootLocs; // An index with no "/" location
+        noRootLocs.add(data);
 
-        const LocationBlock *result = details::bestMatchLocation(noRootLocs, "/unmatched/path");
+        const LocationBlock *result = noRootLocs.matchPrefix("/unmatched/path");
         CHECK(result == NULL);
     }
 
     SUBCASE("Should handle an empty request URI by matching the root") {
-        const LocationBlock *result = details::bestMatchLocation(locs, "");
+        const LocationBlock *result = locs.matchPrefix("");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/");
     }
@@ -106,7 +117,7 @@ TEST_CASE("LocationMatcher: Edge Cases") {
     SUBCASE("Should correctly handle paths without a trailing slash") {
         // A request for "/images" now matches "location /images/" due to "smart" matching.
         // This improves UX by avoiding unnecessary 404s/redirects for directory prefixes.
-        const LocationBlock *result = details::bestMatchLocation(locs, "/images");
+        const LocationBlock *result = locs.matchPrefix("/images");
         REQUIRE(result != NULL);
         CHECK(result->path() == "/images/");
     }
@@ -178,3 +189,142 @@ TEST_CASE("LocationMatcher: Regex Matching") {
         CHECK(result->getFirstRawValue("id") == "1");
     }
 }
+
+namespace {
+
+/** The map walk the index replaced, kept as the reference for its prefix rules. */
+const LocationBlock *referenceMatch(std::map<std::string, LocationBlock> const &ls,
+                                    std::string const &path) {
+    std::map<std::string, LocationBlock>::const_iterator it = ls.find(path);
+    if (it != ls.end())
+        return &it->second;
+    if (!path.empty() && path[path.size() - 1] != '/') {
+        it = ls.find(path + "/");
+        if (it != ls.end())
+            return &it->second;
+    }
+    std::string current = path;
+    while (!current.empty() && current != "/") {
+        size_t pos = current.rfind('/', current.size() - 2);
+        if (pos == std::string::npos)
+            break;
+        current.resize(pos + 1);
+        it = ls.find(current);
+        if (it != ls.end())
+            return &it->second;
+    }
+    it = ls.find("/");
+    return it != ls.end() ? &it->second : NULL;
+}
+
+} // namespace
+
+TEST_CASE("LocationIndex: same prefix matches as the map walk") {
+    char const *const paths[] = {"/",        "/a",      "/a/",      "/a/b/",  "/ab/",
+                                 "/abc",     "/a/bc/",  "/b/",      "/b/c/d/", "x/",
+                                 "/a/b/c",   "/a/b/c/", "/images/", "/img/",  "/i/"};
+    char const *const uris[] = {"",       "/",         "/a",       "/a/",     "/ab",
+                                "/abc",   "/abc/",     "/a/b",     "/a/b/x",  "/a/bc",
+                                "/a/bcd", "/a/b/c",    "/a/b/c/d", "/b",      "/b/c/d",
+                                "/b/c/",  "x",         "x/y",      "//",      "/a//b/",
+                                "/image", "/images/x", "/im",      "/i",      "/zzz"};
+    const size_t pathCount = sizeof(paths) / sizeof(paths[0]);
+    const size_t uriCount = sizeof(uris) / sizeof(uris[0]);
+
+    bool allMatch = true;
+    // Every subset of the first 10 paths, plus the rest, inserted in two orders
+    for (unsigned mask = 0; mask < (1u << 10); mask += 7) {
+        for (int reversed = 0; reversed < 2; ++reversed) {
+            std::map<std::string, LocationBlock> locations;
+            for (size_t i = 0; i < pathCount; ++i) {
+                if (i < 10 && !(mask & (1u << i)))
+                    continue;
+                locations[paths[i]].path(paths[i]);
+            }
+            LocationIndex index;
+            std::vector<LocationBlock const *> order;
+            for (std::map<std::string, LocationBlock>::const_iterator it = locations.begin();
+                 it != locations.end(); ++it)
+                order.push_back(&it->second);
+            if (reversed)
+                std::reverse(order.begin(), order.end());
+            for (size_t i = 0; i < order.size(); ++i)
+                index.add(*order[i]);
+
+            for (size_t u = 0; u < uriCount; ++u) {
+                if (index.matchPrefix(uris[u]) != referenceMatch(locations, uris[u])) {
+                    allMatch = false;
+                    MESSAGE("mask " << mask << ": mismatch for '" << uris[u] << "'");
+                }
+            }
+        }
+    }
+    CHECK(allMatch);
+}
+
+TEST_CASE("LocationIndex: extensions") {
+    LocationBlock gz, tarGz, py, php;
+    gz.path("\\.gz$").matchType(LocationBlock::EXTENSION).extension(".gz");
+    tarGz.path("\\.tar.gz$").matchType(LocationBlock::EXTENSION).extension(".tar.gz");
+    py.path("\\.py$").matchType(LocationBlock::EXTENSION).extension(".py");
+    php.path("\\.php$").matchType(LocationBlock::EXTENSION).extension(".php");
+
+    LocationIndex index;
+    CHECK(index.matchExtension("/a.py") == NULL);
+    index.add(tarGz);
+    index.add(py);
+    index.add(gz);
+    index.add(php);
+
+    CHECK(index.matchExtension("/x/archive.tar.gz") == &tarGz); // Declared first
+    CHECK(index.matchExtension("/x/archive.gz") == &gz);
+    CHECK(index.matchExtension("/x/a.py") == &py);
+    CHECK(index.matchExtension(".py") == &py);
+    CHECK(index.matchExtension("/index.php") == &php);
+    CHECK(index.matchExtension("/index.php/") == NULL);
+    CHECK(index.matchExtension("/index.phps") == NULL);
+    CHECK(index.matchExtension("py") == NULL);
+    CHECK(index.matchExtension("") == NULL);
+
+    SUBCASE("many extensions") {
+        std::vector<LocationBlock> many(1000);
+        LocationIndex big;
+        for (size_t i = 0; i < many.size(); ++i) {
+            std::string ext = ".e" + toString(i);
+            many[i].path("\\" + ext + "$").matchType(LocationBlock::EXTENSION).extension(ext);
+            big.add(many[i]);
+        }
+        bool allFound = true;
+        for (size_t i = 0; i < many.size(); ++i) {
+            if (big.matchExtension("/file.e" + toString(i)) != &many[i])
+                allFound = false;
+        }
+        CHECK(allFound);
+        CHECK(big.matchExtension("/file.e1000") == NULL);
+    }
+}
+
+TEST_CASE("LocationMatcher: copied server blocks match their own locations") {
+    ServerBlock *original = new ServerBlock;
+    LocationBlock root, images, php;
+    root.path("/");
+    images.path("/images/");
+    php.path("\\.php$").matchType(LocationBlock::EXTENSION).extension(".php");
+    original->addLocation(root);
+    original->addLocation(images);
+    original->addLocation(php);
+
+    ServerBlock copy(*original);
+    ServerBlock assigned;
+    assigned = *original;
+    delete original;
+
+    http::Request req;
+    req.uri("/images/a.png");
+    REQUIRE(copy.matchLocation(req) != NULL);
+    CHECK(copy.matchLocation(req)->path() == "/images/");
+    CHECK(copy.matchLocation(req)->parent() == &copy);
+    req.uri("/x.php");
+    REQUIRE(assigned.matchLocation(req) != NULL);
+    CHECK(assigned.matchLocation(req)->path() == "\\.php$");
+}
@@ -1,85 +1,145 @@
-#include "config/ServerBlock.hpp"
+#include "config/VirtualHosts.hpp"
 #include "doctest.h"
+#include "test_utils.hpp"
 
-using namespace config::details;
+using config::VirtualHosts;
+
+namespace {
+
+VirtualHosts hostsOf(char const *const *names, size_t count) {
+    VirtualHosts hosts;
+    for (size_t i = 0; i < count; ++i)
+        hosts.add(names[i], i);
+    return hosts;
+}
+
+bool matches(VirtualHosts const &hosts, std::string const &host) {
+    return hosts.find(host) != VirtualHosts::NONE;
+}
+
+} // namespace
 
 TEST_CASE("ServerNameMatcher: Exact and Case-Insensitive Matches") {
-    std::vector<std::string> serverNames;
-    serverNames.push_back("example.com");
-    serverNames.push_back("www.example.org");
+    char const *const names[] = {"example.com", "www.example.org"};
+    VirtualHosts serverNames = hostsOf(names, 2);
 
     SUBCASE("Should find an exact match") {
-        CHECK(matchServerName(serverNames, "example.com") == true);
+        CHECK(serverNames.find("example.com") == 0);
+        CHECK(serverNames.find("www.example.org") == 1);
     }
 
-#if 0
     SUBCASE("Should perform a case-insensitive match") {
-        CHECK(matchServerName(serverNames, "EXAMPLE.com") == true);
-        CHECK(matchServerName(serverNames, "WwW.ExAmPlE.oRg") == true);
+        CHECK(matches(serverNames, "EXAMPLE.com") == true);
+        CHECK(matches(serverNames, "WwW.ExAmPlE.oRg") == true);
+    }
+
+    SUBCASE("Should ignore the port and a trailing dot") {
+        CHECK(serverNames.find("example.com:8080") == 0);
+        CHECK(serverNames.find("example.com.") == 0);
+        CHECK(serverNames.find("example.com.:80") == 0);
     }
-#endif
 
     SUBCASE("Should not find a name that does not exist") {
-        CHECK(matchServerName(serverNames, "test.com") == false);
+        CHECK(matches(serverNames, "test.com") == false);
     }
 }
 
 TEST_CASE("ServerNameMatcher: Wildcard Matches") {
-    std::vector<std::string> serverNames;
-    serverNames.push_back("*.example.com"); // Leading wildcard
-    serverNames.push_back("www.example.*"); // Trailing wildcard
+    char const *const names[] = {"*.example.com", "www.example.*"};
+    VirtualHosts serverNames = hostsOf(names, 2);
 
-#if 0
     SUBCASE("Leading wildcard should match subdomains") {
-        CHECK(matchServerName(serverNames, "api.example.com") == true);
-        CHECK(matchServerName(serverNames, "staging.api.example.com") == true);
-        CHECK(matchServerName(serverNames, "WWW.EXAMPLE.COM") == true);
+        CHECK(matches(serverNames, "api.example.com") == true);
+        CHECK(matches(serverNames, "staging.api.example.com") == true);
+        CHECK(serverNames.find("WWW.EXAMPLE.COM") == 0); // Leading wins over trailing
     }
-#endif
 
     SUBCASE("Leading wildcard should NOT match the base domain") {
-        CHECK(matchServerName(serverNames, "example.com") == false);
+        CHECK(matches(serverNames, "example.com") == false);
     }
 
-#if 0
     SUBCASE("Trailing wildcard should match different TLDs") {
-        CHECK(matchServerName(serverNames, "www.example.com") == true);
-        CHECK(matchServerName(serverNames, "www.example.org") == true);
-        CHECK(matchServerName(serverNames, "www.example.net") == true);
+        CHECK(serverNames.find("www.example.org") == 1);
+        CHECK(serverNames.find("www.example.net") == 1);
+        CHECK(matches(serverNames, "www.example.co.uk") == true);
     }
-#endif
 
     SUBCASE("Trailing wildcard should NOT match subdomains") {
-        CHECK(matchServerName(serverNames, "api.www.example.com") == false);
+        CHECK(matches(serverNames, "api.www.example.org") == false);
     }
 
     SUBCASE("Should not match if wildcard is in the middle") {
-        std::vector<std::string> middleWildcard;
-        middleWildcard.push_back("www.*.com");
-        CHECK(matchServerName(middleWildcard, "www.example.com") == false);
+        VirtualHosts middleWildcard;
+        middleWildcard.add("www.*.com", 0);
+        CHECK(matches(middleWildcard, "www.example.com") == false);
+    }
+
+    SUBCASE("The longest wildcard wins, then the exact name") {
+        char const *const more[] = {"*.com", "*.example.com", "*.api.example.com",
+                                    "api.example.com", "www.*", "www.example.*"};
+        VirtualHosts hosts = hostsOf(more, 6);
+        CHECK(hosts.find("a.api.example.com") == 2);
+        CHECK(hosts.find("api.example.com") == 3);
+        CHECK(hosts.find("b.example.com") == 1);
+        CHECK(hosts.find("example.com") == 0);
+        CHECK(hosts.find("www.example.net") == 5);
+        CHECK(hosts.find("www.other.net") == 4);
+    }
+
+    SUBCASE("A leading dot stands for the name and its subdomains") {
+        VirtualHosts dotted;
+        dotted.add(".example.com", 7);
+        CHECK(dotted.find("example.com") == 7);
+        CHECK(dotted.find("a.b.example.com") == 7);
+        CHECK(matches(dotted, "badexample.com") == false);
     }
 }
 
 TEST_CASE("ServerNameMatcher: Edge Cases") {
-    std::vector<std::string> serverNames;
-    serverNames.push_back("example.com");
-    serverNames.push_back("_"); // Default server name
+    char const *const names[] = {"example.com", "_"}; // "_": the usual catch-all
+    VirtualHosts serverNames = hostsOf(names, 2);
 
-#if 0
     SUBCASE("Should handle empty server name list") {
-        std::vector<std::string> emptyList;
-        CHECK(matchServerName(emptyList, "example.com") == false);
+        VirtualHosts emptyList;
+        CHECK(matches(emptyList, "example.com") == false);
     }
-#endif
 
     SUBCASE("Should handle empty host name string") {
-        CHECK(matchServerName(serverNames, "") == false);
+        CHECK(matches(serverNames, "") == false);
     }
 
-    SUBCASE("Should treat '_' as a catch-all default (if implemented)") {}
+    SUBCASE("Should handle IPv6 literals") {
+        VirtualHosts hosts;
+        hosts.add("[::1]", 3);
+        CHECK(hosts.find("[::1]:8080") == 3);
+        CHECK(hosts.find("[::1]") == 3);
+    }
 
     SUBCASE("Should not match partial names") {
-        CHECK(matchServerName(serverNames, "ample.com") == false);
-        CHECK(matchServerName(serverNames, "example.co") == false);
+        CHECK(matches(serverNames, "ample.com") == false);
+        CHECK(matches(serverNames, "example.co") == false);
+    }
+
+    SUBCASE("The first server declaring a name keeps it") {
+        VirtualHosts hosts;
+        hosts.add("example.com", 0);
+        hosts.add("EXAMPLE.com", 1);
+        CHECK(hosts.find("example.com") == 0);
+    }
+
+    SUBCASE("Hundreds of names") {
+        VirtualHosts hosts;
+        for (size_t i = 0; i < 500; ++i) {
+            hosts.add("tenant" + toString(i) + ".example.com", i);
+            hosts.add("*.tenant" + toString(i) + ".example.net", i);
+        }
+        bool allFound = true;
+        for (size_t i = 0; i < 500; ++i) {
+            if (hosts.find("tenant" + toString(i) + ".example.com") != i ||
+                hosts.find("www.tenant" + toString(i) + ".example.net") != i)
+                allFound = false;
+        }
+        CHECK(allFound);
+        CHECK(matches(hosts, "tenant500.example.com") == false);
     }
 }
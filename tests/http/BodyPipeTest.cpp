@@ -0,0 +1,89 @@
+#include "doctest.h"
+
+#include "http/BodyPipe.hpp"
+#include "http/RequestBody.hpp"
+#include <csignal>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+using namespace http;
+
+static std::string readAvailable(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+        out.append(buf, n);
+    fcntl(fd, F_SETFL, flags);
+    return out;
+}
+
+TEST_CASE("BodyPipe - a request body streaming to a CGI's stdin") {
+    BodyPipe pipe;
+
+    SUBCASE("bytes before open() wait for the script") {
+        pipe.write("early", 5);
+        CHECK(pipe.fd() == -1);
+        CHECK(pipe.flush() == BodyPipe::PENDING);
+        int reader = pipe.open();
+        REQUIRE(reader != -1);
+        CHECK(pipe.flush() == BodyPipe::FLUSHED);
+        pipe.write(" late", 5);
+        CHECK(readAvailable(reader) == "early late");
+        pipe.finish();
+        CHECK(pipe.flush() == BodyPipe::DONE);
+        pipe.close();
+        CHECK(pipe.fd() == -1);
+        char c;
+        CHECK(read(reader, &c, 1) == 0); // EOF for the script
+        close(reader);
+    }
+
+    SUBCASE("a full pipe buffers and reports backpressure") {
+        int reader = pipe.open();
+        REQUIRE(reader != -1);
+        std::string chunk(16 * 1024, 'x');
+        size_t sent = 0;
+        while (!pipe.isFull()) {
+            pipe.write(chunk.data(), chunk.size());
+            sent += chunk.size();
+        }
+        CHECK(pipe.flush() == BodyPipe::PENDING);
+        size_t received = readAvailable(reader).size();
+        while (pipe.flush() == BodyPipe::PENDING)
+            received += readAvailable(reader).size();
+        received += readAvailable(reader).size();
+        CHECK_FALSE(pipe.isFull());
+        CHECK(received == sent);
+        close(reader);
+    }
+
+    SUBCASE("the rest of the body is dropped once the script is gone") {
+        int reader = pipe.open();
+        REQUIRE(reader != -1);
+        close(reader);
+        signal(SIGPIPE, SIG_IGN); // As the server does
+        pipe.write("ignored", 7);
+        CHECK(pipe.flush() == BodyPipe::DONE);
+        CHECK(pipe.fd() != -1); // Closed by its owner, once out of epoll
+        pipe.write("more", 4);
+        CHECK_FALSE(pipe.isFull());
+    }
+}
+
+TEST_CASE("RequestBody - streams through its pipe") {
+    RequestBody body(0, "/tmp");
+    BodyPipe *pipe = new BodyPipe;
+    body.streamTo(pipe);
+    CHECK(body.pipe() == pipe);
+    int reader = pipe->open();
+    REQUIRE(reader != -1);
+    REQUIRE(body.append("streamed", 8));
+    CHECK(body.size() == 8);
+    CHECK(body.fd() == -1); // Nothing is stored
+    CHECK(readAvailable(reader) == "streamed");
+    close(reader);
+}
@@ -0,0 +1,76 @@
+#include "doctest.h"
+
+#include "http/internal/ByteScan.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace http;
+
+namespace {
+
+bool isControl(unsigned char c) { return (c < 0x20 && c != '\t') || c == 0x7f; }
+
+bool isToken(unsigned char c) {
+    return c > 0x20 && c < 0x7f && !std::strchr("\"(),/:;<=>?@[\\]{}", c);
+}
+
+size_t expectedControl(std::string const &s, size_t from) {
+    for (size_t i = from; i < s.size(); ++i) {
+        if (isControl(s[i]))
+            return i - from;
+    }
+    return s.size() - from;
+}
+
+size_t expectedNonToken(std::string const &s, size_t from) {
+    for (size_t i = from; i < s.size(); ++i) {
+        if (!isToken(s[i]))
+            return i - from;
+    }
+    return s.size() - from;
+}
+
+/** Each byte value at several positions of a 64-byte run. */
+void checkEveryByteValue() {
+    for (int c = 0; c < 256; ++c) {
+        for (size_t pos = 0; pos < 64; pos += 7) {
+            std::string s(64, 'a');
+            s[pos] = static_cast<char>(c);
+            CHECK(scan::findControl(s.data(), s.size()) == (isControl(c) ? pos : s.size()));
+            CHECK(scan::findNonToken(s.data(), s.size()) == (isToken(c) ? s.size() : pos));
+        }
+    }
+}
+
+/** Random header-like text at every alignment and length. */
+void checkRandomText() {
+    char const alphabet[] = "abcXYZ019-_.~!:; \t,\r\n\x7f\x01\x80\xff=/";
+    std::srand(42);
+    for (int round = 0; round < 200; ++round) {
+        std::string s;
+        size_t len = std::rand() % 100;
+        for (size_t i = 0; i < len; ++i) {
+            // Mostly token characters, so long runs reach the vector loops
+            s += std::rand() % 8 ? 'k' : alphabet[std::rand() % (sizeof(alphabet) - 1)];
+        }
+        for (size_t from = 0; from <= s.size() && from < 40; ++from) {
+            CHECK(scan::findControl(s.data() + from, s.size() - from) ==
+                  expectedControl(s, from));
+            CHECK(scan::findNonToken(s.data() + from, s.size() - from) ==
+                  expectedNonToken(s, from));
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("scan - every kernel agrees with the byte-by-byte definition") {
+    scan::Level best = scan::setLevel(scan::AVX2);
+    for (int level = scan::SCALAR; level <= best; ++level) {
+        REQUIRE(scan::setLevel(static_cast<scan::Level>(level)) == level);
+        checkEveryByteValue();
+        checkRandomText();
+    }
+    scan::setLevel(best);
+}
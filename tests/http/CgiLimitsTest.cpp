@@ -0,0 +1,46 @@
+#include "doctest.h"
+
+#include "http/handlers/CGIHandler.hpp"
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using http::CGIHandler;
+
+namespace {
+
+/** Runs `sh -c script` through the `cgi_limits` exec wrapper. @return Its exit status. */
+int runLimited(char const *as, char const *nofile, char const *script) {
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        char const *argv[] = {"sh", CGIHandler::LIMITS_WRAPPER, "0", as, nofile, "/bin/sh",
+                              "-c", script, NULL};
+        _exit(CGIHandler::execWithLimits(8, const_cast<char **>(argv)));
+    }
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+} // namespace
+
+TEST_CASE("CGI limits - hold from the script's first instruction") {
+    SUBCASE("as: an allocation past the limit fails") {
+        char const *script = "exec dd if=/dev/zero of=/dev/null bs=64M count=1";
+        CHECK(runLimited("0", "0", script) == 0);
+        CHECK(runLimited("33554432", "0", script) != 0); // 32 MiB
+    }
+    SUBCASE("nofile: a descriptor past the limit cannot be opened") {
+        char const *script = "exec 3</dev/null 4</dev/null 5</dev/null";
+        CHECK(runLimited("0", "0", script) == 0);
+        CHECK(runLimited("0", "4", script) != 0);
+    }
+    SUBCASE("Without a script") {
+        char const *argv[] = {"x", CGIHandler::LIMITS_WRAPPER, "0", "0", "1", NULL};
+        CHECK(CGIHandler::execWithLimits(5, const_cast<char **>(argv)) == 127);
+    }
+}
@@ -0,0 +1,212 @@
+#include "doctest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "http/FastCgi.hpp"
+
+using namespace http;
+
+namespace {
+
+/** Decodes @p input in slices of @p step bytes, collecting STDOUT and STDERR. */
+fastcgi::ResponseDecoder::Event decodeAll(std::vector<char> const &input, size_t step,
+                                          std::string &out, std::string &err) {
+    fastcgi::ResponseDecoder decoder;
+    fastcgi::ResponseDecoder::Event event = fastcgi::ResponseDecoder::NEED_MORE;
+    for (size_t at = 0; at < input.size(); at += step) {
+        char const *data = &input[at];
+        size_t length = std::min(step, input.size() - at);
+        char const *payload;
+        size_t payloadLength;
+        while ((event = decoder.next(data, length, payload, payloadLength)) !=
+               fastcgi::ResponseDecoder::NEED_MORE) {
+            if (event == fastcgi::ResponseDecoder::OUTPUT)
+                out.append(payload, payloadLength);
+            else if (event == fastcgi::ResponseDecoder::ERROR_OUTPUT)
+                err.append(payload, payloadLength);
+            else
+                return event;
+        }
+    }
+    return event;
+}
+
+void appendEndRequest(std::vector<char> &out) {
+    char const status[8] = {0};
+    fastcgi::appendRecord(out, fastcgi::END_REQUEST, status, sizeof(status));
+}
+
+} // namespace
+
+TEST_CASE("FastCGI records") {
+    SUBCASE("Headers carry the type, request id, length and padding") {
+        std::vector<char> out;
+        fastcgi::appendRecord(out, fastcgi::STDIN, "hello", 5);
+        REQUIRE(out.size() == 16);
+        unsigned char const expected[8] = {1, fastcgi::STDIN, 0, 1, 0, 5, 3, 0};
+        CHECK(std::memcmp(&out[0], expected, 8) == 0);
+        CHECK(std::string(&out[8], 5) == "hello");
+    }
+
+    SUBCASE("An empty content is the record closing a stream") {
+        std::vector<char> out;
+        fastcgi::appendRecord(out, fastcgi::PARAMS, NULL, 0);
+        REQUIRE(out.size() == 8);
+        CHECK(out[4] == 0);
+        CHECK(out[5] == 0);
+    }
+
+    SUBCASE("Long content is split into records of at most 65535 bytes") {
+        std::string content(70000, 'x');
+        std::vector<char> out;
+        fastcgi::appendRecord(out, fastcgi::STDOUT, content.data(), content.size());
+        CHECK(static_cast<unsigned char>(out[4]) == 0xff);
+        CHECK(static_cast<unsigned char>(out[5]) == 0xff);
+        appendEndRequest(out);
+        std::string stdoutData, stderrData;
+        CHECK(decodeAll(out, out.size(), stdoutData, stderrData) == fastcgi::ResponseDecoder::END);
+        CHECK(stdoutData == content);
+    }
+
+    SUBCASE("Params use one byte for short lengths and four for long ones") {
+        std::vector<char> out;
+        std::string longValue(200, 'v');
+        fastcgi::appendParam(out, "A", 1, "bc", 2);
+        fastcgi::appendParam(out, "LONG", 4, longValue.data(), longValue.size());
+        REQUIRE(out.size() == 2 + 1 + 2 + 1 + 4 + 4 + 200);
+        CHECK(out[0] == 1);
+        CHECK(out[1] == 2);
+        CHECK(std::string(&out[2], 3) == "Abc");
+        CHECK(out[5] == 4);
+        unsigned char const length[4] = {0x80, 0, 0, 200};
+        CHECK(std::memcmp(&out[6], length, 4) == 0);
+    }
+}
+
+TEST_CASE("FastCGI ResponseDecoder") {
+    std::vector<char> response;
+    fastcgi::appendRecord(response, fastcgi::STDERR, "warning", 7);
+    fastcgi::appendRecord(response, fastcgi::STDOUT, "Status: 200\r\n\r\n", 15);
+    fastcgi::appendRecord(response, fastcgi::STDOUT, "body", 4);
+    fastcgi::appendRecord(response, fastcgi::STDOUT, NULL, 0);
+    appendEndRequest(response);
+
+    SUBCASE("Whatever the input is cut into, the output is the same") {
+        size_t const steps[] = {1, 3, 8, 13, 64, 4096};
+        for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i) {
+            std::string out, err;
+            CHECK(decodeAll(response, steps[i], out, err) == fastcgi::ResponseDecoder::END);
+            CHECK(out == "Status: 200\r\n\r\nbody");
+            CHECK(err == "warning");
+        }
+    }
+
+    SUBCASE("A truncated response needs more") {
+        response.resize(response.size() - 3);
+        std::string out, err;
+        CHECK(decodeAll(response, 5, out, err) == fastcgi::ResponseDecoder::NEED_MORE);
+    }
+
+    SUBCASE("Anything but version 1 is invalid") {
+        response[0] = 'H';
+        std::string out, err;
+        CHECK(decodeAll(response, 64, out, err) == fastcgi::ResponseDecoder::INVALID);
+    }
+}
+
+TEST_CASE("FastCGI ConnectionPool") {
+    std::string const path = "/tmp/webserv_fastcgi_pool_test.sock";
+    std::string const backend = "unix:" + path;
+    std::remove(path.c_str());
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(listener != -1);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    REQUIRE(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    REQUIRE(::listen(listener, 8) == 0);
+
+    fastcgi::ConnectionPool &pool = fastcgi::ConnectionPool::getInstance();
+    pool.clear();
+
+    SUBCASE("A released connection is handed out again") {
+        int fd = pool.acquire(backend);
+        REQUIRE(fd != -1);
+        int peer = ::accept(listener, NULL, NULL);
+        pool.release(backend, fd);
+        CHECK(pool.idleCount(backend) == 1);
+        CHECK(pool.acquire(backend) == fd);
+        CHECK(pool.idleCount(backend) == 0);
+        ::close(fd);
+        ::close(peer);
+    }
+
+    SUBCASE("A connection closed by the backend while idle is dropped") {
+        int fd = pool.acquire(backend);
+        REQUIRE(fd != -1);
+        ::close(::accept(listener, NULL, NULL));
+        pool.release(backend, fd);
+        int next = pool.acquire(backend);
+        CHECK(next != -1);
+        CHECK(pool.idleCount(backend) == 0);
+        ::close(next);
+    }
+
+    SUBCASE("An unreachable backend fails") {
+        CHECK(pool.acquire("unix:/tmp/webserv_fastcgi_nobody.sock") == -1);
+        CHECK(pool.acquire("not-an-address") == -1);
+    }
+
+    pool.clear();
+    ::close(listener);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("FastCgiBody") {
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    std::vector<std::string> envp;
+    envp.push_back("REQUEST_METHOD=GET");
+    envp.push_back("QUERY_STRING=a=1");
+
+    {
+        FastCgiBody body("unix:/tmp/webserv_fastcgi_body_test.sock", fds[0], envp, -1, true);
+        CHECK(body.getEventSourceFd() == fds[0]);
+        REQUIRE(body.sendRequest() == IResponseBody::REQUEST_SENT);
+
+        // BEGIN_REQUEST, PARAMS, the empty PARAMS and the empty STDIN
+        char request[256];
+        ssize_t n = ::read(fds[1], request, sizeof(request));
+        REQUIRE(n > 0);
+        CHECK(request[1] == fastcgi::BEGIN_REQUEST);
+        CHECK(request[8 + 2] == 1); // FCGI_KEEP_CONN
+        CHECK(request[16 + 1] == fastcgi::PARAMS);
+        std::string params(request, n);
+        CHECK(params.find("REQUEST_METHOD") != std::string::npos);
+        CHECK(params.find("a=1") != std::string::npos);
+        unsigned char const end[8] = {1, fastcgi::STDIN, 0, 1, 0, 0, 0, 0};
+        CHECK(std::memcmp(request + n - 8, end, 8) == 0);
+
+        char buffer[64];
+        CHECK(body.read(buffer, sizeof(buffer)) == -1); // Nothing yet
+
+        std::vector<char> response;
+        fastcgi::appendRecord(response, fastcgi::STDOUT, "Content-Type: x\r\n\r\nhi", 21);
+        appendEndRequest(response);
+        REQUIRE(::write(fds[1], &response[0], response.size()) ==
+                static_cast<ssize_t>(response.size()));
+        CHECK(body.read(buffer, sizeof(buffer)) == 21);
+        CHECK(std::string(buffer, 21) == "Content-Type: x\r\n\r\nhi");
+        CHECK(body.isDone());
+        CHECK(body.read(buffer, sizeof(buffer)) == 0);
+    }
+    // A backend that was never acquire()d is unknown to the pool: the body closed it
+    char c;
+    CHECK(::read(fds[1], &c, 1) == 0);
+    ::close(fds[1]);
+}
@@ -0,0 +1,89 @@
+#include "doctest.h"
+
+#include "http/Headers.hpp"
+#include <cctype>
+#include <string>
+
+using namespace http;
+
+TEST_CASE("header::lookup - every known name has a slot of its own") {
+    bool allFound = true;
+    for (int id = 0; id < header::COUNT; ++id) {
+        std::string name = header::name(static_cast<header::Id>(id));
+        std::string upper = name;
+        for (size_t i = 0; i < upper.size(); ++i)
+            upper[i] = std::toupper(static_cast<unsigned char>(upper[i]));
+        if (header::lookup(name) != id || header::lookup(upper) != id) {
+            allFound = false;
+            MESSAGE("collision or mismatch for " << name);
+        }
+    }
+    CHECK(allFound);
+
+    CHECK(header::lookup("Content-Length") == header::CONTENT_LENGTH);
+    CHECK(header::lookup("") == header::UNKNOWN);
+    CHECK(header::lookup("X-Custom") == header::UNKNOWN);
+    CHECK(header::lookup("content-lengtx") == header::UNKNOWN);
+    CHECK(header::lookup("hosts") == header::UNKNOWN);
+
+    CHECK(header::name(header::WWW_AUTHENTICATE) == "www-authenticate");
+    CHECK(header::canonicalName(header::WWW_AUTHENTICATE) == "WWW-Authenticate");
+    CHECK(header::canonicalName(header::ETAG) == "ETag");
+}
+
+TEST_CASE("Headers - known and unknown fields") {
+    Headers headers;
+    headers.add("Content-Type", "text/plain");
+    headers.add("X-Custom", "1");
+    headers.add(header::HOST, "example.com");
+    headers.add("x-CUSTOM", "2"); // Replaces, in place
+
+    CHECK(headers.size() == 3);
+    CHECK(headers.get(header::CONTENT_TYPE) == "text/plain");
+    CHECK(headers.get("content-type") == "text/plain");
+    CHECK(headers.get("Host") == "example.com");
+    CHECK(headers.get("X-Custom") == "2");
+    CHECK_FALSE(headers.has(header::CONTENT_LENGTH));
+    CHECK_FALSE(headers.has("X-Other"));
+    CHECK(headers.toString() == "Content-Type: text/plain\r\nX-Custom: 2\r\nHost: example.com\r\n");
+
+    SUBCASE("erase keeps the order of the others") {
+        headers.erase("Content-Type");
+        CHECK_FALSE(headers.has(header::CONTENT_TYPE));
+        CHECK(headers.get(header::HOST) == "example.com");
+        headers.erase("X-CUSTOM");
+        CHECK(headers.size() == 1);
+        headers.add(header::CONTENT_TYPE, "a/b");
+        CHECK(headers.toString() == "Host: example.com\r\nContent-Type: a/b\r\n");
+    }
+
+    SUBCASE("unknown names are sent capitalized") {
+        headers.add("x-powered-BY", "me");
+        headers.add("-odd--name", "v");
+        CHECK(headers.toString() == "Content-Type: text/plain\r\nX-Custom: 2\r\n"
+                                    "Host: example.com\r\nX-Powered-By: me\r\n-Odd--Name: v\r\n");
+    }
+
+    SUBCASE("iteration") {
+        Headers::const_iterator it = headers.begin();
+        CHECK(it->id == header::CONTENT_TYPE);
+        ++it;
+        CHECK(it->id == header::UNKNOWN);
+        CHECK(it->name == "x-custom");
+        CHECK(headers.find("HOST")->value == "example.com");
+        CHECK(headers.find("nope") == headers.end());
+    }
+
+    SUBCASE("clear and reuse, copies") {
+        Headers copy(headers);
+        headers.clear();
+        CHECK(headers.size() == 0);
+        CHECK_FALSE(headers.has(header::HOST));
+        headers.add("Connection", "close");
+        CHECK(headers.toString() == "Connection: close\r\n");
+        CHECK(copy.get(header::HOST) == "example.com");
+        copy = headers;
+        CHECK(copy.size() == 1);
+        CHECK(copy.get("connection") == "close");
+    }
+}
@@ -0,0 +1,136 @@
+#include "doctest.h"
+
+#include "http/internal/MultipartParser.hpp"
+#include <algorithm>
+#include <string>
+
+using namespace http;
+
+namespace {
+
+/** Records the parser's callbacks as "<begin name|filename>data...<end>". */
+struct Recorder : public IMultipartHandler {
+    std::string log;
+    int dataCalls;
+    Recorder() : dataCalls(0) {}
+    virtual bool onPartBegin(MultipartPart const &part) {
+        log += "<begin " + part.name + "|" + part.filename + "|" + part.contentType + ">";
+        return true;
+    }
+    virtual bool onPartData(char const *data, size_t size) {
+        log.append(data, size);
+        ++dataCalls;
+        return true;
+    }
+    virtual bool onPartEnd() {
+        log += "<end>";
+        return true;
+    }
+};
+
+const std::string BODY = "preamble to ignore\r\n"
+                         "--XyZ\r\n"
+                         "Content-Disposition: form-data; name=\"title\"\r\n"
+                         "\r\n"
+                         "hello\r\n"
+                         "--XyZ  \r\n" // Transport padding
+                         "content-disposition: form-data; name=file; filename=\"a;b.txt\"\r\n"
+                         "Content-Type: text/plain\r\n"
+                         "\r\n"
+                         "line\r\n--XyY\r\n--Xy\r\n-\r\n"
+                         "--XyZ--\r\n"
+                         "epilogue to ignore";
+
+const std::string EXPECTED = "<begin title||>hello<end>"
+                             "<begin file|a;b.txt|text/plain>"
+                             "line\r\n--XyY\r\n--Xy\r\n-<end>";
+
+} // namespace
+
+TEST_CASE("MultipartParser - parts in one piece") {
+    Recorder recorder;
+    MultipartParser parser("XyZ", recorder);
+    CHECK(parser.feed(BODY.data(), BODY.size()) == MultipartParser::PARSE_DONE);
+    CHECK(recorder.log == EXPECTED);
+}
+
+TEST_CASE("MultipartParser - any split of the body gives the same parts") {
+    bool allMatch = true;
+    for (size_t split = 0; split <= BODY.size(); ++split) {
+        Recorder recorder;
+        MultipartParser parser("XyZ", recorder);
+        parser.feed(BODY.data(), split);
+        MultipartParser::Status status =
+            parser.feed(BODY.data() + split, BODY.size() - split);
+        if (status != MultipartParser::PARSE_DONE || recorder.log != EXPECTED) {
+            allMatch = false;
+            MESSAGE("split at " << split << ": " << recorder.log);
+        }
+    }
+    CHECK(allMatch);
+
+    Recorder recorder;
+    MultipartParser parser("XyZ", recorder);
+    for (size_t i = 0; i < BODY.size(); ++i)
+        parser.feed(BODY.data() + i, 1);
+    CHECK(parser.status() == MultipartParser::PARSE_DONE);
+    CHECK(recorder.log == EXPECTED);
+}
+
+TEST_CASE("MultipartParser - content is passed on without buffering it") {
+    std::string content(100000, 'x');
+    std::string body = "--b\r\nContent-Disposition: form-data; name=f; filename=big\r\n\r\n" +
+                       content + "\r\n--b--\r\n";
+    Recorder recorder;
+    MultipartParser parser("b", recorder);
+    size_t piece = 8192;
+    for (size_t i = 0; i < body.size(); i += piece)
+        parser.feed(body.data() + i, std::min(piece, body.size() - i));
+    CHECK(parser.status() == MultipartParser::PARSE_DONE);
+    CHECK(recorder.log == "<begin f|big|>" + content + "<end>");
+    CHECK(recorder.dataCalls <= static_cast<int>(2 * (body.size() / piece + 1)));
+}
+
+TEST_CASE("MultipartParser - malformed bodies") {
+    Recorder recorder;
+
+    SUBCASE("part without Content-Disposition") {
+        std::string body = "--b\r\nContent-Type: text/plain\r\n\r\nx\r\n--b--";
+        MultipartParser parser("b", recorder);
+        CHECK(parser.feed(body.data(), body.size()) == MultipartParser::PARSE_ERROR);
+        CHECK(parser.errorStatus() == BAD_REQUEST);
+    }
+
+    SUBCASE("garbage after a delimiter") {
+        std::string body = "--b\r\nContent-Disposition: form-data; name=a\r\n\r\nx\r\n--bzz";
+        MultipartParser parser("b", recorder);
+        CHECK(parser.feed(body.data(), body.size()) == MultipartParser::PARSE_ERROR);
+    }
+
+    SUBCASE("part headers over the limit") {
+        std::string body = "--b\r\nX-Long: " +
+                           std::string(MultipartParser::MAX_PART_HEADER_SIZE, 'a') + "\r\n\r\n";
+        MultipartParser parser("b", recorder);
+        CHECK(parser.feed(body.data(), body.size()) == MultipartParser::PARSE_ERROR);
+    }
+
+    SUBCASE("no close delimiter yet") {
+        std::string body = "--b\r\nContent-Disposition: form-data; name=a\r\n\r\nx\r\n";
+        MultipartParser parser("b", recorder);
+        CHECK(parser.feed(body.data(), body.size()) == MultipartParser::PARSE_CONTINUE);
+    }
+}
+
+TEST_CASE("MultipartParser - boundaryOf") {
+    std::string boundary;
+    CHECK(MultipartParser::boundaryOf("multipart/form-data; boundary=abc", boundary));
+    CHECK(boundary == "abc");
+    CHECK(MultipartParser::boundaryOf("Multipart/Form-Data; charset=x; BOUNDARY=\"a b\"",
+                                      boundary));
+    CHECK(boundary == "a b");
+    CHECK_FALSE(MultipartParser::boundaryOf("multipart/form-data", boundary));
+    CHECK_FALSE(MultipartParser::boundaryOf("multipart/form-data; boundary=", boundary));
+    CHECK_FALSE(MultipartParser::boundaryOf("multipart/mixed; boundary=abc", boundary));
+    CHECK_FALSE(MultipartParser::boundaryOf(
+        "multipart/form-data; boundary=" + std::string(71, 'a'), boundary));
+}
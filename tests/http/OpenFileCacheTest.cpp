@@ -0,0 +1,114 @@
+#include "doctest.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "http/OpenFileCache.hpp"
+
+using namespace http;
+
+static std::string const kCachePath = "/tmp/webserv_open_file_cache_test.txt";
+
+static void writeCacheFile(std::string const &data) {
+    int fd = ::open(kCachePath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    REQUIRE(fd != -1);
+    REQUIRE(::write(fd, data.data(), data.size()) == (ssize_t)data.size());
+    ::close(fd);
+}
+
+TEST_CASE("OpenFileCache") {
+    OpenFileCache &cache = OpenFileCache::getInstance();
+    writeCacheFile("hello");
+
+    SUBCASE("Disabled cache hands out private entries") {
+        cache.configure(0, 0);
+        OpenFileCache::Entry *a = cache.acquire(kCachePath);
+        OpenFileCache::Entry *b = cache.acquire(kCachePath);
+        REQUIRE(a);
+        REQUIRE(b);
+        CHECK(a != b);
+        CHECK(a->fd != -1);
+        CHECK(a->st.st_size == 5);
+        CHECK(cache.size() == 0);
+        cache.release(a);
+        cache.release(b);
+    }
+
+    SUBCASE("Enabled cache shares the descriptor between lookups") {
+        cache.configure(8, 60);
+        OpenFileCache::Entry *a = cache.acquire(kCachePath);
+        OpenFileCache::Entry *b = cache.acquire(kCachePath);
+        REQUIRE(a);
+        CHECK(a == b);
+        CHECK(cache.size() == 1);
+        cache.release(a);
+        cache.release(b);
+    }
+
+    SUBCASE("Missing files are reported through errno") {
+        cache.configure(8, 60);
+        CHECK(cache.acquire("/tmp/webserv_open_file_cache_missing") == NULL);
+        CHECK(errno == ENOENT);
+        CHECK(cache.size() == 0);
+    }
+
+    SUBCASE("Directories are cached without a descriptor") {
+        cache.configure(8, 60);
+        OpenFileCache::Entry *dir = cache.acquire("/tmp");
+        REQUIRE(dir);
+        CHECK(dir->fd == -1);
+        CHECK(S_ISDIR(dir->st.st_mode));
+        cache.release(dir);
+    }
+
+    SUBCASE("Least recently used entries are evicted, pinned ones stay usable") {
+        cache.configure(1, 60);
+        OpenFileCache::Entry *file = cache.acquire(kCachePath);
+        REQUIRE(file);
+        OpenFileCache::Entry *dir = cache.acquire("/tmp");
+        REQUIRE(dir);
+        CHECK(cache.size() == 1);
+
+        char buf[5];
+        CHECK(::pread(file->fd, buf, sizeof(buf), 0) == 5);
+        cache.release(file);
+        cache.release(dir);
+    }
+
+    SUBCASE("Changes on disk invalidate the entry") {
+        cache.configure(8, 60);
+        if (cache.watchFd() == -1) {
+            MESSAGE("inotify unavailable, skipping");
+        } else {
+            OpenFileCache::Entry *before = cache.acquire(kCachePath);
+            REQUIRE(before);
+            cache.release(before);
+
+            writeCacheFile("hello, world");
+            cache.processEvents();
+            CHECK(cache.size() == 0);
+
+            OpenFileCache::Entry *after = cache.acquire(kCachePath);
+            REQUIRE(after);
+            CHECK(after->st.st_size == 12);
+            cache.release(after);
+        }
+    }
+
+    SUBCASE("Expired entries are revalidated") {
+        cache.configure(8, 0);
+        OpenFileCache::Entry *before = cache.acquire(kCachePath);
+        REQUIRE(before);
+        cache.release(before);
+        writeCacheFile("bye");
+        OpenFileCache::Entry *after = cache.acquire(kCachePath);
+        REQUIRE(after);
+        CHECK(after->st.st_size == 3);
+        cache.release(after);
+    }
+
+    cache.configure(0, 0);
+    std::remove(kCachePath.c_str());
+}
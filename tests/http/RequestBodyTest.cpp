@@ -0,0 +1,84 @@
+#include "doctest.h"
+
+#include "http/RequestBody.hpp"
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace http;
+
+static std::string readAll(int fd) {
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+        out.append(buf, n);
+    return out;
+}
+
+TEST_CASE("RequestBody - memory until the limit, then a file") {
+    RequestBody body(8, "/tmp");
+
+    REQUIRE(body.append("hello", 5));
+    CHECK(body.inMemory());
+    CHECK(body.fd() == -1);
+    CHECK(body.path().empty());
+    CHECK(body.data() == "hello");
+
+    SUBCASE("readers see the in-memory bytes") {
+        int fd = body.openReader();
+        REQUIRE(fd != -1);
+        CHECK(readAll(fd) == "hello");
+        close(fd);
+    }
+
+    SUBCASE("crossing the limit spills everything to the file") {
+        REQUIRE(body.append(" world", 6));
+        CHECK_FALSE(body.inMemory());
+        CHECK(body.size() == 11);
+        CHECK(body.path().find("/tmp/") == 0);
+        REQUIRE(body.rewind());
+        int fd = body.openReader();
+        REQUIRE(fd != -1);
+        CHECK(readAll(fd) == "hello world");
+        close(fd);
+
+        std::string path = body.path();
+        {
+            RequestBody other(0, "/tmp");
+            other.append("x", 1);
+            path = other.path();
+            CHECK(access(path.c_str(), F_OK) == 0);
+        }
+        CHECK(access(path.c_str(), F_OK) != 0); // Removed with the body
+    }
+
+    SUBCASE("moving an in-memory body writes the destination") {
+        std::string dest = "/tmp/.webserv-request-body-test";
+        unlink(dest.c_str());
+        CHECK(body.moveTo(dest) == utils::TempFile::MOVE_SUCCESS);
+        int fd = open(dest.c_str(), O_RDONLY);
+        REQUIRE(fd != -1);
+        CHECK(readAll(fd) == "hello");
+        close(fd);
+        CHECK(body.moveTo(dest) == utils::TempFile::MOVE_IO_ERR); // Never overwrites
+        unlink(dest.c_str());
+    }
+}
+
+TEST_CASE("RequestBody - in-memory bodies larger than a pipe") {
+    std::string big(256 * 1024, 'b');
+    RequestBody body(big.size(), "/tmp");
+    REQUIRE(body.append(big.data(), big.size()));
+    CHECK(body.inMemory());
+    int fd = body.openReader();
+    REQUIRE(fd != -1);
+    CHECK(readAll(fd) == big);
+    close(fd);
+}
+
+TEST_CASE("RequestBody - an unusable temp path fails the spill") {
+    RequestBody body(0, "/nonexistent/webserv");
+    CHECK_FALSE(body.append("x", 1));
+}
@@ -0,0 +1,108 @@
+#include "http/internal/RequestHeadParser.hpp"
+#include "doctest.h"
+#include "utils/InputBuffer.hpp"
+#include <string>
+
+using namespace http;
+
+static std::string span(std::string const &buf, RequestHeadParser::Span s) {
+    return buf.substr(s.offset, s.length);
+}
+
+TEST_CASE("RequestHeadParser - request line and fields") {
+    RequestHeadParser parser;
+
+    SUBCASE("Complete head in one buffer") {
+        std::string buf = "GET /a?b=1 HTTP/1.1\r\nHost: x\r\nX-Long:  v a l  \r\n\r\nBODY";
+        REQUIRE(parser.parse(buf.data(), buf.size()) == RequestHeadParser::HEAD_COMPLETE);
+        CHECK(span(buf, parser.method()) == "GET");
+        CHECK(span(buf, parser.target()) == "/a?b=1");
+        CHECK(span(buf, parser.version()) == "HTTP/1.1");
+        CHECK(parser.headEnd() == buf.size() - 4);
+
+        Headers::RawFields const &fields = parser.fields();
+        REQUIRE(fields.size() == 2);
+        CHECK(buf.substr(fields[1].nameOffset, fields[1].nameLength) == "X-Long");
+        CHECK(buf.substr(fields[1].valueOffset, fields[1].valueLength) == "v a l");
+    }
+
+    SUBCASE("Resumes byte by byte") {
+        std::string full = "\r\nPOST /up HTTP/1.0\nContent-Length: 3\n\n";
+        std::string buf;
+        RequestHeadParser::Status status = RequestHeadParser::HEAD_INCOMPLETE;
+        for (size_t i = 0; i < full.size(); ++i) {
+            CHECK(status == RequestHeadParser::HEAD_INCOMPLETE);
+            buf += full[i];
+            status = parser.parse(buf.data(), buf.size());
+        }
+        REQUIRE(status == RequestHeadParser::HEAD_COMPLETE);
+        CHECK(span(buf, parser.method()) == "POST");
+        CHECK(parser.fields().size() == 1);
+        CHECK(parser.headEnd() == full.size());
+    }
+
+    SUBCASE("Starts at an offset for pipelined requests") {
+        std::string buf = "GET / HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n";
+        parser.reset(18);
+        REQUIRE(parser.parse(buf.data(), buf.size()) == RequestHeadParser::HEAD_COMPLETE);
+        CHECK(span(buf, parser.target()) == "/next");
+        CHECK(parser.headEnd() == buf.size());
+    }
+
+    SUBCASE("Malformed heads") {
+        char const *bad[] = {
+            "GET /\r\n\r\n",                          // Missing version
+            "GET / HTTP/1.1 extra\r\n\r\n",           // Too many parts
+            "GET / HTTP/1.1\r\nHost www\r\n\r\n",     // Missing colon
+            "GET / HTTP/1.1\r\nBad Name: v\r\n\r\n",  // Space in the name
+            "GET / HTTP/1.1\r\nHost : v\r\n\r\n",     // Space before the colon
+            "GET / HTTP/1.1\r\nA: b\r\n c\r\n\r\n",   // obs-fold
+            "GET / HTTP/1.1\r\nA: b\rc\r\n\r\n",      // Bare CR in a value
+        };
+        for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+            parser.reset();
+            std::string buf = bad[i];
+            CHECK(parser.parse(buf.data(), buf.size()) == RequestHeadParser::HEAD_ERROR);
+        }
+    }
+}
+
+TEST_CASE("Headers - raw fields") {
+    std::string text = "Host: example.com\r\nCONTENT-length: 42\r\nhost: later\r\n";
+    utils::InputBuffer buf(64);
+    buf.append(text.data(), text.size());
+    Headers::RawFields fields;
+    Headers::RawField f;
+    f.nameOffset = 0, f.nameLength = 4, f.valueOffset = 6, f.valueLength = 11;
+    fields.push_back(f);
+    f.nameOffset = 19, f.nameLength = 14, f.valueOffset = 35, f.valueLength = 2;
+    fields.push_back(f);
+    f.nameOffset = 39, f.nameLength = 4, f.valueOffset = 45, f.valueLength = 5;
+    fields.push_back(f);
+
+    Headers headers;
+    headers.assignRaw(buf, fields);
+    CHECK(fields.empty());
+
+    CHECK(headers.has("content-length"));
+    CHECK_FALSE(headers.has("Accept"));
+    size_t length = 0;
+    CHECK(headers.getContentLength(length));
+    CHECK(length == 42);
+    CHECK(headers.get("HOST") == "later"); // The last field wins, as with add()
+
+    SUBCASE("Copies do not reference the buffer") {
+        Headers copy(headers);
+        buf.clear();
+        buf.append(std::string(text.size(), '?').data(), text.size());
+        CHECK(copy.get("Host") == "later");
+    }
+
+    SUBCASE("Modifying or iterating copies the fields in") {
+        headers.add("Accept", "*/*");
+        buf.clear();
+        buf.append(std::string(text.size(), '?').data(), text.size());
+        CHECK(headers.get("host") == "later");
+        CHECK(headers.size() == 3);
+    }
+}
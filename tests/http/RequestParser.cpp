@@ -1,8 +1,10 @@
 #include "http/RequestParser.hpp"
 #include "TestableRequest.hpp"
+#include "common/string.hpp"
 #include "doctest.h"
 #include "utils/Logger.hpp"
 #include <string>
+#include <unistd.h>
 
 using namespace http;
 
@@ -64,10 +66,42 @@ TEST_CASE("RequestParser - Body Parsing") {
         std::string body = "hello";
         parser.feed(body.c_str(), body.size());
         CHECK(parser.state() == RequestParser::REQUEST_READY);
-        REQUIRE(req.body() != static_cast<utils::TempFile *>(NULL));
+        REQUIRE(req.body() != static_cast<RequestBody *>(NULL));
+        CHECK(req.body()->inMemory()); // Below client_body_buffer_size
+        CHECK(req.body()->data() == "hello");
+    }
+
+    SUBCASE("POST with a Content-Length above client_body_buffer_size") {
+        std::string body(req.getBodyBufferSize() + 1, 'x');
+        std::string rawHeaders = "POST /upload HTTP/1.1\r\nContent-Length: " +
+                                 utils::toString(body.size()) + "\r\n\r\n";
+        parser.feed(rawHeaders.c_str(), rawHeaders.size());
+        parser.proceedReadingBody();
+        parser.feed(body.c_str(), body.size());
+        CHECK(parser.state() == RequestParser::REQUEST_READY);
+        REQUIRE(req.body() != static_cast<RequestBody *>(NULL));
+        CHECK_FALSE(req.body()->inMemory());
         CHECK(req.bodyPath() != "");
     }
 
+    SUBCASE("A body bound for a file can be written to it directly") {
+        std::string body(req.getBodyBufferSize() + 1, 'x');
+        std::string rawHeaders = "POST /upload HTTP/1.1\r\nContent-Length: " +
+                                 utils::toString(body.size()) + "\r\n\r\n";
+        parser.feed(rawHeaders.c_str(), rawHeaders.size());
+        size_t size;
+        CHECK(parser.spliceTarget(size) == -1); // Still at HEADERS_READY
+        parser.proceedReadingBody();
+        parser.feed(body.c_str(), 10);
+        int fd = parser.spliceTarget(size);
+        REQUIRE(fd != -1);
+        CHECK(size == body.size() - 10);
+        REQUIRE(write(fd, body.c_str() + 10, size) == static_cast<ssize_t>(size));
+        CHECK(parser.commitSpliced(size) == RequestParser::REQUEST_READY);
+        CHECK(req.body()->size() == body.size());
+        CHECK(parser.spliceTarget(size) == -1);
+    }
+
     SUBCASE("POST with chunked encoding") {
         std::string rawHeaders = "POST /chat HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
         parser.feed(rawHeaders.c_str(), rawHeaders.size());
@@ -88,4 +122,83 @@ TEST_CASE("RequestParser - Body Parsing") {
         parser.feed(finalChunk.c_str(), finalChunk.size());
         CHECK(parser.state() == RequestParser::REQUEST_READY);
     }
+    SUBCASE("Consecutive chunked requests on one connection") {
+        std::string raw = "POST /chat HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+        std::string body = "5\r\nHello\r\n0\r\n\r\n";
+        for (int i = 0; i < 3; ++i) {
+            parser.feed(raw.c_str(), raw.size());
+            REQUIRE(parser.state() == RequestParser::HEADERS_READY);
+            parser.proceedReadingBody();
+            parser.feed(body.c_str(), body.size());
+            CHECK(parser.state() == RequestParser::REQUEST_READY);
+            parser.reset();
+        }
+    }
+}
+
+TEST_CASE("RequestParser - Content-Length validation") {
+    TestableRequest req;
+    RequestParser parser(req, 1024);
+    std::string fields;
+
+    SUBCASE("Empty value") { fields = "Content-Length: \r\n"; }
+    SUBCASE("Negative value") { fields = "Content-Length: -38\r\n"; }
+    SUBCASE("Not a number") { fields = "Content-Length: abc\r\n"; }
+    SUBCASE("Trailing junk") { fields = "Content-Length: 5x\r\n"; }
+    SUBCASE("A list of values") { fields = "Content-Length: 5, 5\r\n"; }
+    SUBCASE("Overflow") { fields = "Content-Length: 18446744073709551616\r\n"; }
+    SUBCASE("Overflow that would wrap to a small value") {
+        fields = "Content-Length: 18446744073709551654\r\n"; // 2^64 + 38
+    }
+    SUBCASE("Conflicting fields") { fields = "Content-Length: 5\r\nContent-Length: 6\r\n"; }
+    SUBCASE("Along with Transfer-Encoding") {
+        fields = "Content-Length: 5\r\nTransfer-Encoding: chunked\r\n";
+    }
+
+    std::string raw = "POST /upload HTTP/1.1\r\nHost: a\r\n" + fields + "\r\nhello";
+    parser.feed(raw.c_str(), raw.size());
+    CHECK(parser.state() == RequestParser::ERROR);
+    CHECK(parser.errorStatus() == BAD_REQUEST);
+}
+
+TEST_CASE("RequestParser - Repeated identical Content-Length fields") {
+    TestableRequest req;
+    RequestParser parser(req, 1024);
+
+    std::string raw = "POST /upload HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 5\r\n\r\n";
+    parser.feed(raw.c_str(), raw.size());
+    REQUIRE(parser.state() == RequestParser::HEADERS_READY);
+    parser.proceedReadingBody();
+    parser.feed("hello", 5);
+    CHECK(parser.state() == RequestParser::REQUEST_READY);
+}
+
+TEST_CASE("RequestParser - Pipelined requests") {
+    TestableRequest req;
+    RequestParser parser(req, 1024);
+
+    std::string raw = "GET /one HTTP/1.1\r\nHost: a\r\n\r\n"
+                      "POST /two HTTP/1.1\r\nHost: b\r\nContent-Length: 3\r\n\r\nabc"
+                      "GET /three?x=1 HTTP/1.1\r\nHost: c\r\n\r\n";
+    parser.feed(raw.c_str(), raw.size());
+    REQUIRE(parser.state() == RequestParser::REQUEST_READY);
+    CHECK(req.uri() == "/one");
+    CHECK(req.headers().get("Host") == "a");
+    CHECK(parser.hasLeftoverData());
+
+    parser.reset();
+    parser.feed(NULL, 0);
+    REQUIRE(parser.state() == RequestParser::HEADERS_READY);
+    CHECK(req.headers().get("Host") == "b");
+    parser.proceedReadingBody();
+    REQUIRE(parser.state() == RequestParser::REQUEST_READY);
+    CHECK(req.headers().get("Host") == "b"); // Still valid once the body is consumed
+
+    parser.reset();
+    parser.feed(NULL, 0);
+    REQUIRE(parser.state() == RequestParser::REQUEST_READY);
+    CHECK(req.path() == "/three");
+    CHECK(req.queryString() == "x=1");
+    CHECK(req.headers().get("host") == "c");
+    CHECK_FALSE(parser.hasLeftoverData());
 }
@@ -0,0 +1,77 @@
+#include "doctest.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "http/ResponseBody.hpp"
+
+using namespace http;
+
+static std::string const kPath = "/tmp/webserv_response_body_test.txt";
+
+static void writeFile(std::string const &path, std::string const &data) {
+    int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    REQUIRE(fd != -1);
+    REQUIRE(::write(fd, data.data(), data.size()) == (ssize_t)data.size());
+    ::close(fd);
+}
+
+TEST_CASE("FileBody - exposes a file region for zero-copy sending") {
+    writeFile(kPath, "0123456789");
+    FileBody body(kPath);
+
+    int fd = -1;
+    off_t offset = -1;
+    size_t length = 0;
+    REQUIRE(body.fileRegion(fd, offset, length));
+    CHECK(fd >= 0);
+    CHECK(offset == 0);
+    CHECK(length == 10);
+
+    SUBCASE("consume advances the region until the body is done") {
+        body.consume(4);
+        REQUIRE(body.fileRegion(fd, offset, length));
+        CHECK(offset == 4);
+        CHECK(length == 6);
+        CHECK_FALSE(body.isDone());
+
+        body.consume(6);
+        CHECK(body.isDone());
+    }
+
+    SUBCASE("read and consume share the same position") {
+        char buf[4];
+        CHECK(body.read(buf, sizeof(buf)) == 4);
+        CHECK(std::string(buf, 4) == "0123");
+        REQUIRE(body.fileRegion(fd, offset, length));
+        CHECK(offset == 4);
+
+        body.consume(2);
+        CHECK(body.read(buf, sizeof(buf)) == 4);
+        CHECK(std::string(buf, 4) == "6789");
+        CHECK(body.isDone());
+    }
+
+    std::remove(kPath.c_str());
+}
+
+TEST_CASE("BodyInMemory - exposes a memory region, not a file region") {
+    BodyInMemory body("abcdef");
+    int fd = -1;
+    off_t offset = 0;
+    size_t length = 0;
+    CHECK_FALSE(body.fileRegion(fd, offset, length));
+
+    char const *data = NULL;
+    REQUIRE(body.memoryRegion(data, length));
+    CHECK(std::string(data, length) == "abcdef");
+
+    body.consume(4);
+    REQUIRE(body.memoryRegion(data, length));
+    CHECK(std::string(data, length) == "ef");
+    CHECK_FALSE(body.isDone());
+
+    body.consume(2);
+    CHECK(body.isDone());
+}
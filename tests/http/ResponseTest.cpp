@@ -0,0 +1,69 @@
+#include "doctest.h"
+
+#include "http/Response.hpp"
+#include <string>
+#include <vector>
+
+using namespace http;
+
+namespace {
+
+std::string build(Response const &response, bool addBodyLine = true) {
+    std::vector<char> buffer(3, 'x'); // Leftovers from a previous response
+    response.buildHeaders(buffer, addBodyLine);
+    return std::string(buffer.begin(), buffer.end());
+}
+
+/** @brief @p head without its Date line, which changes from one second to the next. */
+std::string withoutDate(std::string head) {
+    size_t date = head.find("\r\nDate: ");
+    if (date != std::string::npos)
+        head.erase(date, head.find("\r\n", date + 2) - date);
+    return head;
+}
+
+} // namespace
+
+TEST_CASE("getStatusLine - one line per status") {
+    CHECK(getStatusLine(OK) == "HTTP/1.1 200 OK\r\n");
+    CHECK(getStatusLine(NOT_FOUND) == "HTTP/1.1 404 Not Found\r\n");
+    CHECK(getStatusLine(BAD_GATEWAY) == "HTTP/1.1 502 Bad Gateway\r\n");
+    CHECK(getStatusLine(GATEWAY_TIMEOUT) == "HTTP/1.1 504 Gateway Timeout\r\n");
+    CHECK(getStatusLine(UNKNOWN_STATUS) == "HTTP/1.1 0 Unknown Status\r\n");
+    CHECK(getStatusLine(static_cast<HttpStatus>(299)) == getStatusLine(UNKNOWN_STATUS));
+    CHECK(getStatusLine(static_cast<HttpStatus>(1000)) == getStatusLine(UNKNOWN_STATUS));
+    CHECK(&getStatusLine(OK) == &getStatusLine(OK));
+}
+
+TEST_CASE("Response::buildHeaders") {
+    Response response;
+    response.status(NOT_FOUND).setBodyInMemory("gone", "text/plain");
+    response.headers().add("x-request-id", "7");
+
+    std::string head = build(response);
+    std::string const prefix = "HTTP/1.1 404 Not Found\r\nServer: ServerX/1.0\r\nDate: ";
+    REQUIRE(head.compare(0, prefix.size(), prefix) == 0);
+
+    // IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+    size_t dateEnd = head.find("\r\n", prefix.size());
+    REQUIRE(dateEnd != std::string::npos);
+    CHECK(dateEnd - prefix.size() == 29);
+    CHECK(head.compare(dateEnd - 4, 4, " GMT") == 0);
+
+    CHECK(head.substr(dateEnd + 2) ==
+          "Content-Length: 4\r\nContent-Type: text/plain\r\nX-Request-Id: 7\r\n\r\n");
+
+    SUBCASE("without the empty line") {
+        std::string withoutBodyLine = build(response, false);
+        CHECK(withoutDate(withoutBodyLine) + "\r\n" == withoutDate(head));
+    }
+
+    SUBCASE("fields set by the handler are not duplicated") {
+        response.headers().add(header::SERVER, "cgi/2");
+        response.headers().add(header::DATE, "Thu, 01 Jan 1970 00:00:00 GMT");
+        CHECK(build(response) == "HTTP/1.1 404 Not Found\r\n"
+                                 "Content-Length: 4\r\nContent-Type: text/plain\r\n"
+                                 "X-Request-Id: 7\r\nServer: cgi/2\r\n"
+                                 "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n\r\n");
+    }
+}
@@ -1,8 +1,10 @@
+#include "../TestableRequest.hpp"
 #include "config/ServerConfig.hpp"
 #include "doctest.h"
 #include "http/MimeTypes.hpp"
 #include "http/Request.hpp"
 #include "http/Router.hpp"
+#include <sys/stat.h>
 
 TEST_CASE("Router: Integration with Regex Locations") {
     http::MimeTypes mime("config/mime.types");
@@ -88,3 +90,42 @@ server {
         CHECK(loc->path() == "/api/");
     }
 }
+
+TEST_CASE("Router: Uploads are spooled in their upload directory") {
+    http::MimeTypes mime("config/mime.types");
+    mkdir("/tmp/webserv_router_upload", 0755);
+    mkdir("/tmp/webserv_router_upload/files", 0755);
+
+    const std::string configStr = R"(
+server {
+    listen 9191;
+    location /upload/ {
+        root /tmp/webserv_router_upload;
+        upload_path files;
+    }
+    location /cgi/ {
+        root /tmp/webserv_router_upload;
+        upload_path files;
+        cgi_pass /usr/bin/python3;
+    }
+}
+        )";
+
+    config::ServerConfig sc(configStr, false);
+    http::Router router(sc, mime);
+
+    TestableRequest req;
+    req.method(http::RequestStartLine::POST);
+
+    SUBCASE("POST to an upload location") {
+        req.uri("/upload/a.txt");
+        router.matchServerAndLocation(9191, req);
+        CHECK(req.getBodyTempPath() == "/tmp/webserv_router_upload/files");
+    }
+
+    SUBCASE("POST to a CGI keeps client_body_temp_path") {
+        req.uri("/cgi/a.py");
+        router.matchServerAndLocation(9191, req);
+        CHECK(req.getBodyTempPath() == "/tmp");
+    }
+}
@@ -1,6 +1,8 @@
 #include "doctest.h"
 
 #include <fcntl.h>
+#include <fstream>
+#include <sstream>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -14,6 +16,7 @@
 #include "config/arguments/String.hpp"
 #include "http/Handler.hpp"
 #include "http/MimeTypes.hpp"
+#include "http/MultipartUpload.hpp"
 #include "http/Response.hpp"
 
 using namespace http;
@@ -59,12 +62,11 @@ static void setupUploadRequest(TestableRequest &req, const string &uri, const st
     req.headers().add("Content-Type", "text/html");
     req.headers().add("X-Filename", filename);
 
-    utils::TempFile *tf = new utils::TempFile();
-    if (tf->open()) {
-        utils::writeFile(string(contentLength, '0'), tf->path().c_str());
-        req.body(tf);
+    RequestBody *body = new RequestBody(0, "/tmp");
+    if (body->append(string(contentLength, '0').data(), contentLength)) {
+        req.body(body);
     } else {
-        delete tf;
+        delete body;
     }
 }
 
@@ -152,3 +154,96 @@ TEST_CASE("UPLOAD - 201 Created on success with Location header") {
     unlink("test_www/img/uploads/file.html");
     removeDirectoryRecursive("test_www");
 }
+
+TEST_CASE("UPLOAD - 201 Created for a chunked body without Content-Length") {
+    mkdir("test_www", 0777);
+    mkdir("test_www/img", 0777);
+    mkdir("test_www/img/uploads", 0777);
+
+    LocationBlock loc = createUploadLocation("test_www", "/img/", "img/uploads");
+    ServerBlock server = createServer(5, loc);
+
+    TestableRequest req(&server, &loc);
+    setupUploadRequest(req, "/img/", "file.html", 4);
+    req.headers().erase("Content-Length");
+    req.headers().add("Transfer-Encoding", "chunked");
+
+    Response res;
+    MimeTypes mime;
+
+    FileUploadHandler::handle(req, res, mime);
+
+    CHECK(res.status() == CREATED);
+    CHECK(access("test_www/img/uploads/file.html", F_OK) == 0);
+
+    unlink("test_www/img/uploads/file.html");
+    removeDirectoryRecursive("test_www");
+}
+
+static string readFile(const char *path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+static void setupMultipartRequest(TestableRequest &req, std::string const &body) {
+    req.set(RequestStartLine::POST, "/img/");
+    req.headers().add("Content-Length", toString(body.size()));
+    req.headers().add("Content-Type", "multipart/form-data; boundary=--sep");
+
+    RequestBody *upload = new RequestBody(0, "test_www/img/uploads");
+    upload->streamTo(new MultipartUpload("--sep", "test_www/img/uploads"));
+    req.body(upload);
+    // As the parser does: in pieces, while the body arrives
+    for (size_t i = 0; i < body.size(); i += 7)
+        upload->append(body.data() + i, std::min<size_t>(7, body.size() - i));
+}
+
+TEST_CASE("UPLOAD - multipart/form-data stores each file part") {
+    mkdir("test_www", 0777);
+    mkdir("test_www/img", 0777);
+    mkdir("test_www/img/uploads", 0777);
+
+    LocationBlock loc = createUploadLocation("test_www", "/img/", "img/uploads");
+    ServerBlock server = createServer(0, loc);
+    TestableRequest req(&server, &loc);
+    Response res;
+    MimeTypes mime;
+
+    std::string body = "----sep\r\n"
+                       "Content-Disposition: form-data; name=\"note\"\r\n\r\n"
+                       "not a file\r\n"
+                       "----sep\r\n"
+                       "Content-Disposition: form-data; name=\"a\"; filename=\"a.txt\"\r\n\r\n"
+                       "first\r\n"
+                       "----sep\r\n"
+                       "Content-Disposition: form-data; name=\"b\"; filename=\"b.bin\"\r\n\r\n"
+                       "sec\r\nond\r\n"
+                       "----sep--\r\n";
+
+    SUBCASE("a complete form") {
+        setupMultipartRequest(req, body);
+        FileUploadHandler::handle(req, res, mime);
+        CHECK(res.status() == CREATED);
+        CHECK(res.headers().get("Location") == "/img/uploads/a.txt");
+        CHECK(readFile("test_www/img/uploads/a.txt") == "first");
+        CHECK(readFile("test_www/img/uploads/b.bin") == "sec\r\nond");
+    }
+
+    SUBCASE("a truncated form stores nothing") {
+        setupMultipartRequest(req, body.substr(0, body.size() - 12));
+        FileUploadHandler::handle(req, res, mime);
+        CHECK(res.status() == BAD_REQUEST);
+        CHECK(access("test_www/img/uploads/a.txt", F_OK) == -1);
+    }
+
+    SUBCASE("a traversing filename is rejected") {
+        setupMultipartRequest(req, "----sep\r\nContent-Disposition: form-data; name=a; "
+                                   "filename=\"../x\"\r\n\r\nx\r\n----sep--");
+        FileUploadHandler::handle(req, res, mime);
+        CHECK(res.status() == BAD_REQUEST);
+    }
+
+    removeDirectoryRecursive("test_www");
+}
@@ -0,0 +1,80 @@
+#include "doctest.h"
+
+#include "network/ChildReaper.hpp"
+#include "network/EventDispatcher.hpp"
+#include <cerrno>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using network::ChildReaper;
+
+static bool waitReadable(int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 5000) == 1;
+}
+
+TEST_CASE("ChildReaper - collects exited children when its fd becomes readable") {
+    network::EventDispatcher dispatcher;
+    ChildReaper reaper(dispatcher);
+    REQUIRE(reaper.getFd() >= 0);
+    CHECK(reaper.reap() == 0);
+
+    pid_t pids[2];
+    for (int i = 0; i < 2; ++i) {
+        pids[i] = fork();
+        REQUIRE(pids[i] >= 0);
+        if (pids[i] == 0)
+            _exit(i);
+    }
+    REQUIRE(waitReadable(reaper.getFd()));
+    // Both may not have exited yet: the signalfd becomes readable again for the other one
+    size_t reaped = 0;
+    while (reaped < 2 && waitReadable(reaper.getFd())) {
+        reaper.handleEvent(POLLIN);
+        reaped = 0;
+        for (int i = 0; i < 2; ++i)
+            reaped += waitpid(pids[i], NULL, WNOHANG) == -1 && errno == ECHILD;
+    }
+    CHECK(reaped == 2);
+}
+
+TEST_CASE("ChildReaper - restores the signal mask") {
+    sigset_t before, after;
+    sigprocmask(SIG_SETMASK, NULL, &before);
+    {
+        network::EventDispatcher dispatcher;
+        ChildReaper reaper(dispatcher);
+        sigset_t during;
+        sigprocmask(SIG_SETMASK, NULL, &during);
+        CHECK(sigismember(&during, SIGCHLD));
+    }
+    sigprocmask(SIG_SETMASK, NULL, &after);
+    CHECK(sigismember(&after, SIGCHLD) == sigismember(&before, SIGCHLD));
+}
+
+TEST_CASE("ChildReaper - terminates watched children only") {
+    network::EventDispatcher dispatcher;
+    ChildReaper reaper(dispatcher);
+    pid_t pids[2];
+    for (int i = 0; i < 2; ++i) {
+        pids[i] = fork();
+        REQUIRE(pids[i] >= 0);
+        if (pids[i] == 0) {
+            pause();
+            _exit(0);
+        }
+    }
+    ChildReaper::watch(pids[0]);
+    ChildReaper::terminate(pids[0]);
+    ChildReaper::terminate(pids[1]); // Not watched: left alone
+
+    int status = 0;
+    REQUIRE(waitpid(pids[0], &status, 0) == pids[0]);
+    CHECK(WIFSIGNALED(status));
+    CHECK(WTERMSIG(status) == SIGTERM);
+    CHECK(waitpid(pids[1], &status, WNOHANG) == 0);
+
+    kill(pids[1], SIGKILL);
+    waitpid(pids[1], &status, 0);
+}
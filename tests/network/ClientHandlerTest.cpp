@@ -0,0 +1,80 @@
+#include "doctest.h"
+
+#include "../test_utils.hpp"
+#include "config/ServerConfig.hpp"
+#include "http/MimeTypes.hpp"
+#include "http/Router.hpp"
+#include "network/ClientHandler.hpp"
+#include "network/EventDispatcher.hpp"
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+int failingAdd = 0; //!< The next epoll_ctl(EPOLL_CTL_ADD) to fail, counting from 1; 0: none.
+
+} // namespace
+
+// Takes the place of the libc one in the test binary, to make a registration fail on demand
+extern "C" int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event) {
+    if (op == EPOLL_CTL_ADD && failingAdd > 0 && --failingAdd == 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    return static_cast<int>(syscall(SYS_epoll_ctl, epfd, op, fd, event));
+}
+
+TEST_CASE("ClientHandler - a CGI whose stdin cannot be registered gets a 500") {
+    mkdir("test_cgi", 0777);
+    writeFile("#!/bin/sh\nprintf 'Content-Type: text/plain\\r\\n\\r\\n'\ncat\n",
+              "test_cgi/cat.sh");
+    chmod("test_cgi/cat.sh", 0755);
+
+    std::string const content = "server {\n"
+                                "    listen 9191;\n"
+                                "    location / {\n"
+                                "        root test_cgi;\n"
+                                "        cgi_pass;\n"
+                                "        cgi_request_buffering off;\n"
+                                "        allow_methods POST;\n"
+                                "    }\n"
+                                "}\n";
+    config::ServerConfig config(content, false);
+    http::MimeTypes mime("config/mime.types");
+    http::Router router(config, mime);
+
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    std::string request = "POST /cat.sh HTTP/1.1\r\nHost: a\r\nContent-Length: 10\r\n\r\nhello";
+    REQUIRE(send(fds[1], request.data(), request.size(), 0) ==
+            static_cast<ssize_t>(request.size()));
+
+    std::string response;
+    {
+        network::EventDispatcher dispatcher;
+        network::ClientHandler *client =
+            new network::ClientHandler(fds[0], 9191, "127.0.0.1", router, dispatcher);
+        dispatcher.registerHandler(client);
+
+        failingAdd = 2; // The CGI's stdout is registered, its stdin is not
+        client->handleEvent(EPOLLIN);
+        failingAdd = 0;
+        client->handleEvent(EPOLLOUT);
+
+        char buffer[4096];
+        ssize_t count = recv(fds[1], buffer, sizeof(buffer), 0);
+        if (count > 0)
+            response.assign(buffer, count);
+    } // Every handler is deleted once, by the dispatcher
+    close(fds[1]);
+
+    CHECK(response.compare(0, 34, "HTTP/1.1 500 Internal Server Error") == 0);
+    while (waitpid(-1, NULL, 0) > 0) // The script reads EOF and exits
+        ;
+    removeDirectoryRecursive("test_cgi");
+}
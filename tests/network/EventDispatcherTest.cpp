@@ -0,0 +1,186 @@
+#include "doctest.h"
+
+#include "network/EventDispatcher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using network::EventDispatcher;
+using network::IEventHandler;
+
+namespace {
+
+/** Reads one end of a pipe; counts its deletions and removes its owned handler on the way. */
+class PipeHandler : public IEventHandler {
+public:
+    PipeHandler(EventDispatcher &dispatcher, int &deleted)
+        : dispatcher_(dispatcher), deleted_(deleted), owned_(NULL) {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        fd_ = fds[0];
+        peer_ = fds[1];
+    }
+    ~PipeHandler() {
+        dispatcher_.removeHandler(owned_); // Like a client removing its CGI handler
+        close(fd_);
+        close(peer_);
+        ++deleted_;
+    }
+    void handleEvent(uint32_t) {}
+    int getFd() const { return fd_; }
+
+    void own(IEventHandler *handler) { owned_ = handler; }
+
+private:
+    EventDispatcher &dispatcher_;
+    int &deleted_;
+    IEventHandler *owned_;
+    int fd_;
+    int peer_;
+};
+
+/** A regular file, which epoll does not accept. */
+class FileHandler : public IEventHandler {
+public:
+    explicit FileHandler(int &deleted) : deleted_(deleted), file_(std::tmpfile()) {
+        REQUIRE(file_ != NULL);
+    }
+    ~FileHandler() {
+        std::fclose(file_);
+        ++deleted_;
+    }
+    void handleEvent(uint32_t) {}
+    int getFd() const { return fileno(file_); }
+
+private:
+    int &deleted_;
+    std::FILE *file_;
+};
+
+/** What a BudgetReader saw, kept outside of it: the dispatcher deletes its handlers. */
+struct ReadLog {
+    size_t events;
+    size_t received;
+    bool sawEagain; //!< The last event stopped on EAGAIN.
+    ReadLog() : events(0), received(0), sawEagain(false) {}
+};
+
+/**
+ * Reads a socket the way the connection handlers do: until EAGAIN, but at most
+ * @p budget bytes per event, calling rearm() when it stops early if @p rearms.
+ */
+class BudgetReader : public IEventHandler {
+public:
+    BudgetReader(EventDispatcher &dispatcher, int fd, size_t budget, bool rearms, size_t total,
+                 ReadLog &log)
+        : dispatcher_(dispatcher), fd_(fd), budget_(budget), rearms_(rearms), total_(total),
+          log_(log) {
+        dispatcher_.setTimeout(this, 300); // Nothing more comes: see handleTimeout()
+    }
+    ~BudgetReader() { close(fd_); }
+
+    void handleEvent(uint32_t) {
+        ++log_.events;
+        log_.sawEagain = false;
+        size_t budget = budget_;
+        char buffer[1024];
+        while (budget > 0) {
+            ssize_t count = recv(fd_, buffer, std::min(sizeof(buffer), budget), 0);
+            if (count < 0 && errno == EAGAIN) {
+                log_.sawEagain = true;
+                break;
+            }
+            REQUIRE(count > 0);
+            log_.received += count;
+            budget -= count;
+        }
+        if (log_.received == total_)
+            dispatcher_.requestShutdown();
+        else if (budget == 0 && rearms_)
+            dispatcher_.rearm(this);
+    }
+    void handleTimeout() { dispatcher_.requestShutdown(); }
+    int getFd() const { return fd_; }
+    bool supportsEdgeTriggered() const { return true; }
+
+private:
+    EventDispatcher &dispatcher_;
+    int fd_;
+    size_t budget_;
+    bool rearms_;
+    size_t total_;
+    ReadLog &log_;
+};
+
+/** Sends @p total bytes at once, then runs a dispatcher until the reader is done. */
+ReadLog readThrough(bool edgeTriggered, size_t total, size_t budget, bool rearms) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    std::string data(total, 'x');
+    REQUIRE(send(fds[1], data.data(), data.size(), 0) == static_cast<ssize_t>(total));
+
+    ReadLog log;
+    {
+        EventDispatcher dispatcher(edgeTriggered);
+        dispatcher.registerHandler(new BudgetReader(dispatcher, fds[0], budget, rearms, total,
+                                                    log));
+        dispatcher.handleEvents();
+    }
+    close(fds[1]);
+    return log;
+}
+
+} // namespace
+
+TEST_CASE("EventDispatcher - edge-triggered reads") {
+    SUBCASE("one event drains the socket until EAGAIN") {
+        ReadLog log = readThrough(true, 10000, 1 << 20, true);
+        CHECK(log.events == 1);
+        CHECK(log.received == 10000);
+        CHECK(log.sawEagain);
+    }
+    SUBCASE("a read stopped at its budget is resumed through rearm()") {
+        ReadLog log = readThrough(true, 10000, 4096, true);
+        CHECK(log.events == 3); // 4096 + 4096 + 1808
+        CHECK(log.received == 10000);
+    }
+    SUBCASE("without rearm(), what is left past the budget is not reported again") {
+        ReadLog log = readThrough(true, 10000, 4096, false);
+        CHECK(log.events == 1);
+        CHECK(log.received == 4096);
+    }
+    SUBCASE("level-triggered, it is reported again anyway") {
+        ReadLog log = readThrough(false, 10000, 4096, false);
+        CHECK(log.events == 3);
+        CHECK(log.received == 10000);
+    }
+}
+
+TEST_CASE("EventDispatcher - deletes each handler once on destruction") {
+    int deleted = 0;
+    {
+        EventDispatcher dispatcher;
+        // The owned handler has the lower fd: the slot walk deletes it before its owner
+        PipeHandler *owned = new PipeHandler(dispatcher, deleted);
+        PipeHandler *owner = new PipeHandler(dispatcher, deleted);
+        REQUIRE(owned->getFd() < owner->getFd());
+        owner->own(owned);
+        dispatcher.registerHandler(owned);
+        dispatcher.registerHandler(owner);
+    }
+    CHECK(deleted == 2);
+}
+
+TEST_CASE("EventDispatcher - a handler epoll rejects is left unregistered") {
+    int deleted = 0;
+    {
+        EventDispatcher dispatcher;
+        FileHandler *handler = new FileHandler(deleted);
+        CHECK_THROWS(dispatcher.registerHandler(handler));
+        delete handler; // Still the caller's
+    }
+    CHECK(deleted == 1);
+}
@@ -0,0 +1,98 @@
+#include "doctest.h"
+
+#include "network/TimerWheel.hpp"
+#include <vector>
+
+using network::TimerWheel;
+
+static std::vector<TimerWheel::Timer *> drain(TimerWheel &wheel) {
+    std::vector<TimerWheel::Timer *> expired;
+    while (TimerWheel::Timer *timer = wheel.popExpired())
+        expired.push_back(timer);
+    return expired;
+}
+
+TEST_CASE("TimerWheel - expires timers once their delay has elapsed") {
+    TimerWheel wheel(0);
+    TimerWheel::Timer a, b;
+    wheel.schedule(a, 0, 300);
+    wheel.schedule(b, 0, 1000);
+    CHECK(wheel.size() == 2);
+    CHECK(wheel.nextTimeout(0) == 300);
+
+    wheel.advance(299);
+    CHECK(drain(wheel).empty());
+
+    wheel.advance(300);
+    std::vector<TimerWheel::Timer *> expired = drain(wheel);
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0] == &a);
+    CHECK_FALSE(a.isPending());
+    CHECK(wheel.size() == 1);
+
+    wheel.advance(1000);
+    CHECK(drain(wheel).size() == 1);
+    CHECK(wheel.size() == 0);
+    CHECK(wheel.nextTimeout(1000) == -1);
+}
+
+TEST_CASE("TimerWheel - cancel and reschedule") {
+    TimerWheel wheel(0);
+    TimerWheel::Timer timer;
+    wheel.schedule(timer, 0, 500);
+    wheel.cancel(timer);
+    CHECK_FALSE(timer.isPending());
+    CHECK(wheel.size() == 0);
+    wheel.cancel(timer); // No-op when not pending
+
+    wheel.schedule(timer, 0, 500);
+    wheel.schedule(timer, 400, 500); // Replaces the first expiry
+    CHECK(wheel.size() == 1);
+    wheel.advance(600);
+    CHECK(drain(wheel).empty());
+    wheel.advance(900);
+    CHECK(drain(wheel).size() == 1);
+}
+
+TEST_CASE("TimerWheel - cascades long timers down to their exact tick") {
+    TimerWheel wheel(123456);
+    TimerWheel::Timer minute, hour, day;
+    wheel.schedule(minute, 123456, 60 * 1000);
+    wheel.schedule(hour, 123456, 3600 * 1000);
+    wheel.schedule(day, 123456, 86400 * 1000);
+
+    // Advance in irregular steps, the way an event loop would
+    uint64_t now = 123456;
+    std::vector<uint64_t> expiredAt(3, 0);
+    while (wheel.size() > 0 && now < 123456 + 2 * 86400 * 1000ULL) {
+        int timeout = wheel.nextTimeout(now);
+        REQUIRE(timeout >= 0);
+        now += timeout > 0 ? timeout : 1;
+        wheel.advance(now);
+        while (TimerWheel::Timer *timer = wheel.popExpired()) {
+            if (timer == &minute)
+                expiredAt[0] = now;
+            else if (timer == &hour)
+                expiredAt[1] = now;
+            else if (timer == &day)
+                expiredAt[2] = now;
+        }
+    }
+    // A timer never fires early and at most one tick late
+    CHECK(expiredAt[0] >= 123456 + 60 * 1000);
+    CHECK(expiredAt[0] <= 123456 + 60 * 1000 + TimerWheel::TICK_MS);
+    CHECK(expiredAt[1] >= 123456 + 3600 * 1000);
+    CHECK(expiredAt[1] <= 123456 + 3600 * 1000 + TimerWheel::TICK_MS);
+    CHECK(expiredAt[2] >= 123456 + 86400 * 1000ULL);
+    CHECK(expiredAt[2] <= 123456 + 86400 * 1000ULL + TimerWheel::TICK_MS);
+}
+
+TEST_CASE("TimerWheel - a large jump expires everything that is due") {
+    TimerWheel wheel(0);
+    std::vector<TimerWheel::Timer> timers(100);
+    for (size_t i = 0; i < timers.size(); ++i)
+        wheel.schedule(timers[i], 0, (i + 1) * 10000);
+    wheel.advance(500000);
+    CHECK(drain(wheel).size() == 50);
+    CHECK(wheel.size() == 50);
+}
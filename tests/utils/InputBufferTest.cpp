@@ -0,0 +1,49 @@
+#include "doctest.h"
+
+#include "utils/InputBuffer.hpp"
+#include <cstring>
+#include <string>
+
+static std::string contents(utils::InputBuffer const &buffer) {
+    return std::string(buffer.data(), buffer.size());
+}
+
+TEST_CASE("InputBuffer - reads in place and drops bytes without moving them") {
+    utils::InputBuffer buffer(16);
+    CHECK(buffer.empty());
+    CHECK(buffer.capacity() >= 16);
+
+    size_t space;
+    char *tail = buffer.prepare(4, space);
+    CHECK(space >= 16);
+    std::memcpy(tail, "GET /", 5);
+    buffer.commit(5);
+    buffer.append(" HTTP", 5);
+    CHECK(contents(buffer) == "GET / HTTP");
+
+    SUBCASE("growing keeps the contents") {
+        tail = buffer.prepare(100, space);
+        CHECK(space >= 100);
+        CHECK(tail == buffer.data() + buffer.size());
+        CHECK(contents(buffer) == "GET / HTTP");
+        CHECK(buffer.capacity() >= 110);
+    }
+
+    SUBCASE("truncate is free, erase closes the gap") {
+        char const *storage = buffer.data();
+        buffer.truncate(5);
+        CHECK(contents(buffer) == "GET /");
+        buffer.append("abc", 3);
+        buffer.erase(1, 3);
+        CHECK(contents(buffer) == "G/abc");
+        CHECK(buffer.data() == storage);
+        buffer.erase(4, 10); // Clamped to the end
+        CHECK(contents(buffer) == "G/ab");
+    }
+
+    SUBCASE("clear starts over at the front") {
+        buffer.clear();
+        CHECK(buffer.empty());
+        CHECK(buffer.prepare(1, space) == buffer.data());
+    }
+}
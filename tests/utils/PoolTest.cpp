@@ -0,0 +1,78 @@
+#include "doctest.h"
+
+#include "utils/BufferPool.hpp"
+#include "utils/SlabAllocator.hpp"
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE("SlabAllocator - recycles freed blocks") {
+    utils::SlabAllocator slab(40, 4);
+    CHECK(slab.blockSize() == 48); // Rounded up to the block alignment
+    CHECK(slab.capacity() == 0);
+
+    std::set<void *> blocks;
+    for (int i = 0; i < 6; ++i)
+        blocks.insert(slab.allocate());
+    CHECK(blocks.size() == 6);
+    CHECK(slab.inUse() == 6);
+    CHECK(slab.capacity() == 8); // Two slabs of four
+
+    void *last = *blocks.begin();
+    slab.deallocate(last);
+    CHECK(slab.inUse() == 5);
+    CHECK(slab.allocate() == last); // LIFO reuse, no new slab
+    CHECK(slab.capacity() == 8);
+
+    for (std::set<void *>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+        slab.deallocate(*it);
+    CHECK(slab.inUse() == 0);
+}
+
+TEST_CASE("BufferPool - hands storage from one buffer to the next") {
+    typedef utils::BufferPool<std::vector<char> > Pool;
+    Pool &pool = Pool::getInstance();
+    pool.clear();
+
+    std::vector<char> first;
+    pool.acquire(first, 8192);
+    CHECK(first.capacity() >= 8192);
+    first.assign(100, 'x');
+    char const *storage = first.data();
+    pool.release(first);
+    CHECK(first.capacity() == 0);
+    CHECK(pool.size() == 1);
+
+    std::vector<char> second;
+    pool.acquire(second, 8192);
+    CHECK(second.empty());
+    CHECK(second.data() == storage);
+    CHECK(pool.size() == 0);
+
+    SUBCASE("oversized buffers are freed instead of pooled") {
+        second.reserve(1024 * 1024);
+        pool.release(second);
+        CHECK(pool.size() == 0);
+    }
+    pool.release(second);
+    pool.clear();
+}
+
+TEST_CASE("BufferPool - works with std::string") {
+    typedef utils::BufferPool<std::string> Pool;
+    Pool &pool = Pool::getInstance();
+    pool.clear();
+
+    std::string s;
+    pool.acquire(s, 4096);
+    s.append(3000, 'a');
+    pool.release(s);
+    CHECK(s.empty());
+
+    std::string t;
+    pool.acquire(t, 16);
+    CHECK(t.empty());
+    CHECK(t.capacity() >= 3000);
+    pool.release(t);
+    pool.clear();
+}